@@ -16,6 +16,32 @@ void GameSettingsWindow::update(Editor::Context & ctx)
 
 	Checkbox("Update Lines", &game.settings.is_lines_active);
 	SameLine(), ImGui::SliderInt("Per Frame", &game.settings.lines_update_per_frame, 1, 16);
+
+	Checkbox("Frustum culling", &game.settings.is_frustum_culling_on);
+
+	{
+		using enum Game::Settings::DrawMode;
+		auto & draw_mode = game.settings.draw_mode;
+		auto const & programs = game.assets.programs;
+
+		Text("Draw mode"), SameLine();
+		if (RadioButton("Sorted", draw_mode == Sorted))
+			draw_mode = Sorted;
+
+		SameLine(), BeginDisabled(not programs.contains(GLTF::pbrMetallicRoughness_instanced_program_name));
+		if (RadioButton("Instanced", draw_mode == Instanced))
+			draw_mode = Instanced;
+		EndDisabled();
+
+		SameLine(), BeginDisabled(not programs.contains(GLTF::pbrMetallicRoughness_indirect_program_name));
+		if (RadioButton("Multi draw indirect", draw_mode == MultiDrawIndirect))
+			draw_mode = MultiDrawIndirect;
+		EndDisabled();
+	}
+
+	Checkbox("Lods", &game.settings.is_lod_on);
+	SameLine(), SliderFloat("Pixel error", &game.settings.lod_pixel_error, 0.25, 16, "%.2f", ImGuiSliderFlags_Logarithmic);
+	Checkbox("Meshlet culling", &game.settings.is_meshlet_culling_on);
 }
 
 void MaterialWindow::update(Editor::Context & ctx)
@@ -25,10 +51,10 @@ void MaterialWindow::update(Editor::Context & ctx)
 	auto & game = static_cast<Game&>(ctx.game);
 
 	static Name material_name;
-	if (BeginCombo("Material", material_name.string.data()))
+	if (BeginCombo("Material", material_name.string().data()))
 	{
-		for (auto const & [name, _]: game.assets.materials)
-			if (Selectable(name.string.data()))
+		for (auto const & name: game.assets.materials.names)
+			if (Selectable(name.string().data()))
 				material_name = name;
 
 		EndCombo();
@@ -39,10 +65,10 @@ void MaterialWindow::update(Editor::Context & ctx)
 		return;
 	}
 	auto & material = game.assets.materials.get(material_name);
-	auto & block = material->get_block();
+	auto & block = Render::Material_gltf_pbrMetallicRoughness::block;
 
-	auto buffer = ByteBuffer(block.data_size);
-	material->write_to_buffer(buffer.begin());
+	// the material has the block's layout, its variables are edited in place
+	auto * data = material.data();
 
 	bool edited = false;
 	for (auto & [name, variable]: block.variables)
@@ -50,40 +76,37 @@ void MaterialWindow::update(Editor::Context & ctx)
 		{
 		case GL::GL_FLOAT:
 		{
-			edited |= DragFloat(name.data(), buffer.data_as<f32>(variable.offset));
+			edited |= DragFloat(name.string().data(), reinterpret_cast<f32 *>(data + variable.offset));
 			break;
 		}
 		case GL::GL_FLOAT_VEC2:
 		{
-			edited |= DragFloat2(name.data(), buffer.data_as<f32>(variable.offset));
+			edited |= DragFloat2(name.string().data(), reinterpret_cast<f32 *>(data + variable.offset));
 			break;
 		}
 		case GL::GL_FLOAT_VEC3:
 		{
-			edited |= ColorEdit3(name.data(), buffer.data_as<f32>(variable.offset));
+			edited |= ColorEdit3(name.string().data(), reinterpret_cast<f32 *>(data + variable.offset));
 			break;
 		}
 		case GL::GL_FLOAT_VEC4:
 		{
-			edited |= ColorEdit4(name.data(), buffer.data_as<f32>(variable.offset));
+			edited |= ColorEdit4(name.string().data(), reinterpret_cast<f32 *>(data + variable.offset));
 			break;
 		}
 		case GL::GL_UNSIGNED_INT64_ARB:
 		{
 			// TODO(bekorn): display the texture
 			// TODO(bekorn): should be editable
-			LabelText(name.data(), "%llu", *buffer.data_as<u64>(variable.offset));
+			LabelText(name.string().data(), "%llu", *reinterpret_cast<u64 *>(data + variable.offset));
 			break;
 		}
 		default:
-		{ LabelText(name.data(), "%s is not supported", GL::glsl_uniform_type_to_string(variable.glsl_type)); }
+		{ LabelText(name.string().data(), "%s is not supported", GL::glsl_uniform_type_to_string(variable.glsl_type)); }
 		}
 
 	if (edited)
-	{
-		material->read_from_buffer(buffer.begin());
-		game.gltf_material_is_dirty.push(material_name); // !!! Temporary
-	}
+		game.gltf_material_is_dirty.mark(game.assets.materials.get_handle(material_name).index); // !!! Temporary
 }
 
 void Sdf3dWindow::init(Editor::Context const & ctx)
@@ -207,12 +230,12 @@ void Sdf3dWindow::voxelize(const Editor::Context & ctx)
 	if (auto it = scene_tree.named_indices.find(node_name); it != scene_tree.named_indices.end())
 	{
 		auto & node_idx = it->second;
-		auto & node = scene_tree.get(node_idx);
+		auto node = scene_tree.get(node_idx);
 
-		if (node.mesh != nullptr)
+		if (not node.mesh.is_null())
 		{
-			mesh = node.mesh;
-			TransformM = node.matrix;
+			mesh = &ctx.game.assets.meshes.get(node.mesh);
+			TransformM = node.matrix * mesh->dequantization; // quantized positions are in the unit box
 		}
 	}
 
@@ -309,7 +332,7 @@ void Sdf3dWindow::calculate_sdf(const Editor::Context & ctx)
 
 	/// Run jump flood
 	{
-		auto & jump_flood_program = ctx.game.assets.programs.get("jump_flood_3d");
+		auto & jump_flood_program = ctx.game.assets.programs.get("jump_flood_3d"_name);
 		glUseProgram(jump_flood_program.id);
 
 		i32 read_volume_unit;
@@ -366,7 +389,7 @@ void Sdf3dWindow::calculate_sdf(const Editor::Context & ctx)
 
 	/// Finalize jump flood
 	{
-		auto & jump_flood_finalize = ctx.game.assets.programs.get("jump_flood_3d_finalize");
+		auto & jump_flood_finalize = ctx.game.assets.programs.get("jump_flood_3d_finalize"_name);
 		glUseProgram(jump_flood_finalize.id);
 		i32 volume_unit;
 		glGetUniformiv(
@@ -396,7 +419,7 @@ void Sdf3dWindow::visualize_volume(const Editor::Context & ctx)
 	glDisable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST), glDepthFunc(GL_LESS), glDepthMask(false);
 
-	auto & program = ctx.game.assets.programs.get("is_in_volume");
+	auto & program = ctx.game.assets.programs.get("is_in_volume"_name);
 	glUseProgram(program.id);
 
 	glUniformHandleui64ARB(
@@ -419,7 +442,7 @@ void Sdf3dWindow::visualize_voxels(const Editor::Context & ctx)
 	glDisable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST), glDepthFunc(GL_LESS), glDepthMask(true);
 
-	auto & voxel_to_cube_program = ctx.game.assets.programs.get("voxel_to_cube");
+	auto & voxel_to_cube_program = ctx.game.assets.programs.get("voxel_to_cube"_name);
 	glUseProgram(voxel_to_cube_program.id);
 	glUniformHandleui64ARB(
 		GetLocation(voxel_to_cube_program.uniform_mappings, "volume"),
@@ -457,7 +480,7 @@ void Sdf3dWindow::visualize_isosurface(const Editor::Context & ctx)
 	glEnable(GL_CULL_FACE);
 	glEnable(GL_DEPTH_TEST), glDepthFunc(GL_LESS), glDepthMask(true);
 
-	auto & isosurface_program = ctx.game.assets.programs.get("isosurface");
+	auto & isosurface_program = ctx.game.assets.programs.get("isosurface"_name);
 	glUseProgram(isosurface_program.id);
 	glUniformHandleui64ARB(
 		GetLocation(isosurface_program.uniform_mappings, "sdf"),
@@ -2,7 +2,10 @@
 
 #include <core/core.hpp>
 #include <core/named.hpp>
+#include <core/profiler.hpp>
 #include <opengl/globals.hpp>
+#include <render/lod.hpp>
+#include <render/meshlet_culling.hpp>
 
 // !!! Temporary
 i32 const line_count_axis = 8;
@@ -37,18 +40,30 @@ void Game::create_uniform_buffers()
 {
 	using namespace GL;
 
-	// Setup FrameInfo uniform buffer
-	auto & frame_info_uniform_block = assets.uniform_blocks.get("FrameInfo"_name);
-
-	frame_info_uniform_buffer.init(
-		MappedBuffer::UniformBlockDesc{
-			.uniform_block = frame_info_uniform_block,
-			.array_size = 1,
-		}
+	// FrameInfo and Camera uniform buffers are allocated from frame_ring_buffer every frame
+	// and written as whole structs
+	assert(
+		assets.uniform_blocks.get("FrameInfo"_name).is_layout_of(sizeof(FrameInfoData), {
+			GL_STRUCT_MEMBER(FrameInfoData, depth_attachment_handle, "DepthAttachmentHandle"),
+			GL_STRUCT_MEMBER(FrameInfoData, color_attachment_handle, "ColorAttachmentHandle"),
+			GL_STRUCT_MEMBER(FrameInfoData, frame_idx, "FrameIdx"),
+			GL_STRUCT_MEMBER(FrameInfoData, seconds_since_start, "SecondsSinceStart"),
+			GL_STRUCT_MEMBER(FrameInfoData, seconds_since_last_frame, "SecondsSinceLastFrame"),
+		}),
+		"FrameInfoData does not match the FrameInfo block"
+	);
+	assert(
+		assets.uniform_blocks.get("Camera"_name).is_layout_of(sizeof(CameraData), {
+			GL_STRUCT_MEMBER(CameraData, view, "TransformV"),
+			GL_STRUCT_MEMBER(CameraData, projection, "TransformP"),
+			GL_STRUCT_MEMBER(CameraData, view_projection, "TransformVP"),
+			GL_STRUCT_MEMBER(CameraData, view_inv, "TransformV_inv"),
+			GL_STRUCT_MEMBER(CameraData, projection_inv, "TransformP_inv"),
+			GL_STRUCT_MEMBER(CameraData, view_projection_inv, "TransformVP_inv"),
+			GL_STRUCT_MEMBER(CameraData, world_position, "CameraWorldPosition"),
+		}),
+		"CameraData does not match the Camera block"
 	);
-
-	glBindBufferBase(GL_UNIFORM_BUFFER, frame_info_uniform_block.binding, frame_info_uniform_buffer.id);
-
 
 	// Setup Lights Uniform Buffer
 	auto & lights_uniform_block = assets.uniform_blocks.get("Lights"_name);
@@ -64,44 +79,31 @@ void Game::create_uniform_buffers()
 	glBindBufferBase(GL_UNIFORM_BUFFER, lights_uniform_block.binding, lights_uniform_buffer.id);
 
 	auto * map = (byte *) glMapNamedBuffer(lights_uniform_buffer.id, GL_WRITE_ONLY);
-	lights_uniform_block.set(map, "Lights[0].position", f32x3{4, 5, 5});
-	lights_uniform_block.set(map, "Lights[0].color", f32x3{2});
-	lights_uniform_block.set(map, "Lights[0].range", f32{10 * 2});
-	lights_uniform_block.set(map, "Lights[0].is_active", true);
-
-	lights_uniform_block.set(map, "Lights[1].position", f32x3{5, 4, 5});
-	lights_uniform_block.set(map, "Lights[1].color", f32x3{2});
-	lights_uniform_block.set(map, "Lights[1].range", f32{10 * 2});
-	lights_uniform_block.set(map, "Lights[1].is_active", true);
-
-	lights_uniform_block.set(map, "Lights[2].position", f32x3{5, 5, 4});
-	lights_uniform_block.set(map, "Lights[2].color", f32x3{2});
-	lights_uniform_block.set(map, "Lights[2].range", f32{10 * 2});
-	lights_uniform_block.set(map, "Lights[2].is_active", true);
-
-	lights_uniform_block.set(map, "Lights[3].position", f32x3{-10, 1, 0});
-	lights_uniform_block.set(map, "Lights[3].color", f32x3{0, 0, 1});
-	lights_uniform_block.set(map, "Lights[3].range", f32{2.5 * 2});
-	lights_uniform_block.set(map, "Lights[3].is_active", false);
+	lights_uniform_block.set(map, "Lights[0].position"_name, f32x3{4, 5, 5});
+	lights_uniform_block.set(map, "Lights[0].color"_name, f32x3{2});
+	lights_uniform_block.set(map, "Lights[0].range"_name, f32{10 * 2});
+	lights_uniform_block.set(map, "Lights[0].is_active"_name, true);
+
+	lights_uniform_block.set(map, "Lights[1].position"_name, f32x3{5, 4, 5});
+	lights_uniform_block.set(map, "Lights[1].color"_name, f32x3{2});
+	lights_uniform_block.set(map, "Lights[1].range"_name, f32{10 * 2});
+	lights_uniform_block.set(map, "Lights[1].is_active"_name, true);
+
+	lights_uniform_block.set(map, "Lights[2].position"_name, f32x3{5, 5, 4});
+	lights_uniform_block.set(map, "Lights[2].color"_name, f32x3{2});
+	lights_uniform_block.set(map, "Lights[2].range"_name, f32{10 * 2});
+	lights_uniform_block.set(map, "Lights[2].is_active"_name, true);
+
+	lights_uniform_block.set(map, "Lights[3].position"_name, f32x3{-10, 1, 0});
+	lights_uniform_block.set(map, "Lights[3].color"_name, f32x3{0, 0, 1});
+	lights_uniform_block.set(map, "Lights[3].range"_name, f32{2.5 * 2});
+	lights_uniform_block.set(map, "Lights[3].is_active"_name, false);
 	glUnmapNamedBuffer(lights_uniform_buffer.id);
 
 
-	// Setup Camera Uniform Buffer
-	auto & camera_uniform_block = assets.uniform_blocks.get("Camera"_name);
-
-	camera_uniform_buffer.init(
-		MappedBuffer::UniformBlockDesc{
-			.uniform_block = camera_uniform_block,
-			.array_size = 1,
-		}
-	);
-
-	glBindBufferBase(GL_UNIFORM_BUFFER, camera_uniform_block.binding, camera_uniform_buffer.id);
-
-
 	// Setup GLTF Material Block and Buffer
 	auto & material_block = Render::Material_gltf_pbrMetallicRoughness::block;
-	material_block.init(
+	Render::Material_gltf_pbrMetallicRoughness::init_block(
 		{
 			.layout = GetMapping(
 				assets.programs.get(GLTF::pbrMetallicRoughness_program_name).storage_block_mappings, "Material"
@@ -113,18 +115,39 @@ void Game::create_uniform_buffers()
 		Buffer::StorageBlockDesc{
 			.usage = GL_DYNAMIC_DRAW,
 			.storage_block = material_block,
-			.array_size = glm::max(usize(16), assets.materials.resources.size()),
+			.array_size = glm::max(usize(16), assets.materials.slot_count()),
+		}
+	);
+
+	// the materials are already in the std430 layout, the array buffer is an array of them
+	using Material = Render::Material_gltf_pbrMetallicRoughness;
+	gltf_material_array_stride = sizeof(Material);
+	gltf_material_array_buffer.init(
+		Buffer::EmptyDesc{
+			.usage = GL_DYNAMIC_DRAW,
+			.size = gltf_material_array_stride * glm::max(usize(16), assets.materials.slot_count()),
 		}
 	);
 
 	auto * buffer = (byte *) glMapNamedBuffer(gltf_material_buffer.id, GL_WRITE_ONLY);
-	for (auto i = 0; auto & [name, material]: assets.materials)
+	auto * array_buffer = (byte *) glMapNamedBuffer(gltf_material_array_buffer.id, GL_WRITE_ONLY);
+	// indexed by slot, so the handles of the materials stay valid as buffer indices
+	auto const & materials = assets.materials;
+	bool is_dense_in_slot_order = true;
+	for (u32 i = 0; i < materials.datas.size(); ++i)
 	{
-		gltf_material2index.emplace(name, i);
-		material->write_to_buffer(buffer + i * material_block.aligned_size);
-		i++;
+		auto slot = materials.dense2slot[i];
+		std::memcpy(buffer + slot * material_block.aligned_size, materials.datas[i].data(), sizeof(Material));
+		is_dense_in_slot_order &= slot == i;
 	}
+	// slots follow the dense order unless a material was erased
+	if (is_dense_in_slot_order)
+		std::memcpy(array_buffer, materials.datas.data(), materials.datas.size() * sizeof(Material));
+	else
+		for (u32 i = 0; i < materials.datas.size(); ++i)
+			std::memcpy(array_buffer + materials.dense2slot[i] * sizeof(Material), materials.datas[i].data(), sizeof(Material));
 	glUnmapNamedBuffer(gltf_material_buffer.id);
+	glUnmapNamedBuffer(gltf_material_array_buffer.id);
 }
 
 void Game::init()
@@ -132,6 +155,21 @@ void Game::init()
 	create_framebuffer();
 	create_uniform_buffers();
 
+	// the draws only bind the matrices, a program without the block would read garbage silently
+	{
+		using namespace GLTF;
+		for (auto const & program_name: {pbrMetallicRoughness_program_name, pbrMetallicRoughness_indirect_program_name})
+		{
+			if (not assets.programs.contains(program_name))
+				continue;
+
+			auto const & mappings = assets.programs.get(program_name).storage_block_mappings;
+			auto const transforms = std::ranges::find(mappings, "Transforms", &GL::StorageBlockMapping::key);
+			assert(transforms != mappings.end(), "gltf program has no Transforms storage block, see TRANSFORM_BINDING");
+			assert(transforms->location == TRANSFORM_BINDING, "Transforms storage block must be at TRANSFORM_BINDING");
+		}
+	}
+
 	camera = Render::PerspectiveCamera{
 		.position = {5, 2, 0},
 		.up = {0, 1, 0},
@@ -142,10 +180,21 @@ void Game::init()
 		.aspect_ratio = f32(framebuffer.resolution.x) / f32(framebuffer.resolution.y),
 	};
 
-	// load all the meshes to the gpu
-	for (auto & [_, mesh]: assets.meshes)
+	// load all the meshes to the gpu, their vertex arrays read the instance matrices from instance_buffer
+	instance_buffer.init(GL::Buffer::EmptyDesc{.usage = GL::GL_STREAM_DRAW, .size = sizeof(f32x4x4)});
+	for (auto & mesh: assets.meshes.datas)
 		for (auto & drawable: mesh.drawables)
-			drawable.load();
+			drawable.load(instance_buffer);
+
+	// and pack them for the indirect draws
+	{
+		vector<Geometry::Primitive const *> primitives;
+		for (auto & mesh: assets.meshes.datas)
+			for (auto & drawable: mesh.drawables)
+				primitives.push_back(&drawable.primitive);
+		multi_draw.pack(primitives);
+		multi_draw.load();
+	}
 
 	// fallback to default envmap
 	if (not assets.texture_cubemaps.contains(settings.envmap_diffuse, settings.envmap_specular))
@@ -166,7 +215,7 @@ void Game::init()
 
 	// init lines_vao
 	{
-		lines_geo.layout = &assets.vertex_layouts.get(assets.programs.get("lines_draw").vertex_layout_name);
+		lines_geo.layout = &assets.vertex_layouts.get(assets.programs.get("lines_draw"_name).vertex_layout_name);
 
 		auto const vertex_count = line_count * line_length;
 
@@ -273,6 +322,8 @@ void Game::init()
 
 void Game::update(GLFW::Window const & window, Render::FrameInfo const & frame_info)
 {
+	PROFILE_ZONE("Game::update");
+
 	//	camera movement with WASD+QE+CTRL
 	{
 		auto dir = f32x3(0);
@@ -297,7 +348,10 @@ void Game::update(GLFW::Window const & window, Render::FrameInfo const & frame_i
 	}
 
 	// Update scene tree
-	assets.scene_tree.update_transforms();
+	{
+		auto const & changed_indices = assets.scene_tree.update_transforms();
+		scene_bvh.update(assets.scene_tree, assets.meshes, changed_indices);
+	}
 
 	if (GLFW_PRESS == glfwGetKey(window, GLFW_KEY_R))
 		lines_vao.update(lines_geo);
@@ -307,40 +361,76 @@ void Game::update(GLFW::Window const & window, Render::FrameInfo const & frame_i
 
 void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_info)
 {
+	PROFILE_ZONE("Game::render");
+
 	using namespace GL;
 
+	auto & ring = frame_ring_buffer;
+	auto & frame_info_block = assets.uniform_blocks.get("FrameInfo"_name);
+	auto & camera_block = assets.uniform_blocks.get("Camera"_name);
+
+	// upper bound of the frame's transient data, the ring can only grow before the first allocation
+	{
+		usize drawable_count = 0;
+		for (auto const & level: assets.scene_tree.levels)
+			for (auto const & mesh: level.meshes)
+				if (not mesh.is_null())
+					drawable_count += assets.meshes.get(mesh).drawables.size();
+
+		usize size = ring.allocator.align(frame_info_block.aligned_size) + ring.allocator.align(camera_block.aligned_size);
+		// at worst every dirty material is its own range
+		size += gltf_material_is_dirty.size() * (
+			ring.allocator.align(sizeof(Render::Material_gltf_pbrMetallicRoughness))
+			+ ring.allocator.align(Render::Material_gltf_pbrMetallicRoughness::block.aligned_size)
+		);
+		size += ring.allocator.align(assets.scene_tree.size() * sizeof(f32x4x4));
+		size += multi_draw.batches.size() * 2 * ring.allocator.alignment
+				+ drawable_count * (sizeof(Render::DrawElementsIndirectCommand) + sizeof(Render::DrawData));
+		ring.reserve(size);
+	}
+
 	// Update gltf materials !!! Temporary
 	{
-		auto & block = Render::Material_gltf_pbrMetallicRoughness::block;
+		using Material = Render::Material_gltf_pbrMetallicRoughness;
+		auto const aligned_size = Material::block.aligned_size;
+		auto const & materials = assets.materials;
 
-		while (not gltf_material_is_dirty.empty())
+		// a copy per contiguous range of dirty slots, staged in the ring so the copies do not wait for the draws
+		gltf_material_is_dirty.for_each_range([&](u32 first, u32 count)
 		{
-			auto & name = gltf_material_is_dirty.front();
-			auto & material = assets.materials.get(name);
-
-			auto * map = (byte *) glMapNamedBufferRange(
-				gltf_material_buffer.id,
-				gltf_material2index.at(name) * block.aligned_size,
-				block.data_size,
-				BufferAccessMask::GL_MAP_WRITE_BIT
-			);
-			material->write_to_buffer(map);
-			glUnmapNamedBuffer(gltf_material_buffer.id);
+			auto packed = ring.allocate(count * sizeof(Material));
+			auto aligned = ring.allocate(count * aligned_size);
+			for (u32 i = 0; i < count; ++i)
+			{
+				auto const & material = materials.datas[materials.slots[first + i].dense_index];
+				std::memcpy(packed.pointer + i * sizeof(Material), &material, sizeof(Material));
+				std::memcpy(aligned.pointer + i * aligned_size, &material, sizeof(Material));
+			}
 
-			gltf_material_is_dirty.pop();
-		}
+			glCopyNamedBufferSubData(
+				ring.id, gltf_material_array_buffer.id,
+				packed.offset, first * gltf_material_array_stride, packed.size
+			);
+			glCopyNamedBufferSubData(
+				ring.id, gltf_material_buffer.id,
+				aligned.offset, first * aligned_size, aligned.size
+			);
+		});
+		gltf_material_is_dirty.clear();
 	}
 
 	// Update FrameInfo uniform buffer
 	{
-		auto & map = frame_info_uniform_buffer.map;
-		auto & block = assets.uniform_blocks.get("FrameInfo"_name);
-		block.set(map, "DepthAttachmentHandle", framebuffer.depth.handle);
-		block.set(map, "ColorAttachmentHandle", framebuffer.color0.handle);
-		block.set(map, "FrameIdx", frame_info.idx);
-		block.set(map, "SecondsSinceStart", frame_info.seconds_since_start);
-		block.set(map, "SecondsSinceLastFrame", frame_info.seconds_since_last_frame);
-		glFlushMappedNamedBufferRange(frame_info_uniform_buffer.id, 0, block.aligned_size);
+		auto & block = frame_info_block;
+		auto allocation = ring.allocate(block.aligned_size);
+		block.set_struct(allocation.pointer, FrameInfoData{
+			.depth_attachment_handle = framebuffer.depth.handle,
+			.color_attachment_handle = framebuffer.color0.handle,
+			.frame_idx = frame_info.idx,
+			.seconds_since_start = f32(frame_info.seconds_since_start),
+			.seconds_since_last_frame = frame_info.seconds_since_last_frame,
+		});
+		ring.bind(GL_UNIFORM_BUFFER, block.binding, allocation);
 	}
 
 	auto camera_position = visit([](Render::Camera auto & c) { return c.position; }, camera);
@@ -350,16 +440,18 @@ void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_i
 
 	// Update Camera Uniform Buffer
 	{
-		auto & map = camera_uniform_buffer.map;
-		auto & block = assets.uniform_blocks.get("Camera"_name);
-		block.set(map, "TransformV", view);
-		block.set(map, "TransformP", projection);
-		block.set(map, "TransformVP", view_projection);
-		block.set(map, "TransformV_inv", glm::inverse(view));
-		block.set(map, "TransformP_inv", glm::inverse(projection));
-		block.set(map, "TransformVP_inv", glm::inverse(view_projection));
-		block.set(map, "CameraWorldPosition", camera_position);
-		glFlushMappedNamedBufferRange(camera_uniform_buffer.id, 0, block.aligned_size);
+		auto & block = camera_block;
+		auto allocation = ring.allocate(block.aligned_size);
+		block.set_struct(allocation.pointer, CameraData{
+			.view = view,
+			.projection = projection,
+			.view_projection = view_projection,
+			.view_inv = glm::inverse(view),
+			.projection_inv = glm::inverse(projection),
+			.view_projection_inv = glm::inverse(view_projection),
+			.world_position = camera_position,
+		});
+		ring.bind(GL_UNIFORM_BUFFER, block.binding, allocation);
 	}
 
 	// Clear framebuffer
@@ -376,7 +468,18 @@ void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_i
 		glEnable(GL_CULL_FACE), glCullFace(GL_BACK);
 		glColorMask(true, true, true, true), glDepthMask(true), glDepthFunc(GL_LESS);
 
-		auto const & gltf_pbr_program = assets.programs.get(GLTF::pbrMetallicRoughness_program_name);
+		using enum Settings::DrawMode;
+		auto draw_mode = settings.draw_mode;
+		auto program_name = GLTF::pbrMetallicRoughness_program_name;
+		if (draw_mode == Instanced)
+			program_name = GLTF::pbrMetallicRoughness_instanced_program_name;
+		if (draw_mode == MultiDrawIndirect)
+			program_name = GLTF::pbrMetallicRoughness_indirect_program_name;
+		// the variants are optional
+		if (not assets.programs.contains(program_name))
+			draw_mode = Sorted, program_name = GLTF::pbrMetallicRoughness_program_name;
+
+		auto const & gltf_pbr_program = assets.programs.get(program_name);
 		glUseProgram(gltf_pbr_program.id);
 
 		glUniformHandleui64ARB(
@@ -392,45 +495,241 @@ void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_i
 			assets.textures.get("envmap_brdf_lut"_name).handle
 		);
 
-		auto location_TransformM = GetLocation(gltf_pbr_program.uniform_mappings, "TransformM");
-		auto location_TransformMVP = GetLocation(gltf_pbr_program.uniform_mappings, "TransformMVP");
+		auto const frustum = Geometry::Frustum::from_view_projection(view_projection);
+		auto const lod_selector = Render::LodSelector::make(
+			projection, camera_position, framebuffer.resolution.y, settings.lod_pixel_error
+		);
+		auto const meshlet_culler = Render::MeshletCuller::make(frustum, view, projection);
+		render_stats = {};
+
+		// nodes are culled with the bvh, their drawables one by one
+		std::pmr::vector<Scene::Tree::Index> visible_nodes(&Render::frame_allocator);
+		if (settings.is_frustum_culling_on)
+			scene_bvh.bvh.query(frustum, [&](u32 item) { visible_nodes.push_back(scene_bvh.item2node[item]); });
+		else
+			visible_nodes.assign(scene_bvh.item2node.begin(), scene_bvh.item2node.end());
+
+		render_stats.node_count = scene_bvh.item2node.size();
+		render_stats.culled_node_count = render_stats.node_count - visible_nodes.size();
+
+		// visible node i's matrix is transforms[i], instances read theirs from the instance buffer
+		// both include the dequantization of the mesh, culling and lods stay in the node's object space
+		if (draw_mode != Instanced and not visible_nodes.empty())
+		{
+			auto allocation = ring.allocate(visible_nodes.size() * sizeof(f32x4x4));
+			auto transforms = (f32x4x4 *) allocation.pointer;
+			assets.scene_tree.gather_matrices(visible_nodes, transforms);
+			for (auto const & [depth, i]: visible_nodes)
+				*transforms++ *= assets.meshes.get(assets.scene_tree.levels[depth].meshes[i]).dequantization;
+			ring.bind(GL_SHADER_STORAGE_BUFFER, TRANSFORM_BINDING, allocation);
+		}
+
+		// visible drawables are sorted to minimize the state changes
+		// a draw is a range of a lod, or the runs of the visible meshlets of the full detail
+		struct Draw
+		{
+			u32 transform_index;
+			u32 first_range;
+			u32 range_count;
+			Render::Drawable const * drawable;
+		};
+		std::pmr::vector<Draw> draws(&Render::frame_allocator);
+		std::pmr::vector<GL::VertexArray::ElementRange> draw_ranges(&Render::frame_allocator);
+		render_queue.clear();
+		multi_draw.clear();
+
+		// instances are only culled per node, so the drawables of a mesh stay together
+		std::pmr::vector<Handle<Render::Mesh>> instance_meshes(&Render::frame_allocator);
+		std::pmr::vector<f32x4x4 const *> instance_matrices(&Render::frame_allocator);
+
+		for (u32 transform_index = 0; transform_index < visible_nodes.size(); ++transform_index)
+		{
+			auto const & [depth, i] = visible_nodes[transform_index];
+			auto const & level = assets.scene_tree.levels[depth];
+			auto const & mesh = level.meshes[i];
+			auto const & matrix = level.matrices[i];
 
-		for (auto & depth: assets.scene_tree.nodes)
-			for (auto & node: depth)
+			if (draw_mode == Instanced)
 			{
-				if (node.mesh == nullptr)
+				instance_meshes.push_back(mesh);
+				instance_matrices.push_back(&matrix);
+				render_stats.drawable_count += assets.meshes.get(mesh).drawables.size();
+				continue;
+			}
+
+			for (auto & drawable: assets.meshes.get(mesh).drawables)
+			{
+				render_stats.drawable_count++;
+				auto world_box = drawable.primitive.bounds.box.transformed(matrix);
+				if (settings.is_frustum_culling_on and not frustum.intersects(world_box))
+				{
+					render_stats.culled_drawable_count++;
 					continue;
+				}
+
+				if (draw_mode == MultiDrawIndirect)
+				{
+					multi_draw.push(drawable.primitive, transform_index, drawable.material.index);
+					render_stats.triangle_count += drawable.vertex_array.element_count / 3;
+					continue;
+				}
 
-				glUniformMatrix4fv(location_TransformM, 1, false, begin(node.matrix));
-				auto transform_mvp = view_projection * node.matrix;
-				glUniformMatrix4fv(location_TransformMVP, 1, false, begin(transform_mvp));
+				auto const lod = settings.is_lod_on ? lod_selector.select(drawable.primitive, matrix, world_box) : 0;
 
-				for (auto & drawable: node.mesh->drawables)
+				auto const first_range = u32(draw_ranges.size());
+				auto const & lod_range = drawable.vertex_array.element_ranges[lod];
+				if (lod == 0 and settings.is_meshlet_culling_on and not drawable.primitive.meshlets.empty())
 				{
-					// Bind Material Buffer
-					auto & material_block = Render::Material_gltf_pbrMetallicRoughness::block;
-					glBindBufferRange(
-						GL_SHADER_STORAGE_BUFFER, material_block.binding, gltf_material_buffer.id,
-						gltf_material2index.at(drawable.named_material.name) * material_block.aligned_size,
-						material_block.data_size
+					render_stats.meshlet_count += drawable.primitive.meshlets.size();
+					render_stats.culled_meshlet_count += meshlet_culler.cull(
+						drawable.primitive, matrix,
+						[&](u32 first, u32 count) { draw_ranges.push_back({.first = lod_range.first + first, .count = count}); }
 					);
+					if (draw_ranges.size() == first_range)
+					{
+						render_stats.culled_drawable_count++;
+						continue;
+					}
+				}
+				else
+					draw_ranges.push_back(lod_range);
+
+				auto key = Render::SortKey::make(
+					Render::SortKey::Pass::Opaque, gltf_pbr_program.id, drawable.material.index, drawable.vertex_array.id,
+					glm::distance(camera_position, world_box.center())
+				);
+				render_queue.push(key, draws.size());
+				draws.push_back({
+					.transform_index = transform_index,
+					.first_range = first_range,
+					.range_count = u32(draw_ranges.size()) - first_range,
+					.drawable = &drawable,
+				});
+			}
+		}
+
+		u32 bound_material_index = std::numeric_limits<u32>::max();
+		auto const bind_material = [&](u32 material_index)
+		{
+			if (material_index == bound_material_index)
+				return;
+
+			// Bind Material Buffer
+			auto & material_block = Render::Material_gltf_pbrMetallicRoughness::block;
+			glBindBufferRange(
+				GL_SHADER_STORAGE_BUFFER, material_block.binding, gltf_material_buffer.id,
+				material_index * material_block.aligned_size,
+				material_block.data_size
+			);
+			bound_material_index = material_index;
+			render_stats.material_bind_count++;
+		};
+
+		u32 bound_vertex_array = 0;
+		auto const bind_vertex_array = [&](u32 vertex_array)
+		{
+			if (vertex_array == bound_vertex_array)
+				return;
+
+			glBindVertexArray(vertex_array);
+			bound_vertex_array = vertex_array;
+			render_stats.vertex_array_bind_count++;
+		};
+
+		if (draw_mode == Instanced and not instance_meshes.empty())
+		{
+			instance_groups.build(instance_meshes, instance_matrices);
+			for (auto const & group: instance_groups.groups)
+			{
+				auto const & dequantization = assets.meshes.get(group.mesh).dequantization;
+				for (auto & matrix: span(instance_groups.matrices).subspan(group.first_instance, group.instance_count))
+					matrix *= dequantization;
+			}
+
+			auto const & matrices = instance_groups.matrices;
+			glNamedBufferData(
+				instance_buffer.id,
+				matrices.size() * sizeof(f32x4x4), matrices.data(), GL_STREAM_DRAW
+			);
 
-					glBindVertexArray(drawable.vertex_array.id);
-					glDrawElements(GL_TRIANGLES, drawable.vertex_array.element_count, GL_UNSIGNED_INT, nullptr);
+			for (auto const & group: instance_groups.groups)
+				for (auto const & drawable: assets.meshes.get(group.mesh).drawables)
+				{
+					bind_material(drawable.material.index);
+					bind_vertex_array(drawable.vertex_array.id);
+					glDrawElementsInstancedBaseInstance(
+						GL_TRIANGLES, drawable.vertex_array.element_count, GL_UNSIGNED_INT, nullptr,
+						group.instance_count, group.first_instance
+					);
+					render_stats.triangle_count += drawable.vertex_array.element_count / 3 * group.instance_count;
+					render_stats.draw_count += group.instance_count;
+					render_stats.draw_call_count++;
 				}
+
+			render_stats.instance_count = matrices.size();
+			render_stats.instance_group_count = instance_groups.groups.size();
+		}
+
+		if (draw_mode == MultiDrawIndirect)
+		{
+			multi_draw.upload(ring);
+
+			auto & material_block = Render::Material_gltf_pbrMetallicRoughness::block;
+			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, material_block.binding, gltf_material_array_buffer.id);
+
+			for (auto const & batch: multi_draw.batches)
+			{
+				auto const draw_count = batch.commands.commands.size();
+				if (draw_count == 0)
+					continue;
+
+				glBindVertexArray(batch.vertex_array.id);
+				ring.bind(GL_SHADER_STORAGE_BUFFER, Render::MultiDraw::DRAW_BINDING, batch.draw_allocation);
+				glBindBuffer(GL_DRAW_INDIRECT_BUFFER, ring.id);
+				glMultiDrawElementsIndirect(
+					GL_TRIANGLES, GL_UNSIGNED_INT, (void const *) batch.command_allocation.offset, GLsizei(draw_count), 0
+				);
+
+				render_stats.draw_count += draw_count;
+				render_stats.draw_call_count++;
+				render_stats.vertex_array_bind_count++;
+			}
+			glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+		}
+
+		render_queue.sort();
+
+		for (auto const & entry: render_queue.entries)
+		{
+			auto const & [transform_index, first_range, range_count, drawable] = draws[entry.index];
+
+			bind_material(drawable->material.index);
+			bind_vertex_array(drawable->vertex_array.id);
+
+			// the base instance is the draw id the shader indexes the transforms with
+			for (auto const & [first, count]: span(draw_ranges).subspan(first_range, range_count))
+			{
+				glDrawElementsInstancedBaseInstance(
+					GL_TRIANGLES, GLsizei(count), GL_UNSIGNED_INT, (void const *) (first * sizeof(u32)),
+					1, transform_index
+				);
+				render_stats.triangle_count += count / 3;
+				render_stats.draw_call_count++;
 			}
+			render_stats.draw_count++;
+		}
 	}
 
 	// Lines
 	{
 		if (settings.is_lines_active and frame_info.idx % 2 == 0)
 		{
-			auto & paths_program = assets.programs.get("lines_generate_paths");
+			auto & paths_program = assets.programs.get("lines_generate_paths"_name);
 			glUseProgram(paths_program.id);
 			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lines_vao.vertex_buffer.id);
 			glUniformHandleui64ARB(
 				GetLocation(paths_program.uniform_mappings, "sdf"),
-				assets.volumes.get("voxels_linear_view").handle
+				assets.volumes.get("voxels_linear_view"_name).handle
 			);
 			for (auto i = 0; i < settings.lines_update_per_frame; ++i)
 			{
@@ -438,14 +737,14 @@ void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_i
 				glMemoryBarrier(GL_SHADER_STORAGE_BARRIER_BIT);
 			}
 
-			auto & tubes_program = assets.programs.get("lines_generate_tubes");
+			auto & tubes_program = assets.programs.get("lines_generate_tubes"_name);
 			glUseProgram(tubes_program.id);
 			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, lines_vao.vertex_buffer.id);
 			glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, tubes_vao.vertex_buffer.id);
 			glDispatchCompute(1, 1, 1);
 		}
 
-		auto & lines_program = assets.programs.get("lines_draw");
+		auto & lines_program = assets.programs.get("lines_draw"_name);
 		glUseProgram(lines_program.id);
 
 		glDisable(GL_CULL_FACE);
@@ -468,7 +767,7 @@ void Game::render(GLFW::Window const & window, Render::FrameInfo const & frame_i
 		};
 
 		glDepthMask(false), glDepthFunc(GL_LEQUAL);
-		auto & environment_map_program = assets.programs.get("environment_mapping");
+		auto & environment_map_program = assets.programs.get("environment_mapping"_name);
 		glUseProgram(environment_map_program.id);
 		glUniformHandleui64ARB(
 			GetLocation(environment_map_program.uniform_mappings, "environment_map"),
@@ -1,12 +1,14 @@
 #pragma once
 
 #include <asset_recipes/assets.hpp>
+#include <core/dirty_set.hpp>
 #include <opengl/core.hpp>
 #include <opengl/mapped_buffer.hpp>
 #include <opengl/framebuffer.hpp>
 #include <render/glfw.hpp>
 #include <render/frame_info.hpp>
 #include <render/game_base.hpp>
+#include <render/multi_draw.hpp>
 
 struct Game : Render::GameBase
 {
@@ -21,6 +23,18 @@ struct Game : Render::GameBase
 	struct Settings
 	{
 		bool is_zpass_on = false;
+		bool is_frustum_culling_on = true;
+
+		enum struct DrawMode : u8
+		{
+			Sorted,
+			Instanced,
+			MultiDrawIndirect,
+		} draw_mode = DrawMode::Sorted;
+
+		bool is_lod_on = true; // only the sorted draws pick lods
+		f32 lod_pixel_error = 1;
+		bool is_meshlet_culling_on = true; // only the sorted draws of the full detail
 
 		bool is_environment_mapping_comp = false;
 		Name envmap_diffuse = "envmap_diffuse";
@@ -32,12 +46,40 @@ struct Game : Render::GameBase
 		i32 lines_update_per_frame = 8;
 	} settings;
 
-	GL::MappedBuffer frame_info_uniform_buffer;
 	GL::Buffer lights_uniform_buffer;
-	GL::MappedBuffer camera_uniform_buffer;
 	GL::Buffer gltf_material_buffer; 									// !!! Temporary
-	std::unordered_map<Name, u32, Name::Hasher> gltf_material2index;	// !!! Temporary
-	std::queue<Name> gltf_material_is_dirty;							// !!! Temporary
+	GL::Buffer gltf_material_array_buffer;								// !!! Temporary, tightly packed for the indirect draws
+	usize gltf_material_array_stride;
+	DirtySet gltf_material_is_dirty;									// !!! Temporary, by material slot
+
+	// mirror the FrameInfo and Camera uniform blocks, checked in create_uniform_buffers
+	struct FrameInfoData
+	{
+		u64 depth_attachment_handle;
+		u64 color_attachment_handle;
+		u64 frame_idx;
+		f32 seconds_since_start;
+		f32 seconds_since_last_frame;
+	};
+	struct CameraData
+	{
+		f32x4x4 view;
+		f32x4x4 projection;
+		f32x4x4 view_projection;
+		f32x4x4 view_inv;
+		f32x4x4 projection_inv;
+		f32x4x4 view_projection_inv;
+		f32x3 world_position;
+	};
+
+	// world matrices of the visible nodes, allocated from frame_ring_buffer, the draws index them
+	// shader contract of the sorted and indirect gltf programs, checked in init:
+	//	layout(std430, binding = 5) readonly buffer Transforms { mat4 transforms[]; };
+	//	sorted draws read transforms[gl_BaseInstanceARB] (ARB_shader_draw_parameters), the base instance is the index
+	//	indirect draws read transforms[draws[gl_DrawIDARB].transform_index], see Render::MultiDraw
+	static constexpr u32 TRANSFORM_BINDING = 5;
+
+	Render::MultiDraw multi_draw;
 
 	void create_framebuffer();
 	void create_uniform_buffers();
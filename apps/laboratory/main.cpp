@@ -1,4 +1,6 @@
 #include <core/core.hpp>
+#include <core/jobs.hpp>
+#include <core/profiler.hpp>
 #include <opengl/core.hpp>
 #include <opengl/globals.hpp>
 #include <opengl/use_dedicated_device_by_default.hpp>
@@ -39,6 +41,10 @@ i32 main(i32 argc, char** argv)
 		std::exit(1);
 	}
 
+	// startup is captured until the main loop, can be saved from the Metrics window
+	Profiler::set_thread_name("Main");
+	Profiler::start_capture();
+
 	GLFW::Context glfw_context;
 	GLFW::Window window;
 	Imgui::Context imgui_context;
@@ -68,6 +74,8 @@ i32 main(i32 argc, char** argv)
 	GL::init();
 	GL::init_globals();
 
+	Jobs::init({});
+
 	// Project assets
 	Descriptions descriptions;
 	descriptions.init(project_root);
@@ -91,6 +99,11 @@ i32 main(i32 argc, char** argv)
 	editor_ctx.add_window(make_unique_one<Sdf3dWindow>());
 	editor_ctx.init();
 
+	Profiler::stop_capture();
+
+	Render::frame_allocator.init({.capacity = 4 << 20});
+	game.frame_ring_buffer.init({.segment_size = 4 << 20});
+
 	Render::FrameInfo frame_info;
 	Render::FrameInfo previous_frame_info{
 		.idx = 0,
@@ -100,8 +113,16 @@ i32 main(i32 argc, char** argv)
 
 	while (not glfwWindowShouldClose(window))
 	{
+		Profiler::frame_mark();
+		PROFILE_ZONE("Frame");
+
+		Render::frame_allocator.reset();
+		game.frame_ring_buffer.begin_frame();
+
 		glfwPollEvents();
 
+		Jobs::run_main_queue();
+
 		frame_info.seconds_since_start = glfwGetTime();
 		frame_info.seconds_since_last_frame = frame_info.seconds_since_start - previous_frame_info.seconds_since_start;
 		frame_info.idx = previous_frame_info.idx + 1;
@@ -150,10 +171,14 @@ i32 main(i32 argc, char** argv)
 		ImGui::Render();
 		ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
 
+		game.frame_ring_buffer.end_frame();
+
 		glfwSwapBuffers(window);
 
 		previous_frame_info = frame_info;
 	}
 
+	Jobs::shutdown();
+
 	return 0;
 }
@@ -0,0 +1,157 @@
+#include <benchmark/benchmark.h>
+
+#include <opengl/storage_block.hpp>
+
+namespace
+{
+// a material block as the introspection fills it, in std430
+struct MaterialData
+{
+	f32x4 base_color_factor;
+	f32x3 emissive_factor;
+	f32 metallic_factor;
+	f32 roughness_factor;
+	f32 occlusion_strength;
+	f32 normal_scale;
+	f32 alpha_cutoff;
+	u64 base_color_texture;
+	u64 metallic_roughness_texture;
+};
+
+GL::StorageBlock make_block()
+{
+	GL::StorageBlock block;
+	block.binding = 0;
+	block.data_size = block.aligned_size = sizeof(MaterialData);
+	auto const add = [&block](Name const & key, usize offset, GL::GLenum glsl_type)
+	{ block.variables.try_emplace(key, GL::VariableRef{.offset = u32(offset), .glsl_type = glsl_type}); };
+	add("base_color_factor"_name, offsetof(MaterialData, base_color_factor), GL::GL_FLOAT_VEC4);
+	add("emissive_factor"_name, offsetof(MaterialData, emissive_factor), GL::GL_FLOAT_VEC3);
+	add("metallic_factor"_name, offsetof(MaterialData, metallic_factor), GL::GL_FLOAT);
+	add("roughness_factor"_name, offsetof(MaterialData, roughness_factor), GL::GL_FLOAT);
+	add("occlusion_strength"_name, offsetof(MaterialData, occlusion_strength), GL::GL_FLOAT);
+	add("normal_scale"_name, offsetof(MaterialData, normal_scale), GL::GL_FLOAT);
+	add("alpha_cutoff"_name, offsetof(MaterialData, alpha_cutoff), GL::GL_FLOAT);
+	add("base_color_texture"_name, offsetof(MaterialData, base_color_texture), GL::GL_UNSIGNED_INT64_ARB);
+	add(
+		"metallic_roughness_texture"_name, offsetof(MaterialData, metallic_roughness_texture),
+		GL::GL_UNSIGNED_INT64_ARB
+	);
+	return block;
+}
+
+vector<MaterialData> make_materials(usize count)
+{
+	vector<MaterialData> materials(count);
+	for (usize i = 0; i < count; ++i)
+		materials[i] = {
+			.base_color_factor = f32x4(f32(i % 7) / 7),
+			.emissive_factor = f32x3(0),
+			.metallic_factor = f32(i % 3) / 3,
+			.roughness_factor = 0.5f,
+			.occlusion_strength = 1,
+			.normal_scale = 1,
+			.alpha_cutoff = 0.5f,
+			.base_color_texture = i,
+			.metallic_roughness_texture = i + 1,
+		};
+	return materials;
+}
+}
+
+// every variable looked up by name, as the materials were written before the refs
+static void BlockSetByName(benchmark::State & state)
+{
+	auto const block = make_block();
+	auto const materials = make_materials(usize(state.range(0)));
+	vector<byte> buffer(materials.size() * block.aligned_size);
+	for (auto _: state)
+	{
+		auto * destination = buffer.data();
+		for (auto const & material: materials)
+		{
+			block.set(destination, "base_color_factor"_name, material.base_color_factor);
+			block.set(destination, "emissive_factor"_name, material.emissive_factor);
+			block.set(destination, "metallic_factor"_name, material.metallic_factor);
+			block.set(destination, "roughness_factor"_name, material.roughness_factor);
+			block.set(destination, "occlusion_strength"_name, material.occlusion_strength);
+			block.set(destination, "normal_scale"_name, material.normal_scale);
+			block.set(destination, "alpha_cutoff"_name, material.alpha_cutoff);
+			block.set(destination, "base_color_texture"_name, material.base_color_texture);
+			block.set(destination, "metallic_roughness_texture"_name, material.metallic_roughness_texture);
+			destination += block.aligned_size;
+		}
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * materials.size()));
+}
+BENCHMARK(BlockSetByName)->ArgName("materials")->Arg(10'000)->Unit(benchmark::kMicrosecond);
+
+// resolved once with get_ref
+static void BlockSetByRef(benchmark::State & state)
+{
+	auto const block = make_block();
+	array const refs{
+		block.get_ref("base_color_factor"_name), block.get_ref("emissive_factor"_name),
+		block.get_ref("metallic_factor"_name), block.get_ref("roughness_factor"_name),
+		block.get_ref("occlusion_strength"_name), block.get_ref("normal_scale"_name),
+		block.get_ref("alpha_cutoff"_name), block.get_ref("base_color_texture"_name),
+		block.get_ref("metallic_roughness_texture"_name),
+	};
+	auto const materials = make_materials(usize(state.range(0)));
+	vector<byte> buffer(materials.size() * block.aligned_size);
+	for (auto _: state)
+	{
+		auto * destination = buffer.data();
+		for (auto const & material: materials)
+		{
+			block.set(destination, refs[0], material.base_color_factor);
+			block.set(destination, refs[1], material.emissive_factor);
+			block.set(destination, refs[2], material.metallic_factor);
+			block.set(destination, refs[3], material.roughness_factor);
+			block.set(destination, refs[4], material.occlusion_strength);
+			block.set(destination, refs[5], material.normal_scale);
+			block.set(destination, refs[6], material.alpha_cutoff);
+			block.set(destination, refs[7], material.base_color_texture);
+			block.set(destination, refs[8], material.metallic_roughness_texture);
+			destination += block.aligned_size;
+		}
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * materials.size()));
+}
+BENCHMARK(BlockSetByRef)->ArgName("materials")->Arg(10'000)->Unit(benchmark::kMicrosecond);
+
+// a struct that passes is_layout_of, copied as a whole
+static void BlockSetStruct(benchmark::State & state)
+{
+	auto const block = make_block();
+	bool const is_layout = block.is_layout_of(sizeof(MaterialData), {
+		GL_STRUCT_MEMBER(MaterialData, base_color_factor, "base_color_factor"_name),
+		GL_STRUCT_MEMBER(MaterialData, emissive_factor, "emissive_factor"_name),
+		GL_STRUCT_MEMBER(MaterialData, metallic_factor, "metallic_factor"_name),
+		GL_STRUCT_MEMBER(MaterialData, roughness_factor, "roughness_factor"_name),
+		GL_STRUCT_MEMBER(MaterialData, occlusion_strength, "occlusion_strength"_name),
+		GL_STRUCT_MEMBER(MaterialData, normal_scale, "normal_scale"_name),
+		GL_STRUCT_MEMBER(MaterialData, alpha_cutoff, "alpha_cutoff"_name),
+		GL_STRUCT_MEMBER(MaterialData, base_color_texture, "base_color_texture"_name),
+		GL_STRUCT_MEMBER(MaterialData, metallic_roughness_texture, "metallic_roughness_texture"_name),
+	});
+	if (not is_layout)
+		return state.SkipWithError("MaterialData is not the layout of the block");
+
+	auto const materials = make_materials(usize(state.range(0)));
+	vector<byte> buffer(materials.size() * block.aligned_size);
+	for (auto _: state)
+	{
+		auto * destination = buffer.data();
+		for (auto const & material: materials)
+		{
+			block.set_struct(destination, material);
+			destination += block.aligned_size;
+		}
+		benchmark::DoNotOptimize(buffer.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * materials.size()));
+}
+BENCHMARK(BlockSetStruct)->ArgName("materials")->Arg(10'000)->Unit(benchmark::kMicrosecond);
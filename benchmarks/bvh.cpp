@@ -0,0 +1,227 @@
+#include <benchmark/benchmark.h>
+
+#include <render/bvh.hpp>
+#include <render/scene.hpp>
+
+#include <random>
+
+using namespace Geometry;
+using Render::BVH;
+
+namespace
+{
+// items scattered in a 200 units cube, like the nodes of a big scene
+vector<AABB> make_boxes(u32 count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<f32> position(-100, 100), half_extent(0.1f, 2);
+	vector<AABB> boxes(count);
+	for (auto & box: boxes)
+	{
+		f32x3 const center(position(random), position(random), position(random));
+		f32x3 const extent(half_extent(random), half_extent(random), half_extent(random));
+		box = {.min = center - extent, .max = center + extent};
+	}
+	return boxes;
+}
+
+// looking down -z from the origin, 90 degrees fov, zero to one depth from 1 to 300
+Frustum make_frustum()
+{
+	f32 const near = 1, far = 300;
+	f32x4x4 projection(0);
+	projection[0][0] = 1, projection[1][1] = 1;
+	projection[2][2] = far / (near - far), projection[2][3] = -1, projection[3][2] = -far * near / (far - near);
+	return Frustum::from_view_projection(projection);
+}
+
+// a unit box mesh, every node of the scene draws it
+struct SceneData
+{
+	Primitive primitive;
+	DenseManaged<Render::Mesh> meshes;
+	Scene::Tree tree;
+
+	// a quarter of the nodes are roots scattered like make_boxes, each with 3 children around it
+	explicit SceneData(u32 node_count)
+	{
+		primitive.bounds.box = {.min = f32x3(-1), .max = f32x3(1)};
+		auto & mesh = meshes.generate("box"_name).data;
+		mesh.drawables.push_back({.primitive = primitive, .material = {}, .vertex_array = {}});
+		auto const mesh_handle = meshes.get_handle("box"_name);
+
+		std::mt19937 random(1);
+		std::uniform_real_distribution<f32> position(-100, 100), offset(-3, 3);
+		auto const root_count = node_count / 4;
+		for (u32 i = 0; i < root_count; ++i)
+			tree.add({
+				.name = Name(fmt::format("root_{}", i)),
+				.depth = 0,
+				.parent_index = 0,
+				.transform = {.position = f32x3(position(random), position(random), position(random))},
+				.mesh = mesh_handle,
+			});
+		for (u32 i = 0; i < node_count - root_count; ++i)
+			tree.add({
+				.name = Name(fmt::format("child_{}", i)),
+				.depth = 1,
+				.parent_index = i % root_count,
+				.transform = {.position = f32x3(offset(random), offset(random), offset(random))},
+				.mesh = mesh_handle,
+			});
+		tree.update_transforms(false);
+	}
+};
+}
+
+static void BVHBuild(benchmark::State & state)
+{
+	auto const boxes = make_boxes(u32(state.range(0)));
+	BVH bvh;
+	for (auto _: state)
+	{
+		bvh.build(boxes);
+		benchmark::DoNotOptimize(bvh.nodes.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * boxes.size()));
+	state.counters["cost"] = bvh.calculate_cost();
+}
+BENCHMARK(BVHBuild)
+	->ArgName("items")
+	->Arg(10'000)
+	->Arg(100'000)
+	->Arg(1'000'000)
+	->Unit(benchmark::kMillisecond);
+
+// every item moved, then refit and optionally rotate, what SceneBVH::update does when everything animates
+static void BVHRefit(benchmark::State & state)
+{
+	auto boxes = make_boxes(u32(state.range(0)));
+	auto const should_rotate = state.range(1) != 0;
+	BVH bvh;
+	bvh.build(boxes);
+
+	f32 direction = 1;
+	for (auto _: state)
+	{
+		state.PauseTiming();
+		for (u32 i = 0; i < boxes.size(); i += 2)
+		{
+			boxes[i].min.x += direction, boxes[i].max.x += direction;
+			bvh.set_item_box(i, boxes[i]);
+		}
+		direction = -direction;
+		state.ResumeTiming();
+
+		bvh.refit();
+		if (should_rotate)
+			bvh.rotate();
+		benchmark::DoNotOptimize(bvh.nodes.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * boxes.size()));
+}
+BENCHMARK(BVHRefit)
+	->ArgNames({"items", "rotate"})
+	->ArgsProduct({{10'000, 100'000, 1'000'000}, {0, 1}})
+	->Unit(benchmark::kMillisecond);
+
+static void BVHFrustumQuery(benchmark::State & state)
+{
+	auto const boxes = make_boxes(u32(state.range(0)));
+	auto const frustum = make_frustum();
+	BVH bvh;
+	bvh.build(boxes);
+
+	usize visible_count = 0;
+	for (auto _: state)
+	{
+		visible_count = 0;
+		bvh.query(frustum, [&visible_count](u32) { visible_count++; });
+		benchmark::DoNotOptimize(visible_count);
+	}
+	state.SetItemsProcessed(i64(state.iterations() * boxes.size()));
+	state.counters["visible"] = f64(visible_count);
+}
+BENCHMARK(BVHFrustumQuery)
+	->ArgName("items")
+	->Arg(10'000)
+	->Arg(100'000)
+	->Arg(1'000'000)
+	->Unit(benchmark::kMicrosecond);
+
+// the same query without the tree, every box against the frustum
+static void BruteForceFrustumQuery(benchmark::State & state)
+{
+	auto const boxes = make_boxes(u32(state.range(0)));
+	auto const frustum = make_frustum();
+	for (auto _: state)
+	{
+		usize visible_count = 0;
+		for (auto const & box: boxes)
+			visible_count += frustum.intersects(box);
+		benchmark::DoNotOptimize(visible_count);
+	}
+	state.SetItemsProcessed(i64(state.iterations() * boxes.size()));
+}
+BENCHMARK(BruteForceFrustumQuery)
+	->ArgName("items")
+	->Arg(10'000)
+	->Arg(100'000)
+	->Arg(1'000'000)
+	->Unit(benchmark::kMicrosecond);
+
+// after a scene is loaded or a node is added, the tree version changed
+static void SceneBVHRebuild(benchmark::State & state)
+{
+	SceneData const scene(u32(state.range(0)));
+	Render::SceneBVH scene_bvh;
+	for (auto _: state)
+	{
+		scene_bvh.tree_version.reset();
+		scene_bvh.update(scene.tree, scene.meshes, {});
+		benchmark::DoNotOptimize(scene_bvh.bvh.nodes.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * scene.tree.size()));
+}
+BENCHMARK(SceneBVHRebuild)
+	->ArgName("nodes")
+	->Arg(10'000)
+	->Arg(100'000)
+	->Arg(1'000'000)
+	->Unit(benchmark::kMillisecond);
+
+// every 8th root moves with its children, the boxes of changed_indices are refit
+static void SceneBVHRefit(benchmark::State & state)
+{
+	SceneData scene(u32(state.range(0)));
+	Render::SceneBVH scene_bvh;
+	scene_bvh.update(scene.tree, scene.meshes, {});
+
+	auto & roots = scene.tree.levels[0];
+	f32 direction = 1;
+	usize changed_count = 0;
+	for (auto _: state)
+	{
+		state.PauseTiming();
+		for (u32 i = 0; i < roots.size(); i += 8)
+		{
+			roots.positions[i].x += direction;
+			scene.tree.mark_dirty({0, i});
+		}
+		direction = -direction;
+		auto const & changed_indices = scene.tree.update_transforms(false);
+		changed_count = changed_indices.size();
+		state.ResumeTiming();
+
+		scene_bvh.update(scene.tree, scene.meshes, changed_indices);
+		benchmark::DoNotOptimize(scene_bvh.bvh.nodes.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * changed_count));
+	state.counters["changed"] = f64(changed_count);
+}
+BENCHMARK(SceneBVHRefit)
+	->ArgName("nodes")
+	->Arg(10'000)
+	->Arg(100'000)
+	->Arg(1'000'000)
+	->Unit(benchmark::kMillisecond);
@@ -0,0 +1,31 @@
+#include <benchmark/benchmark.h>
+
+#include <core/dirty_set.hpp>
+
+#include <random>
+
+// a frame of edits out of 10k materials, marking them, visiting the ranges and clearing
+static void DirtySetFrame(benchmark::State & state)
+{
+	auto const edit_count = u32(state.range(0));
+	u32 constexpr MATERIAL_COUNT = 10'000;
+
+	std::mt19937 random(1);
+	vector<u32> edits(edit_count * 64);
+	for (auto & edit: edits)
+		edit = random() % MATERIAL_COUNT;
+
+	DirtySet set;
+	usize frame = 0, range_count = 0;
+	for (auto _: state)
+	{
+		for (auto const edit: span(edits).subspan((frame++ % 64) * edit_count, edit_count))
+			set.mark(edit);
+		set.for_each_range([&range_count](u32 first, u32 count) { range_count++, benchmark::DoNotOptimize(first + count); });
+		set.clear();
+	}
+
+	state.SetItemsProcessed(i64(state.iterations() * edit_count));
+	state.counters["ranges/frame"] = f64(range_count) / f64(state.iterations());
+}
+BENCHMARK(DirtySetFrame)->ArgName("edits")->Arg(10)->Arg(1000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,166 @@
+#include <benchmark/benchmark.h>
+
+#include <core/flat_map.hpp>
+#include <core/named.hpp>
+#include <opengl/uniform_block.hpp>
+
+#include <random>
+
+namespace
+{
+// names like the block variables and scene nodes, looked up in a random order
+struct Keys
+{
+	vector<Name> names, lookups;
+
+	explicit Keys(usize count)
+	{
+		for (usize i = 0; i < count; ++i)
+			names.emplace_back(fmt::format("node_{}", i));
+
+		std::mt19937 random{1};
+		for (usize i = 0; i < 4096; ++i)
+			lookups.push_back(names[random() % count]);
+	}
+};
+
+template<typename Map>
+void lookup(benchmark::State & state)
+{
+	Keys const keys(usize(state.range(0)));
+	Map map;
+	for (u32 i = 0; i < keys.names.size(); ++i)
+		map.try_emplace(keys.names[i], i);
+
+	u32 sum = 0;
+	for (auto _: state)
+		for (auto const & name: keys.lookups)
+			sum += map.find(name)->second;
+	benchmark::DoNotOptimize(sum);
+	state.SetItemsProcessed(i64(state.iterations() * keys.lookups.size()));
+}
+
+template<typename Map>
+void insert(benchmark::State & state)
+{
+	Keys const keys(usize(state.range(0)));
+	for (auto _: state)
+	{
+		Map map;
+		for (u32 i = 0; i < keys.names.size(); ++i)
+			map.try_emplace(keys.names[i], i);
+		benchmark::DoNotOptimize(map.size());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * keys.names.size()));
+}
+
+// the Camera block, Game::update sets every variable each frame
+struct CameraData
+{
+	f32x4x4 TransformV, TransformP, TransformVP;
+	f32x4x4 TransformV_inv, TransformP_inv, TransformVP_inv;
+	f32x3 CameraWorldPosition;
+};
+
+array<std::pair<char const *, usize>, 7> constexpr CAMERA_VARIABLES{{
+	{"TransformV", offsetof(CameraData, TransformV)},
+	{"TransformP", offsetof(CameraData, TransformP)},
+	{"TransformVP", offsetof(CameraData, TransformVP)},
+	{"TransformV_inv", offsetof(CameraData, TransformV_inv)},
+	{"TransformP_inv", offsetof(CameraData, TransformP_inv)},
+	{"TransformVP_inv", offsetof(CameraData, TransformVP_inv)},
+	{"CameraWorldPosition", offsetof(CameraData, CameraWorldPosition)},
+}};
+
+GL::UniformBlock make_camera_block()
+{
+	GL::UniformBlock block;
+	block.binding = 0;
+	block.data_size = block.aligned_size = sizeof(CameraData);
+	for (auto const & [key, offset]: CAMERA_VARIABLES)
+	{
+		auto const is_position = offset == offsetof(CameraData, CameraWorldPosition);
+		block.variables.try_emplace(key, GL::VariableRef{
+			.offset = u32(offset),
+			.glsl_type = is_position ? GL::GL_FLOAT_VEC3 : GL::GL_FLOAT_MAT4,
+		});
+	}
+	return block;
+}
+
+// the UniformBlock it replaced, every set builds a std::string from the literal and hashes it
+struct BaselineUniformBlock
+{
+	std::unordered_map<std::string, GL::VariableRef> variables;
+
+	BaselineUniformBlock()
+	{
+		for (auto const & [key, offset]: CAMERA_VARIABLES)
+			variables.try_emplace(key, GL::VariableRef{.offset = u32(offset), .glsl_type = GL::GL_NONE});
+	}
+
+	template<typename T>
+	void set(byte * destination, std::string const & variable_key, T const & data) const
+	{ std::memcpy(destination + variables.at(variable_key).offset, &data, sizeof(T)); }
+};
+
+template<typename Block>
+void set_camera(benchmark::State & state, Block const & block)
+{
+	f32x4x4 const view(1), projection(2);
+	auto const view_projection = projection * view;
+	array<byte, sizeof(CameraData)> map;
+	for (auto _: state)
+	{
+		if constexpr (std::is_same_v<Block, GL::UniformBlock>)
+		{
+			block.set(map.data(), "TransformV"_name, view);
+			block.set(map.data(), "TransformP"_name, projection);
+			block.set(map.data(), "TransformVP"_name, view_projection);
+			block.set(map.data(), "TransformV_inv"_name, view);
+			block.set(map.data(), "TransformP_inv"_name, projection);
+			block.set(map.data(), "TransformVP_inv"_name, view_projection);
+			block.set(map.data(), "CameraWorldPosition"_name, f32x3(1, 2, 3));
+		}
+		else
+		{
+			block.set(map.data(), "TransformV", view);
+			block.set(map.data(), "TransformP", projection);
+			block.set(map.data(), "TransformVP", view_projection);
+			block.set(map.data(), "TransformV_inv", view);
+			block.set(map.data(), "TransformP_inv", projection);
+			block.set(map.data(), "TransformVP_inv", view_projection);
+			block.set(map.data(), "CameraWorldPosition", f32x3(1, 2, 3));
+		}
+		benchmark::DoNotOptimize(map.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * CAMERA_VARIABLES.size()));
+}
+}
+
+static void FlatMapLookup(benchmark::State & state)
+{ lookup<FlatMap<Name, u32, Name::Hasher>>(state); }
+BENCHMARK(FlatMapLookup)->ArgName("keys")->Arg(16)->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// the same keys in an unordered_map, Scene::Tree's named_indices was one (a Managed<Index>) before FlatMap
+static void UnorderedMapLookup(benchmark::State & state)
+{ lookup<std::unordered_map<Name, u32, Name::Hasher>>(state); }
+BENCHMARK(UnorderedMapLookup)->ArgName("keys")->Arg(16)->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+static void FlatMapInsert(benchmark::State & state)
+{ insert<FlatMap<Name, u32, Name::Hasher>>(state); }
+BENCHMARK(FlatMapInsert)->ArgName("keys")->Arg(16)->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+static void UnorderedMapInsert(benchmark::State & state)
+{ insert<std::unordered_map<Name, u32, Name::Hasher>>(state); }
+BENCHMARK(UnorderedMapInsert)->ArgName("keys")->Arg(16)->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// the per frame block.set(map, "TransformVP", ...) pattern through the Name keyed FlatMap
+static void UniformBlockSetFlatMap(benchmark::State & state)
+{ set_camera(state, make_camera_block()); }
+BENCHMARK(UniformBlockSetFlatMap)->Unit(benchmark::kNanosecond);
+
+// and through the std::string keyed unordered_map the blocks had before
+static void UniformBlockSetStringMap(benchmark::State & state)
+{ set_camera(state, BaselineUniformBlock()); }
+BENCHMARK(UniformBlockSetStringMap)->Unit(benchmark::kNanosecond);
@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include <core/jobs.hpp>
+
+#include <thread>
+
+namespace
+{
+// 0 workers leaves the job system uninitialized, everything runs on the calling thread
+struct Workers
+{
+	explicit Workers(benchmark::State & state)
+	{
+		if (auto const count = u32(state.range(0)); count != 0)
+			Jobs::init({.worker_count = count});
+	}
+
+	~Workers()
+	{ Jobs::shutdown(); }
+};
+
+// 0, then doubling up to what Jobs::init picks by default, hardware_concurrency - 1 since the main thread also works
+vector<i64> get_worker_counts()
+{
+	auto const default_count = i64(glm::max(std::thread::hardware_concurrency(), 2u) - 1);
+	vector<i64> counts{0};
+	for (i64 count = 1; count < default_count; count *= 2)
+		counts.push_back(count);
+	counts.push_back(default_count);
+	return counts;
+}
+
+// stands in for decoding an image, only cpu bound work
+u64 decode(usize item)
+{
+	u64 hash = 0xcbf29ce484222325 + item;
+	for (u32 i = 0; i < 20'000; ++i)
+		hash = (hash ^ (hash >> 29)) * 0x100000001b3;
+	return hash;
+}
+}
+
+static void JobsParallelFor(benchmark::State & state)
+{
+	Workers const workers(state);
+	auto const item_count = usize(state.range(1));
+	vector<u64> results(item_count);
+	for (auto _: state)
+	{
+		Jobs::parallel_for(item_count, 1, [&results](usize begin, usize end)
+		{
+			for (auto i = begin; i < end; ++i)
+				results[i] = decode(i);
+		});
+		benchmark::DoNotOptimize(results.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * item_count));
+}
+BENCHMARK(JobsParallelFor)
+	->ArgNames({"workers", "items"})
+	->ArgsProduct({get_worker_counts(), {8, 256}})
+	->UseRealTime()
+	->Unit(benchmark::kMicrosecond);
+
+// the overhead of a task, a fan out of empty tasks joined by a last one
+static void JobsSubmitWait(benchmark::State & state)
+{
+	Workers const workers(state);
+	auto const task_count = usize(state.range(1));
+	vector<Jobs::Handle> tasks(task_count);
+	for (auto _: state)
+	{
+		for (auto & task: tasks)
+			task = Jobs::submit([] {});
+		Jobs::wait(Jobs::submit([] {}, tasks));
+	}
+	state.SetItemsProcessed(i64(state.iterations() * (task_count + 1)));
+}
+BENCHMARK(JobsSubmitWait)
+	->ArgNames({"workers", "tasks"})
+	->ArgsProduct({get_worker_counts(), {1000}})
+	->UseRealTime()
+	->Unit(benchmark::kMicrosecond);
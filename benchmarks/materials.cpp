@@ -0,0 +1,160 @@
+#include <benchmark/benchmark.h>
+
+#include <render/material.hpp>
+
+namespace
+{
+using Material = Render::Material_gltf_pbrMetallicRoughness;
+
+// the block as the introspection of the pbrMetallicRoughness program fills it
+void init_block()
+{
+	auto & block = Material::block;
+	if (not block.variables.empty())
+		return;
+
+	block.data_size = sizeof(Material);
+	block.aligned_size = 256; // a common GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+	auto const add = [&block](Name const & key, usize offset, GL::GLenum glsl_type)
+	{ block.variables.try_emplace(key, GL::VariableRef{.offset = u32(offset), .glsl_type = glsl_type}); };
+	add(
+		"Material.base_color_texture_handle"_name, offsetof(Material, base_color_texture_handle),
+		GL::GL_UNSIGNED_INT64_ARB
+	);
+	add("Material.base_color_factor"_name, offsetof(Material, base_color_factor), GL::GL_FLOAT_VEC4);
+	add(
+		"Material.metallic_roughness_texture_handle"_name, offsetof(Material, metallic_roughness_texture_handle),
+		GL::GL_UNSIGNED_INT64_ARB
+	);
+	add("Material.metallic_roughness_factor"_name, offsetof(Material, metallic_roughness_factor), GL::GL_FLOAT_VEC2);
+	add(
+		"Material.emissive_texture_handle"_name, offsetof(Material, emissive_texture_handle), GL::GL_UNSIGNED_INT64_ARB
+	);
+	add("Material.emissive_factor"_name, offsetof(Material, emissive_factor), GL::GL_FLOAT_VEC3);
+	add(
+		"Material.occlusion_texture_handle"_name, offsetof(Material, occlusion_texture_handle),
+		GL::GL_UNSIGNED_INT64_ARB
+	);
+	add("Material.normal_texture_handle"_name, offsetof(Material, normal_texture_handle), GL::GL_UNSIGNED_INT64_ARB);
+}
+
+Material make_material(usize i)
+{
+	Material material;
+	material.base_color_texture_handle = i;
+	material.base_color_factor = f32x4(f32(i % 7) / 7);
+	material.metallic_roughness_factor = f32x2(f32(i % 3) / 3, 0.5f);
+	material.emissive_factor = f32x3(0);
+	material.normal_texture_handle = i + 1;
+	return material;
+}
+
+// the virtual material it replaced, writing every variable through a resolved ref
+struct IMaterial
+{
+	virtual void write_to_buffer(byte * buffer) const = 0;
+	virtual ~IMaterial() = default;
+};
+
+struct BaselineMaterial final : IMaterial
+{
+	Material values;
+
+	struct Variables
+	{
+		GL::VariableRef base_color_texture_handle;
+		GL::VariableRef base_color_factor;
+		GL::VariableRef metallic_roughness_texture_handle;
+		GL::VariableRef metallic_roughness_factor;
+		GL::VariableRef emissive_texture_handle;
+		GL::VariableRef emissive_factor;
+		GL::VariableRef occlusion_texture_handle;
+		GL::VariableRef normal_texture_handle;
+	};
+	static inline Variables variables;
+
+	static void init_variables()
+	{
+		auto const & block = Material::block;
+		variables = {
+			.base_color_texture_handle = block.get_ref("Material.base_color_texture_handle"_name),
+			.base_color_factor = block.get_ref("Material.base_color_factor"_name),
+			.metallic_roughness_texture_handle = block.get_ref("Material.metallic_roughness_texture_handle"_name),
+			.metallic_roughness_factor = block.get_ref("Material.metallic_roughness_factor"_name),
+			.emissive_texture_handle = block.get_ref("Material.emissive_texture_handle"_name),
+			.emissive_factor = block.get_ref("Material.emissive_factor"_name),
+			.occlusion_texture_handle = block.get_ref("Material.occlusion_texture_handle"_name),
+			.normal_texture_handle = block.get_ref("Material.normal_texture_handle"_name),
+		};
+	}
+
+	explicit BaselineMaterial(Material const & values) :
+		values(values)
+	{}
+
+	void write_to_buffer(byte * buffer) const final
+	{
+		auto const & block = Material::block;
+		block.set(buffer, variables.base_color_texture_handle, values.base_color_texture_handle);
+		block.set(buffer, variables.base_color_factor, values.base_color_factor);
+		block.set(buffer, variables.metallic_roughness_texture_handle, values.metallic_roughness_texture_handle);
+		block.set(buffer, variables.metallic_roughness_factor, values.metallic_roughness_factor);
+		block.set(buffer, variables.emissive_texture_handle, values.emissive_texture_handle);
+		block.set(buffer, variables.emissive_factor, values.emissive_factor);
+		block.set(buffer, variables.occlusion_texture_handle, values.occlusion_texture_handle);
+		block.set(buffer, variables.normal_texture_handle, values.normal_texture_handle);
+	}
+};
+}
+
+// both material buffers rebuilt, as Game::create_uniform_buffers does, the materials are in dense slot order
+static void MaterialBuffersGenerated(benchmark::State & state)
+{
+	init_block();
+	if (not Material::is_layout_of(Material::block))
+		return state.SkipWithError("Material is not the layout of the block");
+
+	auto const material_count = usize(state.range(0));
+	vector<Material> materials;
+	for (usize i = 0; i < material_count; ++i)
+		materials.push_back(make_material(i));
+
+	auto const aligned_size = Material::block.aligned_size;
+	vector<byte> buffer(material_count * aligned_size), array_buffer(material_count * sizeof(Material));
+	for (auto _: state)
+	{
+		for (usize i = 0; i < material_count; ++i)
+			std::memcpy(buffer.data() + i * aligned_size, materials[i].data(), sizeof(Material));
+		std::memcpy(array_buffer.data(), materials.data(), material_count * sizeof(Material));
+		benchmark::DoNotOptimize(buffer.data());
+		benchmark::DoNotOptimize(array_buffer.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * material_count));
+}
+BENCHMARK(MaterialBuffersGenerated)->ArgName("materials")->Arg(1000)->Arg(10'000)->Unit(benchmark::kMicrosecond);
+
+static void MaterialBuffersVirtual(benchmark::State & state)
+{
+	init_block();
+	BaselineMaterial::init_variables();
+
+	auto const material_count = usize(state.range(0));
+	vector<unique_one<IMaterial>> materials;
+	for (usize i = 0; i < material_count; ++i)
+		materials.push_back(make_unique_one<BaselineMaterial>(make_material(i)));
+
+	auto const aligned_size = Material::block.aligned_size;
+	vector<byte> buffer(material_count * aligned_size), array_buffer(material_count * sizeof(Material));
+	for (auto _: state)
+	{
+		for (usize i = 0; i < material_count; ++i)
+		{
+			materials[i]->write_to_buffer(buffer.data() + i * aligned_size);
+			materials[i]->write_to_buffer(array_buffer.data() + i * sizeof(Material));
+		}
+		benchmark::DoNotOptimize(buffer.data());
+		benchmark::DoNotOptimize(array_buffer.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * material_count));
+}
+BENCHMARK(MaterialBuffersVirtual)->ArgName("materials")->Arg(1000)->Arg(10'000)->Unit(benchmark::kMicrosecond);
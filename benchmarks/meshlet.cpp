@@ -0,0 +1,38 @@
+#include <benchmark/benchmark.h>
+
+#include <core/meshlet.hpp>
+#include <core/mesh_optimize.hpp>
+
+#include "meshes.hpp"
+
+using namespace Geometry;
+
+// arg is the sphere's quads per cube face edge, 289 is about 1M triangles
+static void BuildMeshlets(benchmark::State & state)
+{
+	auto mesh = TestData::sphere(u32(state.range(0)));
+	if (state.range(1))
+		optimize_vertex_cache(mesh.indices, mesh.positions.size());
+	auto const triangle_count = mesh.indices.size() / 3;
+
+	usize meshlet_count = 0;
+	for (auto _: state)
+	{
+		state.PauseTiming();
+		auto primitive = TestData::make_primitive(mesh);
+		state.ResumeTiming();
+
+		build_meshlets(primitive);
+		meshlet_count = primitive.meshlets.size();
+		benchmark::DoNotOptimize(primitive.indices.data());
+	}
+
+	state.SetItemsProcessed(i64(state.iterations() * triangle_count));
+	state.counters["triangles"] = f64(triangle_count);
+	state.counters["meshlets"] = f64(meshlet_count);
+	state.counters["triangles/meshlet"] = f64(triangle_count) / f64(meshlet_count);
+}
+BENCHMARK(BuildMeshlets)
+	->ArgNames({"size", "cache_optimized"})
+	->ArgsProduct({{16, 289}, {0, 1}})
+	->Unit(benchmark::kMillisecond);
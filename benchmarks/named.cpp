@@ -0,0 +1,174 @@
+#include <benchmark/benchmark.h>
+
+#include <core/named.hpp>
+
+namespace
+{
+// names that are already interned, as every lookup after the first load
+vector<std::string> make_strings(usize count)
+{
+	vector<std::string> strings;
+	for (usize i = 0; i < count; ++i)
+		strings.push_back(fmt::format("material_{}", i));
+	for (auto const & string: strings)
+		Name{string};
+	return strings;
+}
+
+// the Name it replaced, owning its string and hashed with std::hash
+struct BaselineName
+{
+	usize hash;
+	std::string string;
+
+	BaselineName(std::string_view const & sv) :
+		hash(std::hash<std::string_view>{}(sv)), string(sv)
+	{}
+
+	BaselineName(std::string const & str) :
+		hash(std::hash<std::string>{}(str)), string(str)
+	{}
+
+	BaselineName(const char * cp) :
+		BaselineName(std::string_view(cp))
+	{}
+
+	bool operator==(BaselineName const & other) const
+	{ return hash == other.hash; }
+
+	struct Hasher
+	{
+		usize operator()(BaselineName const & name) const
+		{ return name.hash; }
+	};
+};
+
+// the part of Managed that get uses, over BaselineName
+template<typename T>
+struct BaselineManaged
+{
+	std::unordered_map<BaselineName, T, BaselineName::Hasher> resources;
+
+	T & get(BaselineName const & name)
+	{ return resources.at(name); }
+};
+
+array constexpr LITERALS{"pbrMetallicRoughness", "albedo", "Transforms", "shadow_map"};
+
+// the strings of make_strings and the literals, every resource is its index
+template<typename Managed>
+Managed make_managed(vector<std::string> const & strings)
+{
+	Managed managed;
+	for (u32 i = 0; auto const & string: strings)
+		managed.resources.try_emplace(string, i++);
+	for (u32 i = 0; auto const * literal: LITERALS)
+		managed.resources.try_emplace(literal, u32(strings.size()) + i++);
+	return managed;
+}
+}
+
+// a runtime string, hashed and checked against the intern table
+static void NameFromString(benchmark::State & state)
+{
+	auto const strings = make_strings(1000);
+	for (auto _: state)
+		for (auto const & string: strings)
+			benchmark::DoNotOptimize(Name(string));
+	state.SetItemsProcessed(i64(state.iterations() * strings.size()));
+}
+BENCHMARK(NameFromString)->ThreadRange(1, 8)->Unit(benchmark::kMicrosecond);
+
+// what it replaced, a hash and an allocation per name
+static void StdStringKey(benchmark::State & state)
+{
+	auto const strings = make_strings(1000);
+	for (auto _: state)
+		for (auto const & string: strings)
+		{
+			std::string key(string);
+			benchmark::DoNotOptimize(std::hash<std::string>{}(key));
+		}
+	state.SetItemsProcessed(i64(state.iterations() * strings.size()));
+}
+BENCHMARK(StdStringKey)->ThreadRange(1, 8)->Unit(benchmark::kMicrosecond);
+
+// the per frame lookups, hashed at compile time
+static void NameFromLiteral(benchmark::State & state)
+{
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize("pbrMetallicRoughness"_name);
+		benchmark::DoNotOptimize("albedo"_name);
+		benchmark::DoNotOptimize("Transforms"_name);
+		benchmark::DoNotOptimize("shadow_map"_name);
+	}
+	state.SetItemsProcessed(i64(state.iterations() * 4));
+}
+BENCHMARK(NameFromLiteral)->ThreadRange(1, 8)->Unit(benchmark::kNanosecond);
+
+// the editor shows every name every frame
+static void NameString(benchmark::State & state)
+{
+	auto const strings = make_strings(1000);
+	vector<Name> names(strings.begin(), strings.end());
+	usize length = 0;
+	for (auto _: state)
+		for (auto const & name: names)
+			length += name.string().size();
+	benchmark::DoNotOptimize(length);
+	state.SetItemsProcessed(i64(state.iterations() * names.size()));
+}
+BENCHMARK(NameString)->ThreadRange(1, 8)->Unit(benchmark::kMicrosecond);
+
+// the per frame gets of the renderer, a program or a texture by a literal
+static void ManagedGetLiteral(benchmark::State & state)
+{
+	auto managed = make_managed<Managed<u32>>(make_strings(1000));
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(managed.get("pbrMetallicRoughness"_name));
+		benchmark::DoNotOptimize(managed.get("albedo"_name));
+		benchmark::DoNotOptimize(managed.get("Transforms"_name));
+		benchmark::DoNotOptimize(managed.get("shadow_map"_name));
+	}
+	state.SetItemsProcessed(i64(state.iterations() * 4));
+}
+BENCHMARK(ManagedGetLiteral)->Unit(benchmark::kNanosecond);
+
+static void BaselineManagedGetLiteral(benchmark::State & state)
+{
+	auto managed = make_managed<BaselineManaged<u32>>(make_strings(1000));
+	for (auto _: state)
+	{
+		benchmark::DoNotOptimize(managed.get("pbrMetallicRoughness"));
+		benchmark::DoNotOptimize(managed.get("albedo"));
+		benchmark::DoNotOptimize(managed.get("Transforms"));
+		benchmark::DoNotOptimize(managed.get("shadow_map"));
+	}
+	state.SetItemsProcessed(i64(state.iterations() * 4));
+}
+BENCHMARK(BaselineManagedGetLiteral)->Unit(benchmark::kNanosecond);
+
+// the gets of the loaders, by the names read from a file
+static void ManagedGetString(benchmark::State & state)
+{
+	auto const strings = make_strings(1000);
+	auto managed = make_managed<Managed<u32>>(strings);
+	for (auto _: state)
+		for (auto const & string: strings)
+			benchmark::DoNotOptimize(managed.get(string));
+	state.SetItemsProcessed(i64(state.iterations() * strings.size()));
+}
+BENCHMARK(ManagedGetString)->Unit(benchmark::kMicrosecond);
+
+static void BaselineManagedGetString(benchmark::State & state)
+{
+	auto const strings = make_strings(1000);
+	auto managed = make_managed<BaselineManaged<u32>>(strings);
+	for (auto _: state)
+		for (auto const & string: strings)
+			benchmark::DoNotOptimize(managed.get(string));
+	state.SetItemsProcessed(i64(state.iterations() * strings.size()));
+}
+BENCHMARK(BaselineManagedGetString)->Unit(benchmark::kMicrosecond);
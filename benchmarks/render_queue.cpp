@@ -0,0 +1,54 @@
+#include <benchmark/benchmark.h>
+
+#include <render/render_queue.hpp>
+
+#include <random>
+
+using namespace Render;
+
+namespace
+{
+// a few programs, more materials and vertex arrays, random depths
+vector<RenderQueue::Entry> make_entries(u32 draw_count)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<f32> depth(0, 500);
+	vector<RenderQueue::Entry> entries;
+	entries.reserve(draw_count);
+	for (u32 i = 0; i < draw_count; ++i)
+		entries.push_back({
+			.key = SortKey::make(SortKey::Pass::Opaque, random() % 3, random() % 50, random() % 200, depth(random)),
+			.index = i,
+		});
+	return entries;
+}
+}
+
+static void RenderQueueSort(benchmark::State & state)
+{
+	auto const entries = make_entries(u32(state.range(0)));
+	RenderQueue queue;
+	for (auto _: state)
+	{
+		queue.entries = entries;
+		queue.sort();
+		benchmark::DoNotOptimize(queue.entries.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * entries.size()));
+}
+BENCHMARK(RenderQueueSort)->ArgName("draws")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// the comparison sort it replaced
+static void StdStableSort(benchmark::State & state)
+{
+	auto const entries = make_entries(u32(state.range(0)));
+	vector<RenderQueue::Entry> sorted;
+	for (auto _: state)
+	{
+		sorted = entries;
+		std::ranges::stable_sort(sorted, std::less{}, &RenderQueue::Entry::key);
+		benchmark::DoNotOptimize(sorted.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * entries.size()));
+}
+BENCHMARK(StdStableSort)->ArgName("draws")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
@@ -0,0 +1,294 @@
+#include <benchmark/benchmark.h>
+
+#include <core/jobs.hpp>
+#include <render/scene.hpp>
+
+#include <forward_list>
+#include <random>
+
+namespace
+{
+// the level shapes of the scenes, against Scene::Tree::PARALLEL_LEVEL_THRESHOLD
+enum struct Shape : u8
+{
+	Pyramid, // 16 roots, every level is 4 times the previous one
+	Wide, // 16 roots and a single level with the rest, far above the threshold
+	Deep, // levels of 2048 nodes, all under the threshold
+};
+
+vector<usize> level_sizes_of(Shape shape, usize node_count)
+{
+	vector<usize> sizes;
+	for (usize added = 0; added < node_count;)
+	{
+		usize size = 0;
+		switch (shape)
+		{
+		case Shape::Pyramid: size = sizes.empty() ? 16 : sizes.back() * 4; break;
+		case Shape::Wide: size = sizes.empty() ? 16 : node_count; break;
+		case Shape::Deep: size = 2048; break;
+		}
+		sizes.push_back(glm::min(size, node_count - added));
+		added += sizes.back();
+	}
+	return sizes;
+}
+
+// random parents in the previous level
+template<typename AddNode>
+void add_nodes(usize node_count, AddNode && add_node, Shape shape = Shape::Pyramid)
+{
+	std::mt19937 random{1};
+	std::uniform_real_distribution<f32> unit(-1, 1);
+	auto const level_sizes = level_sizes_of(shape, node_count);
+	for (u32 depth = 0; depth < level_sizes.size(); ++depth)
+		for (usize i = 0; i < level_sizes[depth]; ++i)
+			add_node(depth, depth == 0 ? 0 : u32(random() % level_sizes[depth - 1]), Scene::Transform{
+				.position = f32x3(unit(random), unit(random), unit(random)) * 10.f,
+				.rotation = glm::normalize(f32quat(unit(random), unit(random), unit(random), unit(random))),
+				.scale = f32x3(unit(random) * 0.1f + 1),
+			});
+}
+
+Scene::Tree make_tree(usize node_count, Shape shape = Shape::Pyramid)
+{
+	Scene::Tree tree;
+	usize i = 0;
+	add_nodes(node_count, [&](u32 depth, u32 parent_index, Scene::Transform const & transform)
+	{
+		tree.add({
+			.name = Name(fmt::format("node_{}", i++)),
+			.depth = depth,
+			.parent_index = parent_index,
+			.transform = transform,
+			.mesh = {},
+		});
+	}, shape);
+	return tree;
+}
+
+void mark_all_dirty(Scene::Tree & tree)
+{
+	for (auto & level: tree.levels)
+		std::ranges::fill(level.is_dirty, true), level.has_dirty = true;
+	tree.has_dirty = true;
+}
+
+// the array of structures layout Scene::Tree had, names and transforms interleaved with the matrices
+struct BaselineTree
+{
+	struct Node
+	{
+		Name name;
+		u32 depth;
+		u32 parent_index;
+		Scene::Transform transform;
+		f32x4x4 matrix;
+		Render::Mesh * mesh = nullptr;
+	};
+	vector<vector<Node>> nodes;
+
+	explicit BaselineTree(usize node_count)
+	{
+		usize i = 0;
+		add_nodes(node_count, [&](u32 depth, u32 parent_index, Scene::Transform const & transform)
+		{
+			if (nodes.size() < depth + 1)
+				nodes.resize(depth + 1);
+			nodes[depth].push_back({
+				.name = Name(fmt::format("node_{}", i++)),
+				.depth = depth,
+				.parent_index = parent_index,
+				.transform = transform,
+				.matrix = f32x4x4(1),
+			});
+		});
+	}
+
+	void update_transforms()
+	{
+		for (auto & node: nodes[0])
+			node.matrix = Scene::Transform::calculate_transform(
+				node.transform.position, node.transform.rotation, node.transform.scale
+			);
+
+		for (usize depth = 1; depth < nodes.size(); ++depth)
+			for (auto & node: nodes[depth])
+				node.matrix = nodes[depth - 1][node.parent_index].matrix * Scene::Transform::calculate_transform(
+					node.transform.position, node.transform.rotation, node.transform.scale
+				);
+	}
+
+	// the linked list build DepthFirst had, every node is inserted after its parent
+	vector<Node *> depth_first()
+	{
+		std::forward_list<Node *> linked_traversal;
+		std::unordered_map<Node const *, std::forward_list<Node *>::const_iterator> node2iter;
+
+		for (auto & node: nodes[0])
+		{
+			linked_traversal.push_front(&node);
+			node2iter.emplace(&node, linked_traversal.begin());
+		}
+
+		for (usize depth = 1; depth < nodes.size(); ++depth)
+			for (auto & node: nodes[depth])
+			{
+				auto const & parent_iter = node2iter.at(&nodes[depth - 1][node.parent_index]);
+				node2iter.emplace(&node, linked_traversal.insert_after(parent_iter, &node));
+			}
+
+		return {linked_traversal.begin(), linked_traversal.end()};
+	}
+};
+}
+
+// every node is dirty, the worst case of a frame
+static void SceneTreeUpdateAll(benchmark::State & state)
+{
+	auto tree = make_tree(usize(state.range(0)));
+	for (auto _: state)
+	{
+		mark_all_dirty(tree);
+		benchmark::DoNotOptimize(tree.update_transforms(false).data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * tree.size()));
+}
+BENCHMARK(SceneTreeUpdateAll)->ArgName("nodes")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+static void BaselineTreeUpdateAll(benchmark::State & state)
+{
+	BaselineTree tree(usize(state.range(0)));
+	for (auto _: state)
+	{
+		tree.update_transforms();
+		benchmark::DoNotOptimize(tree.nodes.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * state.range(0)));
+}
+BENCHMARK(BaselineTreeUpdateAll)->ArgName("nodes")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// a few moving nodes, the common frame
+static void SceneTreeUpdateFew(benchmark::State & state)
+{
+	auto tree = make_tree(usize(state.range(0)));
+	tree.update_transforms(false);
+	std::mt19937 random{2};
+	for (auto _: state)
+	{
+		for (u32 i = 0; i < 100; ++i)
+		{
+			auto const depth = u32(tree.levels.size() - 1);
+			tree.mark_dirty({depth, u32(random() % tree.levels[depth].size())});
+		}
+		benchmark::DoNotOptimize(tree.update_transforms(false).data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * 100));
+}
+BENCHMARK(SceneTreeUpdateFew)->ArgName("nodes")->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// big levels are split into Jobs::parallel_for batches, 0 workers leaves the job system uninitialized
+// the deep shape has no level big enough to be split, it measures the overhead of the check
+static void SceneTreeUpdateParallel(benchmark::State & state)
+{
+	if (auto const worker_count = u32(state.range(0)); worker_count != 0)
+		Jobs::init({.worker_count = worker_count});
+
+	auto tree = make_tree(usize(state.range(1)), Shape(state.range(2)));
+	for (auto _: state)
+	{
+		mark_all_dirty(tree);
+		benchmark::DoNotOptimize(tree.update_transforms(true).data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * tree.size()));
+
+	Jobs::shutdown();
+}
+BENCHMARK(SceneTreeUpdateParallel)
+	->ArgNames({"workers", "nodes", "shape"})
+	->ArgsProduct({{0, 1, 3, 7}, {100'000}, {i64(Shape::Pyramid), i64(Shape::Wide), i64(Shape::Deep)}})
+	->UseRealTime()
+	->Unit(benchmark::kMicrosecond);
+
+// a full build, as after loading a scene, with the buffers of the previous build reused
+static void SceneTreeDepthFirstRebuild(benchmark::State & state)
+{
+	auto tree = make_tree(usize(state.range(0)));
+	Scene::Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+	for (auto _: state)
+	{
+		depth_first.rebuild();
+		benchmark::DoNotOptimize(depth_first.traversal.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * tree.size()));
+}
+BENCHMARK(SceneTreeDepthFirstRebuild)->ArgName("nodes")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+static void BaselineTreeDepthFirst(benchmark::State & state)
+{
+	BaselineTree tree(usize(state.range(0)));
+	for (auto _: state)
+		benchmark::DoNotOptimize(tree.depth_first().data());
+	state.SetItemsProcessed(i64(state.iterations() * state.range(0)));
+}
+BENCHMARK(BaselineTreeDepthFirst)->ArgName("nodes")->Arg(1000)->Arg(100'000)->Unit(benchmark::kMicrosecond);
+
+// a single subtree added to a built traversal, as when a model is spawned into a loaded scene
+static void SceneTreeDepthFirstInsertSubtree(benchmark::State & state)
+{
+	auto const node_count = usize(state.range(0));
+	for (auto _: state)
+	{
+		state.PauseTiming();
+		auto tree = make_tree(node_count);
+		auto const & built = tree.depth_first();
+		benchmark::DoNotOptimize(built.traversal.data());
+		auto const root = tree.add({.name = "subtree", .depth = 1, .parent_index = 3, .transform = {}, .mesh = {}});
+		for (u32 i = 0; i < 10; ++i)
+		{
+			auto const name = Name(fmt::format("subtree_{}", i));
+			tree.add({.name = name, .depth = 2, .parent_index = root.index, .transform = {}, .mesh = {}});
+		}
+		state.ResumeTiming();
+
+		benchmark::DoNotOptimize(tree.depth_first().traversal.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * 11));
+}
+BENCHMARK(SceneTreeDepthFirstInsertSubtree)
+	->ArgName("nodes")
+	->Arg(100'000)
+	->Iterations(20)
+	->Unit(benchmark::kMicrosecond);
+
+// the visible nodes' matrices into the transform buffer, all of them in level order as with culling off,
+// or a part in the scattered order of a bvh query
+static void SceneTreeGatherMatrices(benchmark::State & state)
+{
+	auto tree = make_tree(usize(state.range(0)));
+	tree.update_transforms(false);
+
+	vector<Scene::Tree::Index> indices;
+	for (u32 depth = 0; depth < tree.levels.size(); ++depth)
+		for (u32 i = 0; i < tree.levels[depth].size(); ++i)
+			indices.push_back({depth, i});
+	if (auto const percent = usize(state.range(1)); percent < 100)
+	{
+		std::ranges::shuffle(indices, std::mt19937{3});
+		indices.resize(indices.size() * percent / 100);
+	}
+
+	vector<f32x4x4> transforms(indices.size());
+	for (auto _: state)
+	{
+		tree.gather_matrices(indices, transforms.data());
+		benchmark::DoNotOptimize(transforms.data());
+	}
+	state.SetItemsProcessed(i64(state.iterations() * indices.size()));
+	state.SetBytesProcessed(i64(state.iterations() * indices.size() * sizeof(f32x4x4)));
+}
+BENCHMARK(SceneTreeGatherMatrices)
+	->ArgNames({"nodes", "percent"})
+	->ArgsProduct({{100'000}, {10, 100}})
+	->Unit(benchmark::kMicrosecond);
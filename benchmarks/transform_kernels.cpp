@@ -0,0 +1,94 @@
+#include <benchmark/benchmark.h>
+
+#include <core/transform_kernels.hpp>
+
+#include <random>
+
+using namespace TransformKernels;
+
+namespace
+{
+struct Nodes
+{
+	vector<f32x3> positions, scales;
+	vector<f32quat> rotations;
+	vector<u32> parent_indices;
+	vector<f32x4x4> matrices, parents;
+
+	explicit Nodes(usize count)
+	{
+		std::mt19937 random{1};
+		std::uniform_real_distribution<f32> unit(-1, 1);
+		for (usize i = 0; i < count; ++i)
+		{
+			positions.emplace_back(unit(random) * 50, unit(random) * 50, unit(random) * 50);
+			scales.emplace_back(unit(random) + 1.5f);
+			rotations.push_back(glm::normalize(f32quat(unit(random), unit(random), unit(random), unit(random))));
+			parent_indices.push_back(u32(random() % count));
+		}
+		matrices.resize(count);
+		parents.resize(count, f32x4x4(1));
+	}
+};
+
+// runs the kernel with the isa of the first argument, skips the ones the cpu lacks
+bool use_isa(benchmark::State & state)
+{
+	auto const isa = Isa(state.range(0));
+	if (isa > get_supported_isa())
+	{
+		state.SkipWithError("isa is not supported");
+		return false;
+	}
+	set_isa(isa);
+	state.SetLabel(to_string(isa));
+	return true;
+}
+}
+
+static void CalculateTransforms(benchmark::State & state)
+{
+	if (not use_isa(state))
+		return;
+
+	Nodes nodes(usize(state.range(1)));
+	for (auto _: state)
+	{
+		calculate_transforms(
+			nodes.positions.size(), nodes.positions.data(), nodes.rotations.data(), nodes.scales.data(),
+			nodes.matrices.data()
+		);
+		benchmark::DoNotOptimize(nodes.matrices.data());
+	}
+	set_isa(get_supported_isa());
+	state.SetItemsProcessed(i64(state.iterations() * nodes.positions.size()));
+}
+BENCHMARK(CalculateTransforms)
+	->ArgNames({"isa", "nodes"})
+	->ArgsProduct({{i64(Isa::Scalar), i64(Isa::SSE), i64(Isa::AVX2)}, {10'000, 100'000}})
+	->Unit(benchmark::kMicrosecond);
+
+static void ApplyParents(benchmark::State & state)
+{
+	if (not use_isa(state))
+		return;
+
+	Nodes nodes(usize(state.range(1)));
+	calculate_transforms(
+		nodes.positions.size(), nodes.positions.data(), nodes.rotations.data(), nodes.scales.data(),
+		nodes.parents.data()
+	);
+	for (auto _: state)
+	{
+		// the parents are the same every frame, only the children are rewritten
+		nodes.matrices = nodes.parents;
+		apply_parents(nodes.matrices.size(), nodes.parents.data(), nodes.parent_indices.data(), nodes.matrices.data());
+		benchmark::DoNotOptimize(nodes.matrices.data());
+	}
+	set_isa(get_supported_isa());
+	state.SetItemsProcessed(i64(state.iterations() * nodes.matrices.size()));
+}
+BENCHMARK(ApplyParents)
+	->ArgNames({"isa", "nodes"})
+	->ArgsProduct({{i64(Isa::Scalar), i64(Isa::SSE), i64(Isa::AVX2)}, {10'000, 100'000}})
+	->Unit(benchmark::kMicrosecond);
@@ -8,8 +8,13 @@
 #include "cubemap/convert.hpp"
 #include "envmap/convert.hpp"
 
+#include <core/allocators.hpp>
+#include <core/profiler.hpp>
+
 void Descriptions::init(std::filesystem::path const & project_root)
 {
+	PROFILE_ZONE("Descriptions::init");
+
 	root = project_root;
 
 	auto asset_descriptions_path = project_root / "assets.json";
@@ -76,6 +81,8 @@ void Descriptions::init(std::filesystem::path const & project_root)
 
 void Assets::init()
 {
+	PROFILE_ZONE("Assets::init");
+
 	for (auto const & [name, _] : descriptions.vertex_layout)
 		load_glsl_vertex_layout(name);
 
@@ -104,12 +111,16 @@ void Assets::init()
 
 void Assets::load_glsl_vertex_layout(Name const & name)
 {
+	PROFILE_ZONE("Assets::load_glsl_vertex_layout");
+
 	auto const layout_data = GLSL::VertexLayout::Load(descriptions.vertex_layout.get(name));
 	vertex_layouts.generate(name, move(layout_data));
 }
 
 void Assets::load_glsl_program(Name const & name)
 {
+	PROFILE_ZONE("Assets::load_glsl_program");
+
 	auto const loaded_data = GLSL::Program::Load(descriptions.glsl.get(name));
 
 	if (auto expected = GLSL::Program::Convert(loaded_data, vertex_layouts))
@@ -119,7 +130,7 @@ void Assets::load_glsl_program(Name const & name)
 	else
 	{
 		auto error = expected.into_error();
-		fmt::print(stderr, "Failed to load GLSL Program {}. Error: {}", name.string, error);
+		fmt::print(stderr, "Failed to load GLSL Program {}. Error: {}", name.string(), error);
 		programs.generate(name); // so it shows up in the editor
 		program_errors.generate(name, error);
 	}
@@ -127,6 +138,8 @@ void Assets::load_glsl_program(Name const & name)
 
 void Assets::load_glsl_uniform_block(Name const & name)
 {
+	PROFILE_ZONE("Assets::load_glsl_uniform_block");
+
 	auto const loaded_data = GLSL::UniformBlock::Load(descriptions.uniform_block.get(name));
 
 	if (auto expected = GLSL::UniformBlock::Convert(loaded_data))
@@ -137,31 +150,47 @@ void Assets::load_glsl_uniform_block(Name const & name)
 	else
 	{
 		auto error = expected.into_error();
-		fmt::print(stderr, "Failed to load Uniform Block {}. Error: {}", name.string, error);
+		fmt::print(stderr, "Failed to load Uniform Block {}. Error: {}", name.string(), error);
 		program_errors.generate(name, error);
 	}
 }
 
 void Assets::load_gltf(Name const & name)
 {
-	auto const gltf_data = GLTF::Load(descriptions.gltf.get(name));
+	PROFILE_ZONE("Assets::load_gltf");
+
+	// everything loaded is only needed until the conversion is done
+	LinearArena arena;
+	auto const gltf_data = GLTF::Load(descriptions.gltf.get(name), arena);
 	GLTF::Convert(gltf_data, textures, materials, primitives, meshes, scene_tree, vertex_layouts);
+
+	gltf_arena_stats.get_or_generate(name) = {
+		.allocation_count = arena.allocation_count,
+		.allocated_size = arena.allocated_size,
+		.block_count = arena.blocks.size(),
+	};
 }
 
 void Assets::load_texture(const Name & name)
 {
+	PROFILE_ZONE("Assets::load_texture");
+
 	auto texture_data = Texture::Load(descriptions.texture.get(name));
 	textures.generate(name, move(Texture::Convert(texture_data)));
 }
 
 void Assets::load_cubemap(Name const & name)
 {
+	PROFILE_ZONE("Assets::load_cubemap");
+
 	auto cubemap_data = Cubemap::Load(descriptions.cubemap.get(name));
 	texture_cubemaps.generate(name, move(Cubemap::Convert(cubemap_data)));
 }
 
 void Assets::load_envmap(Name const & name)
 {
+	PROFILE_ZONE("Assets::load_envmap");
+
 	auto envmap_data = Envmap::Load(descriptions.envmap.get(name));
 	Envmap::Convert(envmap_data, name, texture_cubemaps);
 }
@@ -221,7 +250,7 @@ bool Assets::reload_glsl_program(Name const & name)
 			{
 				auto error = fmt::format(
 					"Failed to reload GLSL Program {}: {} mappings is not a subset of the previous\n",
-					name.string, missmatch
+					name.string(), missmatch
 				);
 				// TODO(bekorn): logging only because the asset_kitchen is not stable enough, should be removed later
 				fmt::print(stderr, "{}", error);
@@ -239,7 +268,7 @@ bool Assets::reload_glsl_program(Name const & name)
 	{
 		auto error = expected.into_error();
 		// TODO(bekorn): logging only because the asset_kitchen is not stable enough, should be removed later
-		fmt::print(stderr, "Failed to reload GLSL Program {}. Error: {}\n", name.string, error);
+		fmt::print(stderr, "Failed to reload GLSL Program {}. Error: {}\n", name.string(), error);
 		program_errors.get_or_generate(name) = error;
 		return false;
 	}
@@ -24,14 +24,22 @@ struct Assets
 	Managed<GL::Texture3D> volumes;
 	// Render resources
 	Managed<Geometry::Primitive> primitives;
-	Managed<unique_one<Render::IMaterial>> materials;
-	Managed<Render::Mesh> meshes;
+	DenseManaged<Render::Material_gltf_pbrMetallicRoughness> materials;
+	DenseManaged<Render::Mesh> meshes;
 	// Scene resources
 	Scene::Tree scene_tree;
 
 	// For editing purposes
 	Managed<GL::ShaderProgram> initial_program_interfaces;
 	Managed<std::string> program_errors;
+	// of the arena each gltf was loaded from, for the Metrics window
+	struct ArenaStats
+	{
+		usize allocation_count;
+		usize allocated_size;
+		usize block_count;
+	};
+	Managed<ArenaStats> gltf_arena_stats;
 
 	explicit Assets(Descriptions const & descriptions) :
 		descriptions(descriptions)
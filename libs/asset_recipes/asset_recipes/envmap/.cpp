@@ -37,7 +37,7 @@ LoadedData Load(Desc const & desc)
 
 void Convert(LoadedData const & loaded, Name const & name, Managed<GL::TextureCubemap> & cubemaps)
 {
-	auto & diffuse = cubemaps.generate(name.string + "_diffuse").data;
+	auto & diffuse = cubemaps.generate(fmt::format("{}_diffuse", name.string())).data;
 	diffuse.init(GL::TextureCubemap::ImageDesc{
 		.face_dimensions = loaded.diffuse_face_dimensions,
 		.has_alpha = false,
@@ -46,7 +46,7 @@ void Convert(LoadedData const & loaded, Name const & name, Managed<GL::TextureCu
 		.data = loaded.diffuse.span_as<byte>(),
 	});
 
-	auto & specular = cubemaps.generate(name.string + "_specular").data;
+	auto & specular = cubemaps.generate(fmt::format("{}_specular", name.string())).data;
 	specular.init(GL::TextureCubemap::ImageDesc{
 		.face_dimensions = loaded.specular_face_dimensions,
 		.has_alpha = false,
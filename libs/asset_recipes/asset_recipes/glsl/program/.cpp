@@ -4,6 +4,8 @@
 #include "convert.hpp"
 #include "../_helpers.hpp"
 
+#include <core/profiler.hpp>
+
 namespace GLSL::Program
 {
 LoadedData Load(Desc const & desc)
@@ -62,6 +64,9 @@ const char * to_string(Geometry::Key const & key)
 	assert_enum_out_of_range();
 }
 
+// octahedral attributes (see Geometry::Attribute::is_octahedral) are declared as <name>_octahedral, shaders decode them
+//  vec3 normal = decode_octahedral(normal_octahedral);
+//  vec4 tangent = vec4(decode_octahedral(tangent_octahedral.xy), tangent_octahedral.z);
 std::string generate_vertex_layout(Geometry::Layout const & layout)
 {
 	std::string buffer;
@@ -69,9 +74,20 @@ std::string generate_vertex_layout(Geometry::Layout const & layout)
 	for (auto & attr : layout)
 		if (attr.is_used())
 			fmt::format_to(
-				back_inserter(buffer), "layout(location = {}) in vec{} {};\n",
-				attr.location, attr.type.dimension, to_string(attr.key)
+				back_inserter(buffer), "layout(location = {}) in vec{} {}{};\n",
+				attr.location, attr.type.dimension, to_string(attr.key), attr.is_octahedral() ? "_octahedral" : ""
 			);
+	if (std::ranges::any_of(layout, [](auto & attr) { return attr.is_used() and attr.is_octahedral(); }))
+		fmt::format_to(
+			back_inserter(buffer), "{}",
+			"vec3 decode_octahedral(vec2 e)\n"
+			"{\n"
+			"	vec3 n = vec3(e, 1 - abs(e.x) - abs(e.y));\n"
+			"	float t = max(-n.z, 0);\n"
+			"	n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0)));\n"
+			"	return normalize(n);\n"
+			"}\n"
+		);
 	fmt::format_to(back_inserter(buffer), "{}", "#endif\n\0");
 	return buffer;
 }
@@ -79,6 +95,8 @@ std::string generate_vertex_layout(Geometry::Layout const & layout)
 
 Expected<GL::ShaderProgram, std::string> Convert(LoadedData const & loaded, Managed<Geometry::Layout> const & vertex_layouts)
 {
+	PROFILE_ZONE("GLSL::Program::Convert");
+
 	using namespace Helpers;
 
 	vector<const char*> sources; // = { language_config, stage_define, loaded.includes, vertex_layout, "#line 1", stage_source }
@@ -92,7 +110,7 @@ Expected<GL::ShaderProgram, std::string> Convert(LoadedData const & loaded, Mana
 	sources[sources.size() - 2] = "#line 1\n";
 
 	std::string vertex_layout;
-	if (not loaded.layout_name.string.empty())
+	if (not loaded.layout_name.string().empty())
 		vertex_layout = generate_vertex_layout(vertex_layouts.get(loaded.layout_name));
 	sources[sources.size() - 3] = vertex_layout.data();
 
@@ -20,6 +20,18 @@ Geometry::Type get_type(const char * name)
 	if (0 == strcmp(name, "f32x2")) return {F32, 2};
 	if (0 == strcmp(name, "f32x3")) return {F32, 3};
 	if (0 == strcmp(name, "f32x4")) return {F32, 4};
+	if (0 == strcmp(name, "f16")) return {F16, 1};
+	if (0 == strcmp(name, "f16x2")) return {F16, 2};
+	if (0 == strcmp(name, "f16x3")) return {F16, 3};
+	if (0 == strcmp(name, "f16x4")) return {F16, 4};
+	if (0 == strcmp(name, "i8norm")) return {I8NORM, 1};
+	if (0 == strcmp(name, "i8normx2")) return {I8NORM, 2};
+	if (0 == strcmp(name, "i8normx3")) return {I8NORM, 3};
+	if (0 == strcmp(name, "i8normx4")) return {I8NORM, 4};
+	if (0 == strcmp(name, "i16norm")) return {I16NORM, 1};
+	if (0 == strcmp(name, "i16normx2")) return {I16NORM, 2};
+	if (0 == strcmp(name, "i16normx3")) return {I16NORM, 3};
+	if (0 == strcmp(name, "i16normx4")) return {I16NORM, 4};
 	if (0 == strcmp(name, "u8norm")) return {U8NORM, 1};
 	if (0 == strcmp(name, "u8normx2")) return {U8NORM, 2};
 	if (0 == strcmp(name, "u8normx3")) return {U8NORM, 3};
@@ -3,17 +3,24 @@
 #include "load.hpp"
 #include "convert.hpp"
 
-#include <execution>
+#include <core/jobs.hpp>
+#include <core/mesh_optimize.hpp>
+#include <core/meshlet.hpp>
+#include <core/quantize.hpp>
+#include <core/simplify.hpp>
+#include <core/profiler.hpp>
 
 namespace GLTF
 {
-LoadedData Load(Desc const & desc)
+LoadedData Load(Desc const & desc, std::pmr::memory_resource & resource)
 {
+	PROFILE_ZONE("GLTF::Load");
+
 	using namespace rapidjson;
 	using namespace File;
 	using namespace File::JSON;
 
-	LoadedData loaded;
+	LoadedData loaded(resource);
 
 	Document document;
 	document.Parse(LoadAsString(desc.path).c_str());
@@ -28,7 +35,7 @@ LoadedData Load(Desc const & desc)
 		auto file_size = buffer["byteLength"].GetUint64();
 		auto file_name = buffer["uri"].GetString();
 		// Limitation: only loads separate file binaries
-		loaded.buffers.emplace_back(LoadAsBytes(file_dir / file_name, file_size));
+		loaded.buffers.emplace_back(LoadAsBytes(file_dir / file_name, file_size, resource));
 	}
 
 	// Parse buffer views
@@ -51,31 +58,34 @@ LoadedData Load(Desc const & desc)
 	{
 		auto const & items = member->value.GetArray();
 		loaded.images.resize(items.Size());
-		std::transform(
-			std::execution::par_unseq,
-			items.Begin(), items.End(),
-			loaded.images.data(),
-			[&file_dir](Document::Array::ValueType const & item) -> GLTF::Image
+		Jobs::parallel_for(
+			items.Size(), 1,
+			[&items, &loaded, &file_dir](usize begin, usize end)
 			{
-				auto const & image = item.GetObject();
+				for (auto i = begin; i < end; ++i)
+				{
+					auto const & image = items[i].GetObject();
 
-				auto const member = image.FindMember("uri");
-				if (member == image.MemberEnd())
-					throw std::runtime_error("images without a uri file path are not supported yet");
+					auto const member = image.FindMember("uri");
+					if (member == image.MemberEnd())
+						throw std::runtime_error("images without a uri file path are not supported yet");
 
-				auto uri = member->value.GetString();
-				if (uri[5] == ':') // check for "data:" (base64 encoded data as a json string)
-					throw std::runtime_error("images without a uri file path are not supported yet");
+					auto uri = member->value.GetString();
+					if (uri[5] == ':') // check for "data:" (base64 encoded data as a json string)
+						throw std::runtime_error("images without a uri file path are not supported yet");
 
-				// gltf textures (first-pixel == uv(0,0)) do not require a vertical flip
-				auto image_file = File::LoadImage(file_dir / uri, false);
+					PROFILE_ZONE("GLTF::Load image");
 
-				return {
-					.data = move(image_file.buffer),
-					.dimensions = image_file.dimensions,
-					.channels = image_file.channels,
-					.is_sRGB = false,
-				};
+					// gltf textures (first-pixel == uv(0,0)) do not require a vertical flip
+					auto image_file = File::LoadImage(file_dir / uri, false);
+
+					loaded.images[i] = {
+						.data = move(image_file.buffer),
+						.dimensions = image_file.dimensions,
+						.channels = image_file.channels,
+						.is_sRGB = false,
+					};
+				}
 			}
 		);
 	}
@@ -152,13 +162,13 @@ LoadedData Load(Desc const & desc)
 	{
 		auto const & mesh = item.GetObject();
 
-		vector<Primitive> primitives;
+		std::pmr::vector<Primitive> primitives(&resource);
 		primitives.reserve(mesh["primitives"].Size());
 		for (auto const & item: mesh["primitives"].GetArray())
 		{
 			auto const & primitive = item.GetObject();
 
-			vector<Attribute> attributes;
+			std::pmr::vector<Attribute> attributes(&resource);
 			attributes.reserve(primitive["attributes"].MemberCount());
 			for (auto const & attribute: primitive["attributes"].GetObject())
 			{
@@ -173,7 +183,7 @@ LoadedData Load(Desc const & desc)
 			primitives.push_back(
 				{
 					.name = primitive_name_generator.get(primitive, "name"),
-					.attributes = attributes,
+					.attributes = move(attributes),
 					.indices_accessor_index = GetOptionalU32(primitive, "indices"),
 					.material_index = GetOptionalU32(primitive, "material"),
 				}
@@ -183,13 +193,15 @@ LoadedData Load(Desc const & desc)
 		loaded.meshes.push_back(
 			{
 				.name = mesh_name_generator.get(mesh, "name"),
-				.primitives = primitives,
+				.primitives = move(primitives),
 			}
 		);
 	}
 
-	// Pass layout name
+	// Pass layout name, lod ratios and meshlets
 	loaded.layout_name = desc.layout_name;
+	loaded.lod_ratios.assign(desc.lod_ratios.begin(), desc.lod_ratios.end());
+	loaded.build_meshlets = desc.build_meshlets;
 
 	// Parse materials
 	NameGenerator material_name_generator{.prefix = desc.name + ":material:"};
@@ -250,7 +262,7 @@ LoadedData Load(Desc const & desc)
 			mark_sRGB(mat.pbr_metallic_roughness.value().base_color_texture);
 		}
 
-		loaded.materials.push_back(mat);
+		loaded.materials.push_back(move(mat));
 	}
 
 	// Parse nodes
@@ -264,6 +276,7 @@ LoadedData Load(Desc const & desc)
 			Node node{
 				.name = node_name_generator.get(gltf_node, "name"),
 				.mesh_index = GetOptionalU32(gltf_node, "mesh"),
+				.child_indices = std::pmr::vector<u32>(&resource),
 			};
 
 			if (auto member = gltf_node.FindMember("matrix"); member != gltf_node.MemberEnd())
@@ -290,7 +303,7 @@ LoadedData Load(Desc const & desc)
 				for (auto & child_index: member->value.GetArray())
 					node.child_indices.push_back(child_index.GetUint());
 
-			loaded.nodes.push_back(node);
+			loaded.nodes.push_back(move(node));
 		}
 	}
 
@@ -398,13 +411,15 @@ namespace Helpers
 void Convert(
 	LoadedData const & loaded,
 	Managed<GL::Texture2D> & textures,
-	Managed<unique_one<Render::IMaterial>> & materials,
+	DenseManaged<Render::Material_gltf_pbrMetallicRoughness> & materials,
 	Managed<Geometry::Primitive> & primitives,
-	Managed<Render::Mesh> & meshes,
+	DenseManaged<Render::Mesh> & meshes,
 	::Scene::Tree & scene_tree,
 	Managed<Geometry::Layout> const & vertex_layouts
 )
 {
+	PROFILE_ZONE("GLTF::Convert");
+
 	using namespace Helpers;
 
 	// Convert Textures
@@ -448,45 +463,49 @@ void Convert(
 		if (loaded_mat.pbr_metallic_roughness.has_value())
 		{
 			auto & pbr_mat = loaded_mat.pbr_metallic_roughness.value();
-			auto mat = make_unique_one<Render::Material_gltf_pbrMetallicRoughness>();
+			Render::Material_gltf_pbrMetallicRoughness mat;
 
 			// TODO: use texcoord indices as well
 			if (pbr_mat.base_color_texture)
-				mat->base_color_texture_handle = textures.get(loaded.textures[pbr_mat.base_color_texture->texture_index].name).handle;
+				mat.base_color_texture_handle = textures.get(loaded.textures[pbr_mat.base_color_texture->texture_index].name).handle;
 			else
-				mat->base_color_factor = pbr_mat.base_color_factor;
+				mat.base_color_factor = pbr_mat.base_color_factor;
 
 			if (pbr_mat.metallic_roughness_texture)
-				mat->metallic_roughness_texture_handle = textures.get(loaded.textures[pbr_mat.metallic_roughness_texture->texture_index].name).handle;
+				mat.metallic_roughness_texture_handle = textures.get(loaded.textures[pbr_mat.metallic_roughness_texture->texture_index].name).handle;
 			else
-				mat->metallic_roughness_factor = {pbr_mat.metallic_factor, pbr_mat.roughness_factor};
+				mat.metallic_roughness_factor = {pbr_mat.metallic_factor, pbr_mat.roughness_factor};
 
 			if (loaded_mat.emissive_texture)
-				mat->emissive_texture_handle = textures.get(loaded.textures[loaded_mat.emissive_texture->texture_index].name).handle;
+				mat.emissive_texture_handle = textures.get(loaded.textures[loaded_mat.emissive_texture->texture_index].name).handle;
 			else
-				mat->emissive_factor = loaded_mat.emissive_factor;
+				mat.emissive_factor = loaded_mat.emissive_factor;
 
 			if (loaded_mat.occlusion_texture)
-				mat->occlusion_texture_handle = textures.get(loaded.textures[loaded_mat.occlusion_texture->texture_index].name).handle;
+				mat.occlusion_texture_handle = textures.get(loaded.textures[loaded_mat.occlusion_texture->texture_index].name).handle;
 
 			if (loaded_mat.normal_texture)
-				mat->normal_texture_handle = textures.get(loaded.textures[loaded_mat.normal_texture->texture_index].name).handle;
+				mat.normal_texture_handle = textures.get(loaded.textures[loaded_mat.normal_texture->texture_index].name).handle;
 
-			materials.generate(loaded_mat.name).data = move(mat);
+			materials.generate(loaded_mat.name).data = mat;
 		}
 	}
 
 	// Convert primitives
 	// TODO(bekorn): the layout is same for the whole gltf file, it should be more granular, per material perhaps
+	// read in F32 first (see Geometry::get_source_layout), quantized into the layout after the optimizations
 	auto & layout = vertex_layouts.get(loaded.layout_name);
+	auto const source_layout = Geometry::get_source_layout(layout);
 	vector<Geometry::Key> loaded_attrib_keys;
 	loaded_attrib_keys.reserve(Geometry::ATTRIBUTE_COUNT);
+	vector<Geometry::Primitive *> converted_primitives;
 	for (auto & loaded_mesh: loaded.meshes)
 		for (auto & loaded_primitive: loaded_mesh.primitives)
 		{
 			auto & primitive = primitives.generate(Name(loaded_primitive.name)).data;
+			converted_primitives.push_back(&primitive);
 
-			primitive.layout = &layout;
+			primitive.layout = &source_layout;
 
 			assert(loaded_primitive.attributes.size() < Geometry::ATTRIBUTE_COUNT, "Primitive has too many attributes");
 			loaded_attrib_keys.clear();
@@ -541,6 +560,9 @@ void Convert(
 				}
 			}
 
+			// accessor min/max would only give the box, the sphere needs the positions anyway
+			primitive.calculate_bounds();
+
 			if (loaded_primitive.indices_accessor_index.has_value())
 			{
 				auto & accessor = loaded.accessors[loaded_primitive.indices_accessor_index.value()];
@@ -590,10 +612,82 @@ void Convert(
 			}
 		}
 
+	// Generate lods and optimize for the gpu, primitives are independent and the passes are single threaded
+	// welding first, so the simplifier sees the connectivity of non indexed primitives too
+	// meshlets last, they keep the optimized order mostly and need the indices to stay as they are
+	Jobs::parallel_for(
+		converted_primitives.size(), 1,
+		[&converted_primitives, &loaded](usize begin, usize end)
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				auto & primitive = *converted_primitives[i];
+				Geometry::weld_vertices(primitive);
+				if (not loaded.lod_ratios.empty())
+					Geometry::generate_lods(primitive, loaded.lod_ratios);
+				Geometry::optimize(primitive);
+				if (loaded.build_meshlets)
+					Geometry::build_meshlets(primitive);
+			}
+		}
+	);
+
+	// Quantize, the primitives of a mesh share a box so they share the dequantization
+	vector<Geometry::Quantization> quantizations;
+	vector<u32> primitive_quantizations; // parallel to converted_primitives
+	quantizations.reserve(loaded.meshes.size());
+	primitive_quantizations.reserve(converted_primitives.size());
+	for (auto primitive_iter = converted_primitives.begin(); auto & loaded_mesh: loaded.meshes)
+	{
+		Geometry::AABB box;
+		for (auto const * primitive: span(primitive_iter, loaded_mesh.primitives.size()))
+		{
+			box.expand(primitive->bounds.box);
+			primitive_quantizations.push_back(u32(quantizations.size()));
+		}
+		primitive_iter += loaded_mesh.primitives.size();
+
+		quantizations.push_back(Geometry::Quantization::from_box(box, layout));
+	}
+	auto const get_vertex_data_size = [](Geometry::Primitive const & primitive)
+	{
+		usize size = 0;
+		for (auto i = 0; i < Geometry::ATTRIBUTE_COUNT; ++i)
+			if (primitive.layout->attributes[i].is_used())
+				size += primitive.data.buffers[i].size;
+		return size;
+	};
+	vector<Geometry::QuantizationErrors> quantization_errors(converted_primitives.size());
+	vector<usize> source_sizes(converted_primitives.size());
+	Jobs::parallel_for(
+		converted_primitives.size(), 1,
+		[&converted_primitives, &layout, &quantizations, &primitive_quantizations, &quantization_errors, &source_sizes,
+			&get_vertex_data_size](usize begin, usize end)
+		{
+			for (auto i = begin; i < end; ++i)
+			{
+				auto & primitive = *converted_primitives[i];
+				source_sizes[i] = get_vertex_data_size(primitive);
+				quantization_errors[i] = Geometry::quantize(primitive, layout, quantizations[primitive_quantizations[i]]);
+			}
+		}
+	);
 	// Convert meshes
-	for (auto & loaded_mesh: loaded.meshes)
+	for (usize mesh_index = 0, primitive_index = 0; auto & loaded_mesh: loaded.meshes)
 	{
 		auto & mesh = meshes.generate(loaded_mesh.name).data;
+		mesh.dequantization = quantizations[mesh_index++].dequantization;
+
+		auto & stats = mesh.quantization_stats;
+		for (usize i = 0; i < loaded_mesh.primitives.size(); ++i, ++primitive_index)
+		{
+			stats.source_size += source_sizes[primitive_index];
+			stats.size += get_vertex_data_size(*converted_primitives[primitive_index]);
+			for (auto a = 0; a < Geometry::ATTRIBUTE_COUNT; ++a)
+				stats.errors.max_errors[a] = glm::max(
+					stats.errors.max_errors[a], quantization_errors[primitive_index].max_errors[a]
+				);
+		}
 
 		// Create Drawables
 		mesh.drawables.reserve(loaded_mesh.primitives.size());
@@ -609,7 +703,7 @@ void Convert(
 			mesh.drawables.push_back(
 				{
 					.primitive = primitives.get(loaded_primitive.name),
-					.named_material = materials.get_named(material_name),
+					.material = materials.get_handle(material_name),
 				}
 			);
 		}
@@ -645,8 +739,8 @@ void Convert(
 					.scale = loaded_node.scale,
 				},
 				.mesh = loaded_node.mesh_index.has_value()
-						? &meshes.get(loaded.meshes[loaded_node.mesh_index.value()].name)
-						: nullptr,
+						? meshes.get_handle(loaded.meshes[loaded_node.mesh_index.value()].name)
+						: Handle<Render::Mesh>{},
 			});
 
 			for (auto & child_index: loaded_node.child_indices)
@@ -660,13 +754,21 @@ void Convert(
 std::pair<Name, Desc> Parse(File::JSON::JSONObj o, std::filesystem::path const & root_dir)
 {
 	auto name = o.FindMember("name")->value.GetString();
-	return {
-		name,
-		{
-			.name = name,
-			.path = root_dir / o.FindMember("path")->value.GetString(),
-			.layout_name = o.FindMember("layout")->value.GetString(),
-		},
+	Desc desc{
+		.name = name,
+		.path = root_dir / o.FindMember("path")->value.GetString(),
+		.layout_name = o.FindMember("layout")->value.GetString(),
 	};
+
+	// optional, like [0.5, 0.25, 0.125]
+	if (auto member = o.FindMember("lod_ratios"); member != o.MemberEnd())
+	{
+		for (auto const & ratio: member->value.GetArray())
+			desc.lod_ratios.push_back(ratio.GetFloat());
+	}
+
+	desc.build_meshlets = File::JSON::GetBool(o, "meshlets", false);
+
+	return {name, desc};
 }
 }
\ No newline at end of file
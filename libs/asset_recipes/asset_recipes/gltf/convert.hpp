@@ -17,9 +17,9 @@ namespace GLTF
 void Convert(
 	LoadedData const & loaded,
 	Managed<GL::Texture2D> & textures,
-	Managed<unique_one<Render::IMaterial>> & materials,
+	DenseManaged<Render::Material_gltf_pbrMetallicRoughness> & materials,
 	Managed<Geometry::Primitive> & primitives,
-	Managed<Render::Mesh> & meshes,
+	DenseManaged<Render::Mesh> & meshes,
 	::Scene::Tree & scene_tree,
 	Managed<Geometry::Layout> const & vertex_layouts
 );
@@ -68,7 +68,7 @@ struct Attribute
 struct Primitive
 {
 	std::string name;
-	vector<Attribute> attributes;
+	std::pmr::vector<Attribute> attributes;
 	optional<u32> indices_accessor_index;
 	optional<u32> material_index;
 };
@@ -76,7 +76,7 @@ struct Primitive
 struct Mesh
 {
 	std::string name;
-	vector<Primitive> primitives;
+	std::pmr::vector<Primitive> primitives;
 };
 
 struct Material
@@ -121,41 +121,59 @@ struct Node
 	f32quat rotation;
 	f32x3 scale;
 	optional<u32> mesh_index;
-	vector<u32> child_indices;
+	std::pmr::vector<u32> child_indices;
 };
 
 struct Scene
 {
 	std::string name;
-	vector<u32> node_indices;
+	std::pmr::vector<u32> node_indices;
 };
 
+// all the containers (and the buffers) allocate from the given resource,
+// image pixels are the exception, they are decoded in parallel (see Load)
 struct LoadedData
 {
-	vector<ByteBuffer> buffers;
-	vector<BufferView> buffer_views;
-	vector<Accessor> accessors;
+	std::pmr::vector<ByteBuffer> buffers;
+	std::pmr::vector<BufferView> buffer_views;
+	std::pmr::vector<Accessor> accessors;
 
-	vector<Image> images;
-	vector<Sampler> samplers;
-	vector<Texture> textures;
+	std::pmr::vector<Image> images;
+	std::pmr::vector<Sampler> samplers;
+	std::pmr::vector<Texture> textures;
 
-	vector<Mesh> meshes;
+	std::pmr::vector<Mesh> meshes;
 	Name layout_name;
-	vector<Material> materials;
+	std::pmr::vector<f32> lod_ratios;
+	bool build_meshlets;
+	std::pmr::vector<Material> materials;
 
-	vector<Node> nodes;
+	std::pmr::vector<Node> nodes;
 	Scene scene;
+
+	explicit LoadedData(std::pmr::memory_resource & resource) :
+		buffers(&resource), buffer_views(&resource), accessors(&resource),
+		images(&resource), samplers(&resource), textures(&resource),
+		meshes(&resource), lod_ratios(&resource), materials(&resource),
+		nodes(&resource), scene{.name = {}, .node_indices = std::pmr::vector<u32>(&resource)}
+	{}
 };
 
 auto const pbrMetallicRoughness_program_name = "gltf_pbrMetallicRoughness"_name;
+// same stages compiled with INSTANCED or INDIRECT defined, optional
+auto const pbrMetallicRoughness_instanced_program_name = "gltf_pbrMetallicRoughness_instanced"_name;
+auto const pbrMetallicRoughness_indirect_program_name = "gltf_pbrMetallicRoughness_indirect"_name;
 
 struct Desc
 {
 	std::string name;
 	std::filesystem::path path;
 	Name layout_name;
+	// of the full detail triangle count, every primitive gets a lod per ratio (see Geometry::generate_lods), none by default
+	vector<f32> lod_ratios;
+	// splits the full detail of every primitive into meshlets for the cpu culling (see Geometry::build_meshlets)
+	bool build_meshlets = false;
 };
 
-LoadedData Load(Desc const & desc);
+LoadedData Load(Desc const & desc, std::pmr::memory_resource & resource = *std::pmr::get_default_resource());
 }
\ No newline at end of file
@@ -0,0 +1,32 @@
+#include "allocators.hpp"
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h> // GetProcessMemoryInfo is in kernel32 since PSAPI_VERSION 2, no extra library is needed
+#elif defined(__linux__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+usize get_peak_rss()
+{
+#if defined(_WIN32)
+	PROCESS_MEMORY_COUNTERS counters;
+	if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return counters.PeakWorkingSetSize;
+	return 0;
+#elif defined(__linux__) || defined(__APPLE__)
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0;
+#if defined(__APPLE__)
+	return usize(usage.ru_maxrss); // in bytes
+#else
+	return usize(usage.ru_maxrss) << 10; // in KiB
+#endif
+#else
+	return 0;
+#endif
+}
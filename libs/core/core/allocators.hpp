@@ -0,0 +1,256 @@
+#pragma once
+
+#include "core.hpp"
+
+// the most memory the process has used so far (peak working set on Windows, max resident set on Linux), 0 if unknown
+usize get_peak_rss();
+
+// Bump allocates from a list of blocks, individual deallocations are ignored, everything is freed at once
+// Not thread-safe, intended for a single asset load (see Assets::load_gltf)
+struct LinearArena final : std::pmr::memory_resource
+{
+	struct Block
+	{
+		unique_array<byte> data;
+		usize size;
+	};
+	vector<Block> blocks;
+	usize block_size;
+	byte * current = nullptr;
+	byte * current_end = nullptr;
+
+	// stats
+	usize allocation_count = 0;
+	usize allocated_size = 0;
+
+	explicit LinearArena(usize block_size = 1 << 20) :
+		block_size(block_size)
+	{}
+
+	COPY(LinearArena, delete)
+	MOVE(LinearArena, delete)
+
+	void release()
+	{
+		blocks.clear();
+		current = current_end = nullptr;
+		allocation_count = allocated_size = 0;
+	}
+
+	void * do_allocate(usize size, usize alignment) final
+	{
+		auto * aligned = align(current, alignment);
+		if (aligned == nullptr or aligned + size > current_end)
+		{
+			// big allocations get their own block so the common block size stays reasonable
+			auto new_block_size = glm::max(block_size, size + alignment);
+			blocks.push_back({.data = make_unique_array<byte>(new_block_size), .size = new_block_size});
+			current = blocks.back().data.get();
+			current_end = current + new_block_size;
+			aligned = align(current, alignment);
+		}
+
+		current = aligned + size;
+		allocation_count++;
+		allocated_size += size;
+		return aligned;
+	}
+
+	void do_deallocate(void *, usize, usize) final
+	{}
+
+	bool do_is_equal(std::pmr::memory_resource const & other) const noexcept final
+	{ return this == &other; }
+
+	static byte * align(byte * pointer, usize alignment)
+	{
+		if (pointer == nullptr)
+			return nullptr;
+		auto address = reinterpret_cast<uintptr_t>(pointer);
+		return pointer + ((alignment - address % alignment) % alignment);
+	}
+};
+
+// Fixed capacity bump allocator, reset at the start of every frame (see Render::frame_allocator)
+// When the capacity is exceeded, allocations fall back to the upstream resource
+// Overflows should be avoided by picking a bigger capacity (see peak_size)
+struct FrameAllocator final : std::pmr::memory_resource
+{
+	unique_array<byte> buffer;
+	usize capacity = 0;
+	usize offset = 0;
+	std::pmr::memory_resource * upstream = std::pmr::new_delete_resource();
+
+	// stats
+	usize last_frame_size = 0;
+	usize peak_size = 0; // of all the frames since init
+	usize allocation_count = 0; // of the last completed frame
+	usize overflow_count = 0; // of the last completed frame
+	usize _allocation_count_this_frame = 0;
+	usize _overflow_count_this_frame = 0;
+
+	struct Desc
+	{
+		usize capacity;
+	};
+
+	void init(Desc const & desc)
+	{
+		capacity = desc.capacity;
+		buffer = make_unique_array<byte>(capacity);
+		offset = 0;
+		last_frame_size = peak_size = 0;
+	}
+
+	// everything allocated in the previous frame becomes invalid
+	void reset()
+	{
+		last_frame_size = offset;
+		peak_size = glm::max(peak_size, offset);
+		allocation_count = _allocation_count_this_frame;
+		overflow_count = _overflow_count_this_frame;
+		offset = 0;
+		_allocation_count_this_frame = _overflow_count_this_frame = 0;
+	}
+
+	bool owns(void const * pointer) const
+	{ return buffer.get() <= pointer and pointer < buffer.get() + capacity; }
+
+	void * do_allocate(usize size, usize alignment) final
+	{
+		_allocation_count_this_frame++;
+		auto aligned_offset = (offset + alignment - 1) / alignment * alignment;
+		if (aligned_offset + size > capacity)
+		{
+			_overflow_count_this_frame++;
+			return upstream->allocate(size, alignment);
+		}
+
+		offset = aligned_offset + size;
+		return buffer.get() + aligned_offset;
+	}
+
+	void do_deallocate(void * pointer, usize size, usize alignment) final
+	{
+		if (not owns(pointer))
+			upstream->deallocate(pointer, size, alignment);
+	}
+
+	bool do_is_equal(std::pmr::memory_resource const & other) const noexcept final
+	{ return this == &other; }
+};
+
+// Fences mark when the gpu is done with a segment, see GL::SyncFences
+template<typename T>
+concept FenceProvider = requires(T provider, typename T::Fence fence)
+{
+	{ provider.insert() } -> std::same_as<typename T::Fence>; // after the commands of the frame
+	provider.wait(fence); // blocks until the commands before the fence are complete
+	provider.release(fence);
+};
+
+// Offsets into a buffer split into a segment per frame in flight, a segment is reused only after its fence is waited
+// Only the bookkeeping, the memory is owned by the user (see GL::RingBuffer)
+template<FenceProvider Provider>
+struct RingAllocator
+{
+	using Fence = typename Provider::Fence;
+
+	Provider provider;
+	u32 segment_count = 0;
+	usize segment_size = 0;
+	usize alignment = 1;
+
+	u32 segment = 0;
+	usize offset = 0; // in the segment
+	bool is_in_frame = false;
+	vector<optional<Fence>> fences; // per segment, of the frame that used it last
+
+	// stats
+	usize last_frame_size = 0;
+	usize peak_size = 0; // of all the frames since init
+	usize wait_count = 0; // fences waited since init
+
+	struct Desc
+	{
+		u32 segment_count = 3;
+		usize segment_size;
+		usize alignment = 1;
+	};
+
+	void init(Desc const & desc)
+	{
+		assert(desc.segment_count != 0 and desc.alignment != 0);
+		segment_count = desc.segment_count;
+		alignment = desc.alignment;
+		segment_size = align(desc.segment_size); // keeps the segment starts aligned
+		segment = segment_count - 1; // so the first frame uses the first segment
+		offset = 0;
+		is_in_frame = false;
+		fences.assign(segment_count, nullopt);
+		last_frame_size = peak_size = wait_count = 0;
+	}
+
+	usize get_capacity() const
+	{ return segment_count * segment_size; }
+
+	usize align(usize size) const
+	{ return (size + alignment - 1) / alignment * alignment; }
+
+	void begin_frame()
+	{
+		assert(not is_in_frame, "end_frame is not called");
+		segment = (segment + 1) % segment_count;
+		wait(segment);
+		offset = 0;
+		is_in_frame = true;
+	}
+
+	void end_frame()
+	{
+		assert(is_in_frame, "begin_frame is not called");
+		assert(not fences[segment].has_value());
+		fences[segment] = provider.insert();
+		last_frame_size = offset;
+		peak_size = glm::max(peak_size, offset);
+		is_in_frame = false;
+	}
+
+	// offset from the start of the buffer, nullopt if the segment of the frame is full
+	optional<usize> allocate(usize size)
+	{
+		assert(is_in_frame, "allocations are only valid within a frame");
+		auto aligned_offset = align(offset);
+		if (aligned_offset + size > segment_size)
+			return nullopt;
+
+		offset = aligned_offset + size;
+		return segment * segment_size + aligned_offset;
+	}
+
+	// after this no segment is in use, so the memory can be replaced
+	void wait_all()
+	{
+		for (u32 i = 0; i < segment_count; ++i)
+			wait(i);
+	}
+
+	// only before the first allocation of a frame, waits for all the segments
+	void resize(usize new_segment_size)
+	{
+		assert(offset == 0, "segments can not be resized after an allocation");
+		wait_all();
+		segment_size = align(new_segment_size);
+	}
+
+	void wait(u32 segment_idx)
+	{
+		if (auto & fence = fences[segment_idx]; fence.has_value())
+		{
+			provider.wait(*fence);
+			provider.release(*fence);
+			fence.reset();
+			wait_count++;
+		}
+	}
+};
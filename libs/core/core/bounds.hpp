@@ -0,0 +1,233 @@
+#pragma once
+
+#include "core.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define Bounds_SSE2
+#endif
+
+namespace Geometry
+{
+struct AABB
+{
+	// empty by default, expanding with any point makes it valid
+	f32x3 min{std::numeric_limits<f32>::max()};
+	f32x3 max{std::numeric_limits<f32>::lowest()};
+
+	bool is_empty() const
+	{ return any(greaterThan(min, max)); }
+
+	void expand(f32x3 const & point)
+	{
+		min = glm::min(min, point);
+		max = glm::max(max, point);
+	}
+
+	void expand(AABB const & other)
+	{
+		min = glm::min(min, other.min);
+		max = glm::max(max, other.max);
+	}
+
+	f32x3 center() const
+	{ return (min + max) * 0.5f; }
+
+	f32x3 half_extent() const
+	{ return (max - min) * 0.5f; }
+
+	f32 surface_area() const
+	{
+		auto extent = max - min;
+		return 2 * (extent.x * extent.y + extent.y * extent.z + extent.z * extent.x);
+	}
+
+	// distance along the ray to the box (0 if the origin is inside), nullopt if it misses
+	optional<f32> intersect_ray(f32x3 const & origin, f32x3 const & inverse_direction, f32 max_distance) const
+	{
+		// slab test, zero direction components give infinities which work out (except origins exactly on a slab)
+		auto t0 = (min - origin) * inverse_direction;
+		auto t1 = (max - origin) * inverse_direction;
+		auto t_near = glm::min(t0, t1);
+		auto t_far = glm::max(t0, t1);
+
+		auto enter = glm::max(glm::max(t_near.x, t_near.y), glm::max(t_near.z, 0.f));
+		auto exit = glm::min(glm::min(t_far.x, t_far.y), glm::min(t_far.z, max_distance));
+		if (enter > exit)
+			return nullopt;
+		return enter;
+	}
+
+	// box of the transformed box, see Arvo, Transforming Axis-Aligned Bounding Boxes (Graphics Gems, 1990)
+	AABB transformed(f32x4x4 const & matrix) const
+	{
+		if (is_empty())
+			return {};
+
+		auto center = f32x3(matrix * f32x4(this->center(), 1));
+		auto abs_basis = f32x3x3(f32x3(glm::abs(matrix[0])), f32x3(glm::abs(matrix[1])), f32x3(glm::abs(matrix[2])));
+		auto half_extent = abs_basis * this->half_extent();
+		return {.min = center - half_extent, .max = center + half_extent};
+	}
+};
+
+struct Ray
+{
+	f32x3 origin;
+	f32x3 direction;
+	f32 max_distance = std::numeric_limits<f32>::max();
+};
+
+struct Sphere
+{
+	f32x3 center{0};
+	f32 radius = -1; // negative is empty
+
+	bool is_empty() const
+	{ return radius < 0; }
+
+	Sphere transformed(f32x4x4 const & matrix) const
+	{
+		if (is_empty())
+			return {};
+
+		// non-uniform scales are covered by the longest axis
+		auto const length_squared = [](f32x4 const & v)
+		{ return glm::dot(f32x3(v), f32x3(v)); };
+		auto max_scale_squared = glm::max(
+			glm::max(length_squared(matrix[0]), length_squared(matrix[1])), length_squared(matrix[2])
+		);
+		return {
+			.center = f32x3(matrix * f32x4(center, 1)),
+			.radius = radius * glm::sqrt(max_scale_squared),
+		};
+	}
+};
+
+struct Bounds
+{
+	AABB box;
+	Sphere sphere;
+
+	// sphere is centered at the box, not the tightest but cheap and stable
+	static Bounds from_points(span<f32x3 const> points)
+	{
+		Bounds bounds;
+		for (auto const & point: points)
+			bounds.box.expand(point);
+
+		if (bounds.box.is_empty())
+			return bounds;
+
+		bounds.sphere.center = bounds.box.center();
+		f32 max_distance_squared = 0;
+		for (auto const & point: points)
+		{
+			auto offset = point - bounds.sphere.center;
+			max_distance_squared = glm::max(max_distance_squared, glm::dot(offset, offset));
+		}
+		bounds.sphere.radius = glm::sqrt(max_distance_squared);
+
+		return bounds;
+	}
+};
+
+// Planes are extracted from a view projection matrix (Gribb & Hartmann), assuming GLM_FORCE_DEPTH_ZERO_TO_ONE
+// Stored as structure of arrays, padded to 8 planes that contain everything, so 4 planes are tested at once
+struct Frustum
+{
+	static constexpr u32 COUNT = 6; // left, right, bottom, top, near, far
+	static constexpr u32 PADDED_COUNT = 8;
+
+	// a point p is inside a plane when dot(normal, p) + distance >= 0, normals point inside and are normalized
+	alignas(16) array<f32, PADDED_COUNT> normal_xs;
+	alignas(16) array<f32, PADDED_COUNT> normal_ys;
+	alignas(16) array<f32, PADDED_COUNT> normal_zs;
+	alignas(16) array<f32, PADDED_COUNT> distances;
+
+	static Frustum from_view_projection(f32x4x4 const & view_projection)
+	{
+		auto const row = [&view_projection](u32 i)
+		{ return f32x4(view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]); };
+
+		array<f32x4, COUNT> const planes{
+			row(3) + row(0),
+			row(3) - row(0),
+			row(3) + row(1),
+			row(3) - row(1),
+			row(2), // would be row(3) + row(2) for negative one to one depth
+			row(3) - row(2),
+		};
+
+		Frustum frustum;
+		for (u32 i = 0; i < PADDED_COUNT; ++i)
+		{
+			auto plane = i < COUNT ? planes[i] / glm::length(f32x3(planes[i])) : f32x4(0, 0, 0, 1);
+			frustum.normal_xs[i] = plane.x;
+			frustum.normal_ys[i] = plane.y;
+			frustum.normal_zs[i] = plane.z;
+			frustum.distances[i] = plane.w;
+		}
+		return frustum;
+	}
+
+	// conservative, may report intersection for boxes near the corners
+	bool intersects(AABB const & box) const
+	{
+		if (box.is_empty())
+			return false;
+
+		auto center = box.center();
+		auto half_extent = box.half_extent();
+
+#ifdef Bounds_SSE2
+		auto const cx = _mm_set1_ps(center.x), cy = _mm_set1_ps(center.y), cz = _mm_set1_ps(center.z);
+		auto const ex = _mm_set1_ps(half_extent.x), ey = _mm_set1_ps(half_extent.y), ez = _mm_set1_ps(half_extent.z);
+		auto const sign_mask = _mm_set1_ps(-0.f);
+
+		for (u32 i = 0; i < PADDED_COUNT; i += 4)
+		{
+			auto nx = _mm_load_ps(&normal_xs[i]), ny = _mm_load_ps(&normal_ys[i]), nz = _mm_load_ps(&normal_zs[i]);
+
+			// signed distance of the center and the projected radius of the box onto the normal
+			auto distance = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(nx, cx), _mm_mul_ps(ny, cy)),
+				_mm_add_ps(_mm_mul_ps(nz, cz), _mm_load_ps(&distances[i]))
+			);
+			auto radius = _mm_add_ps(
+				_mm_add_ps(_mm_mul_ps(_mm_andnot_ps(sign_mask, nx), ex), _mm_mul_ps(_mm_andnot_ps(sign_mask, ny), ey)),
+				_mm_mul_ps(_mm_andnot_ps(sign_mask, nz), ez)
+			);
+
+			if (_mm_movemask_ps(_mm_cmplt_ps(_mm_add_ps(distance, radius), _mm_setzero_ps())) != 0)
+				return false;
+		}
+		return true;
+#else
+		for (u32 i = 0; i < COUNT; ++i)
+		{
+			auto normal = f32x3(normal_xs[i], normal_ys[i], normal_zs[i]);
+			auto distance = glm::dot(normal, center) + distances[i];
+			auto radius = glm::dot(glm::abs(normal), half_extent);
+			if (distance + radius < 0)
+				return false;
+		}
+		return true;
+#endif
+	}
+
+	bool intersects(Sphere const & sphere) const
+	{
+		if (sphere.is_empty())
+			return false;
+
+		for (u32 i = 0; i < COUNT; ++i)
+		{
+			auto normal = f32x3(normal_xs[i], normal_ys[i], normal_zs[i]);
+			if (glm::dot(normal, sphere.center) + distances[i] < -sphere.radius)
+				return false;
+		}
+		return true;
+	}
+};
+}
@@ -92,10 +92,25 @@ auto inline make_unique_array(size_t const size)
 
 // TODO(bekorn) move to core/containers
 #include "intrinsics.hpp"
+// frees through the resource the data is allocated from, nullptr means new[]
+struct ByteBufferDeleter
+{
+	std::pmr::memory_resource * resource = nullptr;
+	usize size = 0;
+
+	void operator()(byte * pointer) const
+	{
+		if (resource == nullptr)
+			delete[] pointer;
+		else
+			resource->deallocate(pointer, size, alignof(std::max_align_t));
+	}
+};
+
 // Simple byte buffer
 struct ByteBuffer
 {
-	unique_array<byte> data;
+	std::unique_ptr<byte[], ByteBufferDeleter> data;
 	usize size;
 
 	ByteBuffer() = default;
@@ -105,6 +120,11 @@ struct ByteBuffer
 		size(size)
 	{}
 
+	ByteBuffer(usize size, std::pmr::memory_resource & resource) :
+		data(static_cast<byte*>(resource.allocate(size, alignof(std::max_align_t))), ByteBufferDeleter{&resource, size}),
+		size(size)
+	{}
+
 	// move a pointer
 	ByteBuffer(void* && pointer, usize size) :
 		data(static_cast<byte*>(pointer)),
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <bit>
+
+// Indices marked since the last clear, a bit per index so marking one twice has no extra cost
+// for_each_range visits them as contiguous runs, so the users can update a range at once
+struct DirtySet
+{
+	vector<u64> words;
+	usize count = 0; // of the marked indices
+
+	void mark(u32 index)
+	{
+		auto const word_idx = index / 64;
+		if (word_idx >= words.size())
+			words.resize(word_idx + 1, 0);
+
+		auto const bit = u64(1) << (index % 64);
+		count += (words[word_idx] & bit) == 0;
+		words[word_idx] |= bit;
+	}
+
+	bool is_marked(u32 index) const
+	{
+		auto const word_idx = index / 64;
+		return word_idx < words.size() and (words[word_idx] >> (index % 64) & 1);
+	}
+
+	bool empty() const
+	{ return count == 0; }
+
+	usize size() const
+	{ return count; }
+
+	void clear()
+	{
+		std::ranges::fill(words, 0);
+		count = 0;
+	}
+
+	// f(u32 first, u32 count) in increasing order, two ranges are never adjacent
+	template<typename F>
+	void for_each_range(F && f) const
+	{
+		u32 range_first = 0, range_count = 0;
+		for (u32 word_idx = 0; word_idx < words.size(); ++word_idx)
+		{
+			auto word = words[word_idx];
+			u32 bit_idx = 0;
+			while (word != 0)
+			{
+				auto const zeros = u32(std::countr_zero(word));
+				word >>= zeros;
+				bit_idx += zeros;
+
+				auto const ones = u32(std::countr_one(word));
+				auto const first = word_idx * 64 + bit_idx;
+				if (range_count != 0 and range_first + range_count == first)
+					range_count += ones; // continues from the previous word
+				else
+				{
+					if (range_count != 0)
+						f(range_first, range_count);
+					range_first = first;
+					range_count = ones;
+				}
+
+				word = ones == 64 ? 0 : word >> ones;
+				bit_idx += ones;
+			}
+		}
+		if (range_count != 0)
+			f(range_first, range_count);
+	}
+};
@@ -0,0 +1,357 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define FlatMap_SSE2
+#endif
+
+// Open addressing hash map, SwissTable style (https://abseil.io/about/design/swisstables)
+// Slots are grouped by 16, a group of control bytes is probed at once (with SSE2 if available)
+// Control byte is either EMPTY, DELETED, or the lower 7 bits of the hash of a FULL slot
+// Unlike std::unordered_map, references are invalidated by insertion (on rehash)
+template<typename K, typename V, typename Hasher = std::hash<K>, typename KeyEqual = std::equal_to<K>>
+struct FlatMap
+{
+	using value_type = std::pair<K const, V>;
+
+	static constexpr usize GROUP_SIZE = 16;
+	static constexpr i8 EMPTY = -128;
+	static constexpr i8 DELETED = -2;
+
+	unique_array<i8> controls;
+	value_type * slots = nullptr;
+	usize capacity = 0; // multiple of GROUP_SIZE, group count is a power of 2
+	usize count = 0;
+	usize growth_left = 0; // EMPTY slots that can be filled before the load factor is exceeded
+
+	CTOR(FlatMap, default)
+
+	FlatMap(FlatMap const & other)
+	{
+		reserve(other.count);
+		for (auto & [key, value]: other)
+			try_emplace(key, value);
+	}
+
+	FlatMap & operator=(FlatMap const & other)
+	{
+		if (this != &other)
+			*this = FlatMap(other);
+		return *this;
+	}
+
+	FlatMap(FlatMap && other) noexcept :
+		controls(move(other.controls)),
+		slots(std::exchange(other.slots, nullptr)),
+		capacity(std::exchange(other.capacity, 0)),
+		count(std::exchange(other.count, 0)),
+		growth_left(std::exchange(other.growth_left, 0))
+	{}
+
+	FlatMap & operator=(FlatMap && other) noexcept
+	{
+		if (this != &other)
+		{
+			destroy();
+			controls = move(other.controls);
+			slots = std::exchange(other.slots, nullptr);
+			capacity = std::exchange(other.capacity, 0);
+			count = std::exchange(other.count, 0);
+			growth_left = std::exchange(other.growth_left, 0);
+		}
+		return *this;
+	}
+
+	~FlatMap()
+	{ destroy(); }
+
+	// Probing
+	static usize mix(usize hash)
+	{
+		// the hasher may be weak in the low bits (e.g. pointers), spread them with a multiplicative hash
+		return (hash * 0x9E3779B97F4A7C15ull) ^ (hash >> 32);
+	}
+
+	static i8 h2(usize hash)
+	{ return i8(hash & 0x7F); }
+
+	static usize h1(usize hash)
+	{ return hash >> 7; }
+
+	// bit i is set if controls[i] == control
+	static u32 match(i8 const * group, i8 control)
+	{
+#ifdef FlatMap_SSE2
+		auto const group_bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(group));
+		return u32(_mm_movemask_epi8(_mm_cmpeq_epi8(group_bytes, _mm_set1_epi8(control))));
+#else
+		u32 mask = 0;
+		for (u32 i = 0; i < GROUP_SIZE; ++i)
+			mask |= u32(group[i] == control) << i;
+		return mask;
+#endif
+	}
+
+	// bit i is set if controls[i] is EMPTY or DELETED
+	static u32 match_free(i8 const * group)
+	{
+#ifdef FlatMap_SSE2
+		auto const group_bytes = _mm_loadu_si128(reinterpret_cast<__m128i const *>(group));
+		return u32(_mm_movemask_epi8(group_bytes)); // sign bit is only set for EMPTY and DELETED
+#else
+		u32 mask = 0;
+		for (u32 i = 0; i < GROUP_SIZE; ++i)
+			mask |= u32(group[i] < 0) << i;
+		return mask;
+#endif
+	}
+
+	// visits groups in triangular order, which covers all of them when the group count is a power of 2
+	template<typename F>
+	void probe(usize hash, F && visit_group) const
+	{
+		auto const group_mask = capacity / GROUP_SIZE - 1;
+		auto group_idx = h1(hash) & group_mask;
+		for (usize step = 1; ; ++step)
+		{
+			if (visit_group(group_idx * GROUP_SIZE))
+				return;
+			group_idx = (group_idx + step) & group_mask;
+		}
+	}
+
+	usize find_index(K const & key) const
+	{
+		if (capacity == 0)
+			return capacity;
+
+		auto const hash = mix(Hasher{}(key));
+		auto const control = h2(hash);
+
+		usize result = capacity;
+		probe(hash, [&](usize group_begin)
+		{
+			auto const * group = controls.get() + group_begin;
+			for (auto mask = match(group, control); mask != 0; mask &= mask - 1)
+			{
+				auto const idx = group_begin + std::countr_zero(mask);
+				if (KeyEqual{}(slots[idx].first, key))
+					return result = idx, true;
+			}
+			// an EMPTY slot ends the probe sequence, the key would have been placed there
+			return match(group, EMPTY) != 0;
+		});
+		return result;
+	}
+
+	// assumes the key is not present and there is room
+	usize find_free_index(usize hash) const
+	{
+		usize result;
+		probe(hash, [&](usize group_begin)
+		{
+			auto const mask = match_free(controls.get() + group_begin);
+			if (mask == 0)
+				return false;
+			return result = group_begin + std::countr_zero(mask), true;
+		});
+		return result;
+	}
+
+	// Storage
+	void destroy()
+	{
+		if (slots == nullptr)
+			return;
+
+		for (usize i = 0; i < capacity; ++i)
+			if (controls[i] >= 0)
+				std::destroy_at(slots + i);
+		std::allocator<value_type>{}.deallocate(slots, capacity);
+
+		slots = nullptr;
+		controls = nullptr;
+		capacity = count = growth_left = 0;
+	}
+
+	void rehash(usize new_capacity)
+	{
+		assert(new_capacity % GROUP_SIZE == 0 and std::has_single_bit(new_capacity / GROUP_SIZE), "Invalid capacity");
+
+		auto old_controls = move(controls);
+		auto * old_slots = slots;
+		auto old_capacity = capacity;
+
+		controls = make_unique_array<i8>(new_capacity);
+		std::fill_n(controls.get(), new_capacity, EMPTY);
+		slots = std::allocator<value_type>{}.allocate(new_capacity);
+		capacity = new_capacity;
+		growth_left = new_capacity - new_capacity / 8 - count; // max load factor is 7/8
+
+		for (usize i = 0; i < old_capacity; ++i)
+			if (old_controls[i] >= 0)
+			{
+				auto const hash = mix(Hasher{}(old_slots[i].first));
+				auto const idx = find_free_index(hash);
+				controls[idx] = h2(hash);
+				std::construct_at(slots + idx, std::move(old_slots[i]));
+				std::destroy_at(old_slots + i);
+			}
+
+		if (old_slots != nullptr)
+			std::allocator<value_type>{}.deallocate(old_slots, old_capacity);
+	}
+
+	void reserve(usize new_count)
+	{
+		auto needed = std::bit_ceil((new_count + new_count / 7 + GROUP_SIZE - 1) / GROUP_SIZE) * GROUP_SIZE;
+		if (needed > capacity)
+			rehash(needed);
+	}
+
+	// Interface
+	template<typename... Args>
+	std::pair<value_type *, bool> try_emplace(K const & key, Args && ... args)
+	{
+		if (auto idx = find_index(key); idx != capacity)
+			return {slots + idx, false};
+
+		if (growth_left == 0)
+			// DELETED slots are dropped while rehashing, so only grow if the map is actually full
+			rehash(count + 1 > (capacity - capacity / 8) / 2 ? glm::max(capacity * 2, GROUP_SIZE) : capacity);
+
+		auto const hash = mix(Hasher{}(key));
+		auto const idx = find_free_index(hash);
+		if (controls[idx] == EMPTY)
+			growth_left--;
+		controls[idx] = h2(hash);
+		std::construct_at(
+			slots + idx,
+			std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::forward<Args>(args)...)
+		);
+		count++;
+
+		return {slots + idx, true};
+	}
+
+	bool erase(K const & key)
+	{
+		auto idx = find_index(key);
+		if (idx == capacity)
+			return false;
+
+		std::destroy_at(slots + idx);
+		// if the group still has an EMPTY slot, no probe sequence passes through it, so the slot can be reused freely
+		auto const group_begin = idx / GROUP_SIZE * GROUP_SIZE;
+		if (match(controls.get() + group_begin, EMPTY) != 0)
+			controls[idx] = EMPTY, growth_left++;
+		else
+			controls[idx] = DELETED;
+		count--;
+
+		return true;
+	}
+
+	void clear()
+	{
+		for (usize i = 0; i < capacity; ++i)
+			if (controls[i] >= 0)
+				std::destroy_at(slots + i);
+		std::fill_n(controls.get(), capacity, EMPTY);
+		count = 0;
+		growth_left = capacity - capacity / 8;
+	}
+
+	V & at(K const & key)
+	{
+		auto idx = find_index(key);
+		if (idx == capacity)
+			throw std::out_of_range("FlatMap::at");
+		return slots[idx].second;
+	}
+
+	V const & at(K const & key) const
+	{
+		auto idx = find_index(key);
+		if (idx == capacity)
+			throw std::out_of_range("FlatMap::at");
+		return slots[idx].second;
+	}
+
+	V & operator[](K const & key)
+	{ return try_emplace(key).first->second; }
+
+	bool contains(K const & key) const
+	{ return find_index(key) != capacity; }
+
+	usize size() const
+	{ return count; }
+
+	bool empty() const
+	{ return count == 0; }
+
+	// Iteration, visits the FULL slots in storage order
+	template<typename Value>
+	struct Iterator
+	{
+		i8 const * control;
+		i8 const * control_end;
+		Value * slot;
+
+		void skip_free()
+		{
+			while (control != control_end and *control < 0)
+				++control, ++slot;
+		}
+
+		Value & operator*() const
+		{ return *slot; }
+
+		Value * operator->() const
+		{ return slot; }
+
+		Iterator & operator++()
+		{
+			++control, ++slot;
+			skip_free();
+			return *this;
+		}
+
+		bool operator==(Iterator const & other) const
+		{ return control == other.control; }
+	};
+
+	template<typename Value>
+	Iterator<Value> make_iterator(usize idx) const
+	{ return {controls.get() + idx, controls.get() + capacity, slots + idx}; }
+
+	Iterator<value_type> begin()
+	{
+		auto it = make_iterator<value_type>(0);
+		it.skip_free();
+		return it;
+	}
+
+	Iterator<value_type> end()
+	{ return make_iterator<value_type>(capacity); }
+
+	Iterator<value_type const> begin() const
+	{
+		auto it = make_iterator<value_type const>(0);
+		it.skip_free();
+		return it;
+	}
+
+	Iterator<value_type const> end() const
+	{ return make_iterator<value_type const>(capacity); }
+
+	Iterator<value_type> find(K const & key)
+	{ return make_iterator<value_type>(find_index(key)); }
+
+	Iterator<value_type const> find(K const & key) const
+	{ return make_iterator<value_type const>(find_index(key)); }
+};
@@ -3,6 +3,7 @@
 #include <core/core.hpp>
 #include <core/intrinsics.hpp>
 #include <core/named.hpp>
+#include <core/bounds.hpp>
 
 namespace Geometry
 {
@@ -59,7 +60,7 @@ struct Type
 {
 	enum Value : u8
 	{
-		F32,
+		F32, F16,
 		I8, I16, I32, I8NORM, I16NORM, I32NORM,
 		U8, U16, U32, U8NORM, U16NORM, U32NORM,
 	};
@@ -77,6 +78,7 @@ struct Type
 		case U8:
 		case I8NORM:
 		case U8NORM: return 1;
+		case F16:
 		case I16:
 		case U16:
 		case I16NORM:
@@ -108,6 +110,7 @@ struct Type
 		case I16:
 		case U16:
 		case F32:
+		case F16:
 		case I32:
 		case U32: return false;
 		}
@@ -120,6 +123,7 @@ struct Type
 		switch (value)
 		{
 		case F32: return "F32";
+		case F16: return "F16";
 		case I8: return "I8";
 		case I16: return "I16";
 		case I32: return "I32";
@@ -151,6 +155,16 @@ struct Attribute
 
 	bool is_used() const
 	{ return type.dimension != 0; }
+
+	// normals in 2 normalized components, tangents in 3 (the handedness last), see quantize.hpp
+	bool is_octahedral() const
+	{
+		if (not holds_alternative<Key::Common>(key.name) or not type.is_normalized())
+			return false;
+
+		auto const common = get<Key::Common>(key.name);
+		return (common == Key::NORMAL and type.dimension == 2) or (common == Key::TANGENT and type.dimension == 3);
+	}
 };
 
 struct Layout
@@ -181,6 +195,30 @@ struct Primitive
 	const Geometry::Layout * layout;
 	Geometry::Data data;
 	vector<u32> indices;
+	Bounds bounds; // local space
+
+	// coarser index lists over the same vertices, in increasing error (see simplify.hpp)
+	struct Lod
+	{
+		vector<u32> indices;
+		f32 error; // object space distance the surface may deviate from the full detail one
+	};
+	vector<Lod> lods;
+
+	// clusters of the full detail triangles, meshlet i is indices[3 * first_triangle, 3 * (first_triangle + triangle_count))
+	// empty unless built (see meshlet.hpp), reordering the indices invalidates them
+	struct Meshlet
+	{
+		u32 first_triangle;
+		u8 triangle_count;
+		u8 vertex_count; // unique
+		Sphere sphere;
+		// every triangle normal is within the cone around the axis, cone_cutoff is the sine of its half angle
+		// 1 when the normals spread too much, such a meshlet is never backfacing
+		f32x3 cone_axis;
+		f32 cone_cutoff;
+	};
+	vector<Meshlet> meshlets;
 
 	CTOR(Primitive, default);
 	COPY(Primitive, delete);
@@ -192,6 +230,41 @@ struct Primitive
 		assert(idx < ATTRIBUTE_COUNT);
 		return data.buffers[idx];
 	}
+
+	// the coarsest one within the error, 0 is the full detail and i is lods[i - 1]
+	u32 select_lod(f32 max_error) const
+	{
+		u32 lod = 0;
+		while (lod < lods.size() and lods[lod].error <= max_error)
+			++lod;
+		return lod;
+	}
+
+	// layer 0 of a common F32x3 attribute (POSITION, NORMAL), empty without it
+	span<f32x3 const> find_f32x3(Key::Common key) const
+	{
+		for (auto i = 0; i < ATTRIBUTE_COUNT; ++i)
+		{
+			auto const & attribute = layout->attributes[i];
+			if (attribute.key == Key{key, 0} and attribute.type == Type{Type::F32, 3})
+				return data.buffers[i].span_as<f32x3 const>();
+		}
+		return {};
+	}
+
+	usize get_vertex_count() const
+	{
+		for (auto i = 0; i < ATTRIBUTE_COUNT; ++i)
+			if (layout->attributes[i].is_used())
+				return data.buffers[i].size / layout->attributes[i].type.vector_size();
+		return 0;
+	}
+
+	// from the F32x3 POSITION attribute, stays empty without it
+	void calculate_bounds()
+	{
+		bounds = Bounds::from_points(find_f32x3(Key::POSITION));
+	}
 };
 }
 
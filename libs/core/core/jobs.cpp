@@ -0,0 +1,305 @@
+#include "jobs.hpp"
+#include "profiler.hpp"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stop_token>
+#include <deque>
+#include <atomic>
+
+namespace Jobs
+{
+struct Task
+{
+	std::function<void()> work;
+	std::atomic<u32> unfinished_dependencies;
+
+	std::mutex mutex; // guards continuations and is_done transition
+	vector<Handle> continuations;
+	std::atomic<bool> is_done = false;
+	std::exception_ptr exception;
+};
+
+namespace
+{
+struct Worker
+{
+	std::mutex mutex;
+	std::deque<Handle> tasks;
+};
+
+struct Scheduler
+{
+	vector<unique_one<Worker>> workers; // last one is shared by the non-worker threads
+
+	std::atomic<u32> queued_count = 0;
+	std::mutex sleep_mutex;
+	std::condition_variable_any sleep_cv;
+
+	std::mutex main_mutex;
+	vector<std::function<void()>> main_queue;
+	std::thread::id main_thread_id;
+
+	// declared last, so the threads are stopped and joined before the rest is destroyed
+	vector<std::jthread> threads;
+
+	Scheduler()
+	{ workers.emplace_back(make_unique_one<Worker>()); }
+} scheduler;
+
+thread_local usize thread_worker_idx = std::numeric_limits<usize>::max();
+
+Worker & get_own_worker()
+{
+	if (thread_worker_idx < scheduler.workers.size() - 1)
+		return *scheduler.workers[thread_worker_idx];
+	return *scheduler.workers.back();
+}
+
+void enqueue(Handle task)
+{
+	auto & worker = get_own_worker();
+	{
+		std::lock_guard lock(worker.mutex);
+		worker.tasks.push_back(move(task));
+	}
+	scheduler.queued_count++;
+
+	{
+		std::lock_guard lock(scheduler.sleep_mutex);
+	}
+	scheduler.sleep_cv.notify_one();
+}
+
+Handle dequeue()
+{
+	if (scheduler.queued_count == 0)
+		return nullptr;
+
+	// own tasks first, newest one is likely to be hot in the cache
+	{
+		auto & worker = get_own_worker();
+		std::lock_guard lock(worker.mutex);
+		if (not worker.tasks.empty())
+		{
+			auto task = move(worker.tasks.back());
+			worker.tasks.pop_back();
+			scheduler.queued_count--;
+			return task;
+		}
+	}
+
+	// steal the oldest task of someone else
+	auto const worker_count = scheduler.workers.size();
+	auto const start = thread_worker_idx < worker_count ? thread_worker_idx + 1 : 0;
+	for (usize i = 0; i < worker_count; ++i)
+	{
+		auto & victim = *scheduler.workers[(start + i) % worker_count];
+		std::lock_guard lock(victim.mutex);
+		if (not victim.tasks.empty())
+		{
+			auto task = move(victim.tasks.front());
+			victim.tasks.pop_front();
+			scheduler.queued_count--;
+			return task;
+		}
+	}
+
+	return nullptr;
+}
+
+void execute(Handle const & task)
+{
+	try
+	{
+		task->work();
+	}
+	catch (...)
+	{
+		task->exception = std::current_exception();
+	}
+	task->work = nullptr;
+
+	vector<Handle> continuations;
+	{
+		std::lock_guard lock(task->mutex);
+		task->is_done = true;
+		continuations = move(task->continuations);
+	}
+
+	for (auto & continuation: continuations)
+		if (--continuation->unfinished_dependencies == 0)
+			enqueue(move(continuation));
+}
+
+bool try_execute_one()
+{
+	if (auto task = dequeue())
+	{
+		execute(task);
+		return true;
+	}
+	return false;
+}
+
+void worker_loop(std::stop_token const & stop_token, usize worker_idx)
+{
+	thread_worker_idx = worker_idx;
+	Profiler::set_thread_name(fmt::format("Worker {}", worker_idx));
+
+	while (not stop_token.stop_requested())
+	{
+		if (try_execute_one())
+			continue;
+
+		std::unique_lock lock(scheduler.sleep_mutex);
+		scheduler.sleep_cv.wait(lock, stop_token, []
+		{ return scheduler.queued_count != 0; });
+	}
+}
+}
+
+void init(Desc const & desc)
+{
+	assert(scheduler.threads.empty(), "Jobs are already initialized");
+
+	auto worker_count = desc.worker_count;
+	if (worker_count == 0)
+		worker_count = glm::max(std::thread::hardware_concurrency(), 2u) - 1;
+
+	scheduler.main_thread_id = std::this_thread::get_id();
+
+	scheduler.workers.clear();
+	for (u32 i = 0; i < worker_count + 1; ++i)
+		scheduler.workers.emplace_back(make_unique_one<Worker>());
+
+	for (u32 i = 0; i < worker_count; ++i)
+		scheduler.threads.emplace_back(worker_loop, i);
+}
+
+void shutdown()
+{
+	// jthreads request stop (which wakes them up) and join on destruction
+	scheduler.threads.clear();
+
+	// leftover tasks are run by the waiting threads, the shared worker is kept
+	while (try_execute_one());
+	scheduler.workers.resize(1);
+}
+
+u32 get_worker_count()
+{ return scheduler.threads.size(); }
+
+Handle submit(std::function<void()> work, span<Handle const> dependencies)
+{
+	auto task = std::make_shared<Task>();
+	task->work = move(work);
+	// +1 guards against the dependencies finishing while they are being registered
+	task->unfinished_dependencies = dependencies.size() + 1;
+
+	for (auto & dependency: dependencies)
+	{
+		std::lock_guard lock(dependency->mutex);
+		if (dependency->is_done)
+			task->unfinished_dependencies--;
+		else
+			dependency->continuations.push_back(task);
+	}
+
+	if (--task->unfinished_dependencies == 0)
+		enqueue(task);
+
+	return task;
+}
+
+bool is_done(Handle const & handle)
+{ return handle->is_done; }
+
+void wait(Handle const & handle)
+{
+	while (not handle->is_done)
+		if (not try_execute_one())
+			std::this_thread::yield();
+
+	if (handle->exception)
+		std::rethrow_exception(handle->exception);
+}
+
+void parallel_for(usize count, usize batch_size, std::function<void(usize begin, usize end)> const & work)
+{
+	assert(batch_size != 0, "Batch size must be positive");
+
+	auto const batch_count = (count + batch_size - 1) / batch_size;
+	if (batch_count <= 1 or scheduler.threads.empty())
+	{
+		if (count != 0)
+			work(0, count);
+		return;
+	}
+
+	// every task (and the caller) grabs the next batch until there are none left
+	std::atomic<usize> next_batch = 0;
+	auto const run_batches = [&]
+	{
+		for (auto batch = next_batch++; batch < batch_count; batch = next_batch++)
+			work(batch * batch_size, glm::min((batch + 1) * batch_size, count));
+	};
+
+	auto const task_count = glm::min(batch_count - 1, usize(scheduler.threads.size()));
+	vector<Handle> tasks;
+	tasks.reserve(task_count);
+	for (usize i = 0; i < task_count; ++i)
+		tasks.push_back(submit(run_batches));
+
+	std::exception_ptr exception;
+	try
+	{
+		run_batches();
+	}
+	catch (...)
+	{
+		exception = std::current_exception();
+		next_batch = batch_count; // stop the others early
+	}
+
+	for (auto & task: tasks)
+	{
+		try
+		{
+			wait(task);
+		}
+		catch (...)
+		{
+			if (not exception)
+				exception = std::current_exception();
+		}
+	}
+
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+void submit_to_main(std::function<void()> work)
+{
+	std::lock_guard lock(scheduler.main_mutex);
+	scheduler.main_queue.push_back(move(work));
+}
+
+void run_main_queue()
+{
+	assert(
+		scheduler.main_thread_id == std::thread::id() or scheduler.main_thread_id == std::this_thread::get_id(),
+		"Main queue must run on the main thread"
+	);
+
+	vector<std::function<void()>> queue;
+	{
+		std::lock_guard lock(scheduler.main_mutex);
+		queue.swap(scheduler.main_queue);
+	}
+
+	for (auto & work: queue)
+		work();
+}
+}
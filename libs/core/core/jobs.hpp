@@ -0,0 +1,37 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <functional>
+
+// Work stealing job system
+// every worker owns a deque, pops its own tasks from the back and steals others' from the front
+// threads that wait for a task (including the main thread) run the queued tasks meanwhile
+// if it is not initialized, tasks run on the waiting thread, so the same code works single threaded
+namespace Jobs
+{
+struct Task;
+using Handle = std::shared_ptr<Task>;
+
+struct Desc
+{
+	u32 worker_count = 0; // 0 means hardware_concurrency - 1 (the main thread also works while waiting)
+};
+
+void init(Desc const & desc);
+void shutdown();
+u32 get_worker_count();
+
+// a task starts after all of its dependencies are done, which also makes it their continuation
+Handle submit(std::function<void()> work, span<Handle const> dependencies = {});
+bool is_done(Handle const & handle);
+// rethrows if the task has thrown
+void wait(Handle const & handle);
+
+// calls work(begin, end) for the batches of [0, count), blocks until all are done
+void parallel_for(usize count, usize batch_size, std::function<void(usize begin, usize end)> const & work);
+
+// for the work that has to run on the main thread (e.g. GL calls), executed by run_main_queue
+void submit_to_main(std::function<void()> work);
+void run_main_queue();
+}
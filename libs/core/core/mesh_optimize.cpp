@@ -0,0 +1,385 @@
+#include "mesh_optimize.hpp"
+#include "profiler.hpp"
+
+namespace Geometry
+{
+namespace
+{
+u32 constexpr NONE = std::numeric_limits<u32>::max();
+
+// a vertex stays for cache_size misses after its own
+struct FifoCache
+{
+	vector<u32> insert_times;
+	u32 time;
+	u32 size;
+
+	void init(usize vertex_count, u32 cache_size)
+	{
+		size = cache_size;
+		time = size + 1;
+		insert_times.assign(vertex_count, 0);
+	}
+
+	// true on a miss
+	bool access(u32 vertex)
+	{
+		if (time - insert_times[vertex] <= size)
+			return false;
+
+		insert_times[vertex] = time++;
+		return true;
+	}
+
+	u32 access_triangle(u32 const * triangle)
+	{ return access(triangle[0]) + access(triangle[1]) + access(triangle[2]); }
+
+	void clear()
+	{ time += size + 1; }
+};
+}
+
+VertexCacheStats analyze_vertex_cache(span<u32 const> indices, usize vertex_count, u32 cache_size)
+{
+	FifoCache cache;
+	cache.init(vertex_count, cache_size);
+	vector<bool> is_referenced(vertex_count, false);
+
+	usize miss_count = 0, referenced_count = 0;
+	for (auto index: indices)
+	{
+		miss_count += cache.access(index);
+		referenced_count += not is_referenced[index];
+		is_referenced[index] = true;
+	}
+
+	auto const triangle_count = indices.size() / 3;
+	return {
+		.acmr = triangle_count == 0 ? 0 : f32(miss_count) / f32(triangle_count),
+		.atvr = referenced_count == 0 ? 0 : f32(miss_count) / f32(referenced_count),
+	};
+}
+
+void optimize_vertex_cache(span<u32> indices, usize vertex_count, u32 cache_size)
+{
+	PROFILE_ZONE("Geometry::optimize_vertex_cache");
+
+	assert(indices.size() % 3 == 0, "Indices must be a triangle list");
+	auto const triangle_count = indices.size() / 3;
+	if (triangle_count == 0)
+		return;
+
+	// triangles around each vertex
+	vector<u32> triangle_offsets(vertex_count + 1, 0);
+	for (auto index: indices)
+		triangle_offsets[index + 1]++;
+	for (usize i = 0; i < vertex_count; ++i)
+		triangle_offsets[i + 1] += triangle_offsets[i];
+	vector<u32> vertex_triangles(indices.size());
+	{
+		auto offsets = triangle_offsets;
+		for (usize i = 0; i < indices.size(); ++i)
+			vertex_triangles[offsets[indices[i]]++] = u32(i / 3);
+	}
+
+	vector<u32> live_counts(vertex_count); // of the triangles not emitted yet
+	for (usize i = 0; i < vertex_count; ++i)
+		live_counts[i] = triangle_offsets[i + 1] - triangle_offsets[i];
+
+	vector<u32> cache_times(vertex_count, 0);
+	u32 time = cache_size + 1;
+	vector<bool> is_emitted(triangle_count, false);
+
+	vector<u32> dead_ends; // recently used vertices, to continue from when the fan has no good candidate
+	vector<u32> candidates;
+	u32 cursor = 0; // in vertex order, after the dead ends run out
+	auto const skip_dead_end = [&]() -> u32
+	{
+		while (not dead_ends.empty())
+		{
+			auto const vertex = dead_ends.back();
+			dead_ends.pop_back();
+			if (live_counts[vertex] > 0)
+				return vertex;
+		}
+		for (; cursor < vertex_count; ++cursor)
+			if (live_counts[cursor] > 0)
+				return cursor;
+		return NONE;
+	};
+
+	vector<u32> result;
+	result.reserve(indices.size());
+	for (auto fanning = skip_dead_end(); fanning != NONE;)
+	{
+		// every remaining triangle around the fanning vertex
+		candidates.clear();
+		for (auto k = triangle_offsets[fanning]; k < triangle_offsets[fanning + 1]; ++k)
+		{
+			auto const triangle = vertex_triangles[k];
+			if (is_emitted[triangle])
+				continue;
+
+			for (auto i = 0; i < 3; ++i)
+			{
+				auto const vertex = indices[triangle * 3 + i];
+				result.push_back(vertex);
+				dead_ends.push_back(vertex);
+				candidates.push_back(vertex);
+				live_counts[vertex]--;
+				if (time - cache_times[vertex] > cache_size)
+					cache_times[vertex] = time++;
+			}
+			is_emitted[triangle] = true;
+		}
+
+		// the candidate that would still be in the cache after its own fan, the oldest such one
+		auto next = NONE;
+		i64 best_priority = -1;
+		for (auto vertex: candidates)
+		{
+			if (live_counts[vertex] == 0)
+				continue;
+
+			i64 priority = 0;
+			if (time - cache_times[vertex] + 2 * live_counts[vertex] <= cache_size)
+				priority = time - cache_times[vertex];
+			if (priority > best_priority)
+				best_priority = priority, next = vertex;
+		}
+
+		fanning = next != NONE ? next : skip_dead_end();
+	}
+
+	std::ranges::copy(result, indices.begin());
+}
+
+void optimize_overdraw(span<u32> indices, span<f32x3 const> positions, f32 threshold, u32 cache_size)
+{
+	PROFILE_ZONE("Geometry::optimize_overdraw");
+
+	auto const triangle_count = indices.size() / 3;
+	if (triangle_count < 2 or positions.empty())
+		return;
+
+	// hard boundaries, where the cache starts over (all 3 vertices miss) so moving the cluster costs nothing
+	FifoCache cache;
+	cache.init(positions.size(), cache_size);
+	vector<u32> hard_clusters; // first triangles
+	vector<u8> triangle_misses(triangle_count);
+	for (usize t = 0; t < triangle_count; ++t)
+	{
+		triangle_misses[t] = u8(cache.access_triangle(indices.data() + t * 3));
+		if (t == 0 or triangle_misses[t] == 3)
+			hard_clusters.push_back(u32(t));
+	}
+	hard_clusters.push_back(u32(triangle_count));
+
+	// soft boundaries, a cluster is split once its first part alone is within the threshold of its acmr
+	vector<u32> clusters;
+	for (usize c = 0; c + 1 < hard_clusters.size(); ++c)
+	{
+		auto const begin = hard_clusters[c], end = hard_clusters[c + 1];
+
+		u32 cluster_misses = 0;
+		for (auto t = begin; t < end; ++t)
+			cluster_misses += triangle_misses[t];
+		auto const cluster_acmr = f32(cluster_misses) / f32(end - begin);
+
+		cache.clear();
+		clusters.push_back(begin);
+		u32 part_begin = begin, part_misses = 0;
+		for (auto t = begin; t < end; ++t)
+		{
+			part_misses += cache.access_triangle(indices.data() + t * 3);
+			if (t + 1 < end and f32(part_misses) <= threshold * cluster_acmr * f32(t + 1 - part_begin))
+			{
+				clusters.push_back(t + 1);
+				part_begin = t + 1, part_misses = 0;
+				cache.clear();
+			}
+		}
+	}
+	clusters.push_back(u32(triangle_count));
+	auto const cluster_count = clusters.size() - 1;
+
+	// area weighted centroids and normals
+	struct ClusterInfo
+	{
+		f32x3 centroid;
+		f32x3 normal;
+		f32 area;
+	};
+	vector<ClusterInfo> infos(cluster_count);
+	f32x3 mesh_centroid(0);
+	f32 mesh_area = 0;
+	for (usize c = 0; c < cluster_count; ++c)
+	{
+		ClusterInfo info{.centroid = f32x3(0), .normal = f32x3(0), .area = 0};
+		for (auto t = clusters[c]; t < clusters[c + 1]; ++t)
+		{
+			auto const & p0 = positions[indices[t * 3 + 0]];
+			auto const & p1 = positions[indices[t * 3 + 1]];
+			auto const & p2 = positions[indices[t * 3 + 2]];
+			auto const cross = glm::cross(p1 - p0, p2 - p0);
+			auto const area = glm::length(cross);
+
+			info.centroid += (p0 + p1 + p2) * (area / 3);
+			info.normal += cross;
+			info.area += area;
+		}
+		mesh_centroid += info.centroid;
+		mesh_area += info.area;
+		infos[c] = info;
+	}
+	if (mesh_area == 0)
+		return;
+	mesh_centroid /= mesh_area;
+
+	// clusters facing away from the center occlude the rest more likely, they go first
+	vector<f32> sort_keys(cluster_count);
+	for (usize c = 0; c < cluster_count; ++c)
+	{
+		auto const & info = infos[c];
+		auto const normal_length = glm::length(info.normal);
+		if (info.area == 0 or normal_length == 0)
+			sort_keys[c] = 0;
+		else
+			sort_keys[c] = glm::dot(info.centroid / info.area - mesh_centroid, info.normal / normal_length);
+	}
+
+	vector<u32> order(cluster_count);
+	for (u32 c = 0; c < cluster_count; ++c)
+		order[c] = c;
+	std::ranges::stable_sort(order, [&](u32 l, u32 r) { return sort_keys[l] > sort_keys[r]; });
+
+	vector<u32> result;
+	result.reserve(indices.size());
+	for (auto c: order)
+		result.insert(result.end(), indices.begin() + clusters[c] * 3, indices.begin() + clusters[c + 1] * 3);
+	std::ranges::copy(result, indices.begin());
+}
+
+void weld_vertices(Primitive & primitive)
+{
+	PROFILE_ZONE("Geometry::weld_vertices");
+
+	auto const vertex_count = primitive.get_vertex_count();
+
+	vector<span<byte const>> attributes; // a vertex is attribute.subspan(vertex * stride, stride)
+	vector<u32> strides;
+	for (auto i = 0; i < ATTRIBUTE_COUNT; ++i)
+		if (auto const & attribute = primitive.layout->attributes[i]; attribute.is_used())
+		{
+			auto const & buffer = primitive.data.buffers[i];
+			attributes.emplace_back(buffer.begin(), buffer.size);
+			strides.push_back(attribute.type.vector_size());
+		}
+
+	auto const is_equal = [&](u32 l, u32 r)
+	{
+		for (usize a = 0; a < attributes.size(); ++a)
+			if (std::memcmp(attributes[a].data() + l * strides[a], attributes[a].data() + r * strides[a], strides[a]) != 0)
+				return false;
+		return true;
+	};
+
+	// FNV-1a of the bytes, equal vertices end up next to each other when sorted by (hash, index)
+	vector<u64> hashes(vertex_count);
+	for (usize vertex = 0; vertex < vertex_count; ++vertex)
+	{
+		u64 hash = 14695981039346656037ull;
+		for (usize a = 0; a < attributes.size(); ++a)
+			for (auto b: attributes[a].subspan(vertex * strides[a], strides[a]))
+				hash = (hash ^ u64(b)) * 1099511628211ull;
+		hashes[vertex] = hash;
+	}
+
+	vector<u32> order(vertex_count);
+	for (u32 vertex = 0; vertex < vertex_count; ++vertex)
+		order[vertex] = vertex;
+	std::ranges::sort(order, [&](u32 l, u32 r) { return std::tie(hashes[l], l) < std::tie(hashes[r], r); });
+
+	// the first of each equal run is kept, runs of the same hash are tiny so they are compared pairwise
+	vector<u32> remap(vertex_count);
+	for (usize begin = 0; begin < vertex_count;)
+	{
+		auto end = begin + 1;
+		while (end < vertex_count and hashes[order[end]] == hashes[order[begin]])
+			++end;
+
+		for (auto i = begin; i < end; ++i)
+		{
+			remap[order[i]] = order[i];
+			for (auto j = begin; j < i; ++j)
+				if (remap[order[j]] == order[j] and is_equal(order[i], order[j]))
+				{
+					remap[order[i]] = order[j];
+					break;
+				}
+		}
+		begin = end;
+	}
+
+	for (auto & index: primitive.indices)
+		index = remap[index];
+	for (auto & lod: primitive.lods)
+		for (auto & index: lod.indices)
+			index = remap[index];
+}
+
+void optimize_vertex_fetch(Primitive & primitive)
+{
+	PROFILE_ZONE("Geometry::optimize_vertex_fetch");
+
+	auto const vertex_count = primitive.get_vertex_count();
+
+	vector<u32> remap(vertex_count, NONE);
+	u32 new_vertex_count = 0;
+	auto const remap_indices = [&](vector<u32> & indices)
+	{
+		for (auto & index: indices)
+		{
+			auto & new_index = remap[index];
+			if (new_index == NONE)
+				new_index = new_vertex_count++;
+			index = new_index;
+		}
+	};
+	remap_indices(primitive.indices);
+	for (auto & lod: primitive.lods)
+		remap_indices(lod.indices);
+
+	for (auto i = 0; i < ATTRIBUTE_COUNT; ++i)
+	{
+		auto const & attribute = primitive.layout->attributes[i];
+		if (not attribute.is_used())
+			continue;
+
+		auto const stride = attribute.type.vector_size();
+		auto const & source = primitive.data.buffers[i];
+		ByteBuffer buffer(stride * new_vertex_count);
+		for (usize vertex = 0; vertex < vertex_count; ++vertex)
+			if (remap[vertex] != NONE)
+				std::memcpy(buffer.begin() + remap[vertex] * stride, source.begin() + vertex * stride, stride);
+		primitive.data.buffers[i] = move(buffer);
+	}
+
+	if (new_vertex_count != vertex_count)
+		primitive.calculate_bounds();
+}
+
+void optimize(Primitive & primitive)
+{
+	PROFILE_ZONE("Geometry::optimize");
+
+	auto const vertex_count = primitive.get_vertex_count();
+
+	optimize_vertex_cache(primitive.indices, vertex_count);
+	optimize_overdraw(primitive.indices, primitive.find_f32x3(Key::POSITION));
+	for (auto & lod: primitive.lods)
+		optimize_vertex_cache(lod.indices, vertex_count);
+
+	optimize_vertex_fetch(primitive);
+}
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+
+// Reorders the triangles and vertices of indexed triangle lists for the gpu, the rendered surface does not change
+//  vertex cache: Tipsify, Sander et al. Fast Triangle Reordering for Vertex Locality and Reduced Overdraw (2007)
+//  overdraw: the same paper's view independent clusters, the ones facing out from the center are drawn first
+//  vertex fetch: vertices in the order of their first use, so the fetches walk the buffers forward
+// All deterministic and single threaded
+namespace Geometry
+{
+u32 constexpr VERTEX_CACHE_SIZE = 16;
+
+// of a fifo cache, acmr: misses per triangle [0.5, 3], atvr: misses per referenced vertex [1, 3]
+struct VertexCacheStats
+{
+	f32 acmr;
+	f32 atvr;
+};
+VertexCacheStats analyze_vertex_cache(span<u32 const> indices, usize vertex_count, u32 cache_size = VERTEX_CACHE_SIZE);
+
+void optimize_vertex_cache(span<u32> indices, usize vertex_count, u32 cache_size = VERTEX_CACHE_SIZE);
+
+// expects cache optimized indices, a cluster is split until its acmr is within threshold times the original
+void optimize_overdraw(
+	span<u32> indices, span<f32x3 const> positions, f32 threshold = 1.05, u32 cache_size = VERTEX_CACHE_SIZE
+);
+
+// points the indices of vertices equal in every attribute to the first one, non indexed primitives need this to reuse anything
+// the vertex buffers stay as they are until optimize_vertex_fetch drops the unreferenced ones
+void weld_vertices(Primitive & primitive);
+
+// remaps the indices and the lods, unreferenced vertices are dropped
+void optimize_vertex_fetch(Primitive & primitive);
+
+// cache, overdraw then fetch, lods are only cache optimized (their order follows the full detail one anyway)
+void optimize(Primitive & primitive);
+}
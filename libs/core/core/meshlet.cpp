@@ -0,0 +1,185 @@
+#include "meshlet.hpp"
+#include "profiler.hpp"
+
+namespace Geometry
+{
+namespace
+{
+u32 constexpr NONE = std::numeric_limits<u32>::max();
+
+Primitive::Meshlet make_meshlet(
+	span<u32 const> triangle_indices, span<u32 const> vertices, span<f32x3 const> positions, u32 first_triangle
+)
+{
+	Primitive::Meshlet meshlet{
+		.first_triangle = first_triangle,
+		.triangle_count = u8(triangle_indices.size() / 3),
+		.vertex_count = u8(vertices.size()),
+		.sphere = {},
+		.cone_axis = f32x3(0, 0, 1),
+		.cone_cutoff = 1,
+	};
+
+	// centered at the box, like Bounds::from_points
+	AABB box;
+	for (auto vertex: vertices)
+		box.expand(positions[vertex]);
+	meshlet.sphere.center = box.center();
+	f32 max_distance_squared = 0;
+	for (auto vertex: vertices)
+	{
+		auto const offset = positions[vertex] - meshlet.sphere.center;
+		max_distance_squared = glm::max(max_distance_squared, glm::dot(offset, offset));
+	}
+	meshlet.sphere.radius = glm::sqrt(max_distance_squared);
+
+	// the axis is the average of the unit normals, degenerate triangles face nowhere so they are skipped
+	f32x3 normal_sum(0);
+	for (usize i = 0; i < triangle_indices.size(); i += 3)
+	{
+		auto const & p0 = positions[triangle_indices[i + 0]];
+		auto const normal = glm::cross(positions[triangle_indices[i + 1]] - p0, positions[triangle_indices[i + 2]] - p0);
+		if (auto const length = glm::length(normal); length > 0)
+			normal_sum += normal / length;
+	}
+
+	auto const sum_length = glm::length(normal_sum);
+	if (sum_length == 0)
+		return meshlet;
+	auto const axis = normal_sum / sum_length;
+
+	f32 min_dot = 1;
+	for (usize i = 0; i < triangle_indices.size(); i += 3)
+	{
+		auto const & p0 = positions[triangle_indices[i + 0]];
+		auto const normal = glm::cross(positions[triangle_indices[i + 1]] - p0, positions[triangle_indices[i + 2]] - p0);
+		if (auto const length = glm::length(normal); length > 0)
+			min_dot = glm::min(min_dot, glm::dot(axis, normal / length));
+	}
+
+	meshlet.cone_axis = axis;
+	if (min_dot > 0) // otherwise the cone is wider than a half space
+		meshlet.cone_cutoff = glm::sqrt(1 - min_dot * min_dot);
+	return meshlet;
+}
+}
+
+void build_meshlets(Primitive & primitive, u32 max_vertices, u32 max_triangles)
+{
+	PROFILE_ZONE("Geometry::build_meshlets");
+
+	assert(3 <= max_vertices and max_vertices <= 255, "Meshlet vertex count is stored in 8 bits");
+	assert(1 <= max_triangles and max_triangles <= 255, "Meshlet triangle count is stored in 8 bits");
+
+	auto const positions = primitive.find_f32x3(Key::POSITION);
+	assert(not positions.empty(), "Meshlets need F32x3 positions");
+
+	auto & indices = primitive.indices;
+	assert(indices.size() % 3 == 0, "Indices must be a triangle list");
+	auto const triangle_count = indices.size() / 3;
+	auto const vertex_count = positions.size();
+
+	primitive.meshlets.clear();
+	if (triangle_count == 0)
+		return;
+
+	// triangles around each vertex
+	vector<u32> triangle_offsets(vertex_count + 1, 0);
+	for (auto index: indices)
+		triangle_offsets[index + 1]++;
+	for (usize i = 0; i < vertex_count; ++i)
+		triangle_offsets[i + 1] += triangle_offsets[i];
+	vector<u32> vertex_triangles(indices.size());
+	{
+		auto offsets = triangle_offsets;
+		for (usize i = 0; i < indices.size(); ++i)
+			vertex_triangles[offsets[indices[i]]++] = u32(i / 3);
+	}
+
+	vector<u32> live_counts(vertex_count); // of the triangles not emitted yet
+	for (usize i = 0; i < vertex_count; ++i)
+		live_counts[i] = triangle_offsets[i + 1] - triangle_offsets[i];
+
+	vector<bool> is_emitted(triangle_count, false);
+	vector<u32> meshlet_indices(vertex_count, NONE); // of the meshlet a vertex was last added to
+	vector<u32> meshlet_vertices;
+	meshlet_vertices.reserve(max_vertices);
+
+	// the triangles touching the current meshlet, with how many of their corners are in it
+	vector<u8> corner_counts(triangle_count, 0);
+	vector<u32> candidates;
+
+	vector<u32> result;
+	result.reserve(indices.size());
+	u32 first_triangle = 0; // of the current meshlet, in result
+	u32 cursor = 0; // in the index order, for when nothing is adjacent
+
+	auto const flush = [&]()
+	{
+		auto const triangle_indices = span(result).subspan(first_triangle * 3);
+		primitive.meshlets.push_back(make_meshlet(triangle_indices, meshlet_vertices, positions, first_triangle));
+		meshlet_vertices.clear();
+		for (auto triangle: candidates)
+			corner_counts[triangle] = 0;
+		candidates.clear();
+		first_triangle = u32(result.size() / 3);
+	};
+
+	while (true)
+	{
+		// the adjacent triangle that adds the fewest vertices, the first in the index order on ties
+		u32 best = NONE, best_new_count = 4;
+		{
+			usize kept = 0;
+			for (auto triangle: candidates)
+			{
+				if (is_emitted[triangle])
+					continue;
+				candidates[kept++] = triangle;
+
+				auto const new_count = 3u - corner_counts[triangle];
+				if (new_count < best_new_count or (new_count == best_new_count and triangle < best))
+					best = triangle, best_new_count = new_count;
+			}
+			candidates.resize(kept);
+		}
+
+		if (best == NONE)
+		{
+			while (cursor < triangle_count and is_emitted[cursor])
+				++cursor;
+			if (cursor == triangle_count)
+				break;
+			best = cursor, best_new_count = 3 - corner_counts[cursor];
+		}
+
+		// the candidate starts the next meshlet, which stays next to this one
+		if (meshlet_vertices.size() + best_new_count > max_vertices or result.size() / 3 - first_triangle == max_triangles)
+			flush();
+
+		is_emitted[best] = true;
+		auto const meshlet_index = u32(primitive.meshlets.size());
+		for (auto c = 0; c < 3; ++c)
+		{
+			auto const vertex = indices[best * 3 + c];
+			result.push_back(vertex);
+			if (meshlet_indices[vertex] == meshlet_index)
+				continue;
+
+			meshlet_indices[vertex] = meshlet_index;
+			meshlet_vertices.push_back(vertex);
+			for (auto k = triangle_offsets[vertex]; k < triangle_offsets[vertex + 1]; ++k)
+			{
+				auto const triangle = vertex_triangles[k];
+				if (is_emitted[triangle])
+					continue;
+				if (corner_counts[triangle]++ == 0)
+					candidates.push_back(triangle);
+			}
+		}
+	}
+	flush();
+
+	indices = move(result);
+}
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+
+// Splits the full detail triangles of a primitive into meshlets (see Primitive::Meshlet), small clusters that are culled
+// on their own with a bounding sphere and a normal cone
+// Greedy, a meshlet grows by the adjacent triangle that adds the fewest vertices, the first in the index order on ties
+// so the cache optimized order is mostly kept. Deterministic and single threaded
+namespace Geometry
+{
+// fits a mesh shader workgroup, 124 triangles of 8 bit local indices are 372 bytes, a multiple of 4
+u32 constexpr MESHLET_MAX_VERTICES = 64;
+u32 constexpr MESHLET_MAX_TRIANGLES = 124;
+
+// reorders the indices meshlet by meshlet, needs the F32x3 positions so it runs before the quantization
+void build_meshlets(
+	Primitive & primitive, u32 max_vertices = MESHLET_MAX_VERTICES, u32 max_triangles = MESHLET_MAX_TRIANGLES
+);
+
+// in the object space of the meshlet, eye is the camera position with w = 1,
+// or for orthographic projections the direction towards the camera with w = 0
+// an affine transform keeps which side of a triangle a point is on, so any node matrix can be inverted into eye
+inline bool is_backfacing(Primitive::Meshlet const & meshlet, f32x4 const & eye)
+{
+	if (meshlet.cone_cutoff >= 1)
+		return false;
+
+	if (eye.w == 0)
+		return glm::dot(-glm::normalize(f32x3(eye)), meshlet.cone_axis) >= meshlet.cone_cutoff;
+
+	// the cone widened by the angle the sphere covers, sin(a + b) <= sin(a) + sin(b)
+	auto const to_center = meshlet.sphere.center - f32x3(eye);
+	return glm::dot(to_center, meshlet.cone_axis) >= meshlet.cone_cutoff * glm::length(to_center) + meshlet.sphere.radius;
+}
+}
@@ -0,0 +1,63 @@
+#include "named.hpp"
+#include "flat_map.hpp"
+
+#include <shared_mutex>
+
+namespace
+{
+struct InternTable
+{
+	std::shared_mutex mutex;
+	// std::unordered_map is node based, returned string_views stay valid when it grows
+	std::unordered_map<u64, std::string> strings{{Name::hash_of(""), ""}};
+
+	static InternTable & get()
+	{
+		static InternTable table;
+		return table;
+	}
+};
+
+// keys are already hashes
+struct IdentityHasher
+{
+	usize operator()(u64 hash) const
+	{ return hash; }
+};
+
+// strings this thread has already seen, so the lookups after the first one do not touch the shared mutex
+FlatMap<u64, std::string_view, IdentityHasher> & get_thread_cache()
+{
+	thread_local FlatMap<u64, std::string_view, IdentityHasher> cache;
+	return cache;
+}
+}
+
+void Name::intern(u64 hash, std::string_view const & sv)
+{
+	auto & cache = get_thread_cache();
+	if (auto it = cache.find(hash); it != cache.end())
+	{
+		assert(it->second == sv, "Name hash collision");
+		return;
+	}
+
+	auto & table = InternTable::get();
+	std::unique_lock lock(table.mutex);
+	auto const it = table.strings.try_emplace(hash, sv).first;
+	assert(it->second == sv, "Name hash collision");
+	cache.try_emplace(hash, it->second);
+}
+
+std::string_view Name::string() const
+{
+	auto & cache = get_thread_cache();
+	if (auto it = cache.find(hash); it != cache.end())
+		return it->second;
+
+	auto & table = InternTable::get();
+	std::shared_lock lock(table.mutex);
+	if (auto it = table.strings.find(hash); it != table.strings.end())
+		return cache.try_emplace(hash, it->second).first->second;
+	return "";
+}
@@ -3,28 +3,53 @@
 #include "core.hpp"
 
 // inspired by https://github.com/skypjack/entt/blob/master/src/entt/core/hashed_string.hpp
-// TODO(bekorn): Name.string should only be present when Editing, Game should not care about human readability
+// Name is only the hash, the strings live in a process-wide intern table (see named.cpp)
+// TODO(bekorn): the intern table should only be filled when Editing, Game should not care about human readability
 struct Name
 {
-	usize hash;
-	std::string string;
+	u64 hash;
 
-	CTOR(Name, default)
+	// FNV-1a (http://www.isthe.com/chongo/tech/comp/fnv/index.html), unlike std::hash it is stable between runs
+	static constexpr u64 hash_of(std::string_view const & sv)
+	{
+		u64 hash = 0xcbf29ce484222325;
+		for (char c: sv)
+			hash = (hash ^ u64(u8(c))) * 0x100000001b3;
+		return hash;
+	}
+
+	// for hashes that are already interned (see operator ""_name)
+	static constexpr Name from_hash(u64 hash)
+	{
+		Name name;
+		name.hash = hash;
+		return name;
+	}
+
+	// keeps a single copy of the string for each hash, thread-safe
+	static void intern(u64 hash, std::string_view const & sv);
+
+	constexpr Name() noexcept :
+		hash(hash_of(""))
+	{}
 	COPY(Name, default)
 	MOVE(Name, default)
 
 	Name(std::string_view const & sv) :
-		hash(std::hash<std::string_view>{}(sv)), string(sv)
-	{}
+		hash(hash_of(sv))
+	{ intern(hash, sv); }
 
 	Name(std::string const & str) :
-		hash(std::hash<std::string>{}(str)), string(str)
+		Name(std::string_view(str))
 	{}
 
 	Name(const char * cp) :
 		Name(std::string_view(cp))
 	{}
 
+	// null-terminated, stays valid until the program ends
+	std::string_view string() const;
+
 	bool operator==(Name const & other) const
 	{ return hash == other.hash; }
 
@@ -35,9 +60,23 @@ struct Name
 	};
 };
 
-inline Name operator ""_name(char const * literal, usize size)
+template<usize N>
+struct NameLiteral
+{
+	char string[N];
+	u64 hash;
+
+	consteval NameLiteral(char const (& literal)[N]) :
+		string(), hash(Name::hash_of(std::string_view(literal, N - 1)))
+	{ std::copy_n(literal, N, string); }
+};
+
+// hash is calculated at compile time, the string is interned once per literal
+template<NameLiteral literal>
+Name operator ""_name()
 {
-	return std::string_view(literal, size);
+	[[maybe_unused]] static bool const is_interned = (Name::intern(literal.hash, std::string_view(literal.string, sizeof(literal.string) - 1)), true);
+	return Name::from_hash(literal.hash);
 }
 
 template<>
@@ -48,7 +87,7 @@ struct fmt::formatter<Name>
 
 	template<typename FormatContext>
 	auto format(Name name, FormatContext & ctx) const
-	{ return fmt::format_to(ctx.out(), "{:>16X}|{}", name.hash, name.string); }
+	{ return fmt::format_to(ctx.out(), "{:>16X}|{}", name.hash, name.string()); }
 };
 
 template<typename T>
@@ -114,4 +153,191 @@ struct Managed
 
 	auto end() const
 	{ return resources.end(); }
-};
\ No newline at end of file
+};
+// index into a DenseManaged slot, generation invalidates it after the resource is erased
+template<typename T>
+struct Handle
+{
+	static constexpr u32 NULL_INDEX = std::numeric_limits<u32>::max();
+
+	u32 index = NULL_INDEX;
+	u32 generation = 0;
+
+	bool is_null() const
+	{ return index == NULL_INDEX; }
+
+	bool operator==(Handle const & other) const = default;
+};
+
+// Resources are packed into a contiguous array, handles stay valid across erase (swap and pop)
+// Name lookup is a hash probe, intended for editor and load time. Runtime code should keep handles.
+// Unlike Managed, references are invalidated by generate and erase
+template<typename T>
+struct DenseManaged
+{
+	// structure of arrays, iterating the datas should not touch the names
+	vector<T> datas;
+	vector<Name> names;
+	vector<u32> dense2slot;
+
+	struct Slot
+	{
+		u32 dense_index;
+		u32 generation;
+	};
+	vector<Slot> slots;
+	vector<u32> free_slots;
+
+	std::unordered_map<Name, Handle<T>, Name::Hasher> name2handle;
+
+	template<typename... Args>
+	Named<T> generate(Name const & name, Args && ... args)
+	{
+		auto [it, is_emplaced] = name2handle.try_emplace(name);
+		if (not is_emplaced)
+		{
+			fmt::print(stderr, "!! Resource is not emplaced: {}\n", name);
+			auto dense_index = slots[it->second.index].dense_index;
+			return {names[dense_index], datas[dense_index]};
+		}
+
+		u32 slot_index;
+		if (free_slots.empty())
+		{
+			slot_index = slots.size();
+			slots.push_back({.dense_index = 0, .generation = 0});
+		}
+		else
+		{
+			slot_index = free_slots.back();
+			free_slots.pop_back();
+		}
+
+		auto & slot = slots[slot_index];
+		slot.dense_index = datas.size();
+		it->second = {.index = slot_index, .generation = slot.generation};
+
+		datas.emplace_back(std::forward<Args>(args)...);
+		names.push_back(name);
+		dense2slot.push_back(slot_index);
+
+		return {names.back(), datas.back()};
+	}
+
+	void erase(Handle<T> const & handle)
+	{
+		if (not contains(handle))
+			return;
+
+		auto & slot = slots[handle.index];
+		auto dense_index = slot.dense_index;
+		auto last_index = u32(datas.size() - 1);
+
+		name2handle.erase(names[dense_index]);
+
+		if (dense_index != last_index)
+		{
+			datas[dense_index] = move(datas[last_index]);
+			names[dense_index] = names[last_index];
+			dense2slot[dense_index] = dense2slot[last_index];
+			slots[dense2slot[dense_index]].dense_index = dense_index;
+		}
+		datas.pop_back();
+		names.pop_back();
+		dense2slot.pop_back();
+
+		slot.generation++;
+		free_slots.push_back(handle.index);
+	}
+
+	void erase(Name const & name)
+	{ erase(get_handle(name)); }
+
+	bool contains(Handle<T> const & handle) const
+	{ return handle.index < slots.size() and slots[handle.index].generation == handle.generation; }
+
+	template<typename... Names>
+	auto contains(Names... names) const
+	{ return (name2handle.contains(names) && ...); }
+
+	Handle<T> get_handle(Name const & name) const
+	{
+		if (auto it = name2handle.find(name); it != name2handle.end())
+			return it->second;
+		return {};
+	}
+
+	// position in datas, changes when other resources are erased
+	u32 dense_index_of(Handle<T> const & handle) const
+	{
+		assert(contains(handle), "Handle is stale");
+		return slots[handle.index].dense_index;
+	}
+
+	T & get(Handle<T> const & handle)
+	{ return datas[dense_index_of(handle)]; }
+
+	T const & get(Handle<T> const & handle) const
+	{ return datas[dense_index_of(handle)]; }
+
+	T & get(Name const & name)
+	{ return datas[slots[name2handle.at(name).index].dense_index]; }
+
+	T const & get(Name const & name) const
+	{ return datas[slots[name2handle.at(name).index].dense_index]; }
+
+	Named<T> get_named(Name const & name)
+	{
+		auto dense_index = slots[name2handle.at(name).index].dense_index;
+		return {names[dense_index], datas[dense_index]};
+	}
+
+	Name const & name_of(Handle<T> const & handle) const
+	{ return names[dense_index_of(handle)]; }
+
+	T & get_or_generate(Name const & name)
+	{
+		if (auto it = name2handle.find(name); it != name2handle.end())
+			return get(it->second);
+		return generate(name).data;
+	}
+
+	auto empty() const
+	{ return datas.empty(); }
+
+	auto size() const
+	{ return datas.size(); }
+
+	// upper bound of handle.index, handy for arrays indexed by slot
+	auto slot_count() const
+	{ return slots.size(); }
+
+	// yields Named<T> by value, bind with `auto [name, data]`
+	template<typename Data>
+	struct Iterator
+	{
+		Name const * name;
+		Data * data;
+
+		Named<Data> operator*() const
+		{ return {*name, *data}; }
+
+		Iterator & operator++()
+		{ ++name, ++data; return *this; }
+
+		bool operator==(Iterator const & other) const
+		{ return data == other.data; }
+	};
+
+	Iterator<T> begin()
+	{ return {names.data(), datas.data()}; }
+
+	Iterator<T> end()
+	{ return {names.data() + names.size(), datas.data() + datas.size()}; }
+
+	Iterator<T const> begin() const
+	{ return {names.data(), datas.data()}; }
+
+	Iterator<T const> end() const
+	{ return {names.data() + names.size(), datas.data() + datas.size()}; }
+};
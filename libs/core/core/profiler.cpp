@@ -0,0 +1,129 @@
+#include "profiler.hpp"
+
+#include <mutex>
+#include <cstdio>
+
+namespace Profiler
+{
+namespace
+{
+struct Registry
+{
+	std::mutex mutex;
+	vector<unique_one<ThreadBuffer>> thread_buffers; // never shrinks, threads may outlive their captures
+
+	u64 capture_begin_ns = 0;
+	u64 capture_end_ns = 0;
+	std::atomic<u32> frames_left = 0;
+
+	static Registry & get()
+	{
+		static Registry registry;
+		return registry;
+	}
+};
+
+auto const process_start = std::chrono::steady_clock::now();
+}
+
+u64 now_ns()
+{ return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - process_start).count(); }
+
+ThreadBuffer & get_thread_buffer()
+{
+	thread_local ThreadBuffer * buffer = []
+	{
+		auto & registry = Registry::get();
+		std::lock_guard lock(registry.mutex);
+
+		auto & buffer = registry.thread_buffers.emplace_back(make_unique_one<ThreadBuffer>());
+		buffer->id = registry.thread_buffers.size() - 1;
+		buffer->name = fmt::format("Thread {}", buffer->id);
+		return buffer.get();
+	}();
+	return *buffer;
+}
+
+void set_thread_name(std::string_view name)
+{
+	auto & buffer = get_thread_buffer(); // registers the thread, so it must be called before locking
+	std::lock_guard lock(Registry::get().mutex);
+	buffer.name = name;
+}
+
+void start_capture()
+{
+	auto & registry = Registry::get();
+	registry.capture_begin_ns = now_ns();
+	registry.capture_end_ns = std::numeric_limits<u64>::max();
+	registry.frames_left = 0;
+	is_capturing = true;
+}
+
+void stop_capture()
+{
+	auto & registry = Registry::get();
+	is_capturing = false;
+	registry.capture_end_ns = now_ns();
+	registry.frames_left = 0;
+}
+
+void capture_frames(u32 count)
+{
+	start_capture();
+	Registry::get().frames_left = count;
+}
+
+void frame_mark()
+{
+	auto & frames_left = Registry::get().frames_left;
+	if (frames_left != 0 and --frames_left == 0)
+		stop_capture();
+}
+
+bool save_chrome_trace(std::filesystem::path const & path)
+{
+	auto & registry = Registry::get();
+
+	auto * file = std::fopen(path.string().c_str(), "w");
+	if (file == nullptr)
+	{
+		fmt::print(stderr, "Profiler could not open {}\n", path);
+		return false;
+	}
+
+	// see https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+	fmt::print(file, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+	bool is_first = true;
+	auto const separator = [&is_first]
+	{ return std::exchange(is_first, false) ? "" : ",\n"; };
+
+	std::lock_guard lock(registry.mutex);
+	for (auto & buffer: registry.thread_buffers)
+	{
+		fmt::print(
+			file, R"({}{{"ph":"M","name":"thread_name","pid":0,"tid":{},"args":{{"name":"{}"}}}})",
+			separator(), buffer->id, buffer->name
+		);
+
+		auto const write_count = buffer->write_count.load(std::memory_order_acquire);
+		auto const first = write_count > ThreadBuffer::CAPACITY ? write_count - ThreadBuffer::CAPACITY : 0;
+		for (auto i = first; i < write_count; ++i)
+		{
+			auto const & event = buffer->events[i % ThreadBuffer::CAPACITY];
+			if (event.begin_ns < registry.capture_begin_ns or registry.capture_end_ns < event.end_ns)
+				continue;
+
+			fmt::print(
+				file, R"({}{{"ph":"X","name":"{}","pid":0,"tid":{},"ts":{:.3f},"dur":{:.3f}}})",
+				separator(), event.name, buffer->id, f64(event.begin_ns) / 1e3, f64(event.end_ns - event.begin_ns) / 1e3
+			);
+		}
+	}
+
+	fmt::print(file, "\n]}}\n");
+	std::fclose(file);
+	return true;
+}
+}
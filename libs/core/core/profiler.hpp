@@ -0,0 +1,91 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <atomic>
+#include <filesystem>
+
+// Scoped zone CPU profiler
+// zones are only recorded while capturing, into per-thread ring buffers (single writer, no locks)
+// a capture can be exported as a Chrome trace (open with chrome://tracing or https://ui.perfetto.dev)
+namespace Profiler
+{
+struct Event
+{
+	char const * name; // must outlive the profiler, string literals
+	u64 begin_ns;
+	u64 end_ns;
+	u32 depth;
+};
+
+// events older than the capacity are overwritten
+struct ThreadBuffer
+{
+	static constexpr usize CAPACITY = 1 << 16;
+
+	unique_array<Event> events{new Event[CAPACITY]};
+	std::atomic<u64> write_count = 0;
+	u32 depth = 0;
+	u32 id;
+	std::string name;
+};
+
+inline std::atomic<bool> is_capturing = false;
+
+u64 now_ns();
+ThreadBuffer & get_thread_buffer();
+void set_thread_name(std::string_view name);
+
+void start_capture();
+void stop_capture();
+// captures until frame_mark is called count times
+void capture_frames(u32 count);
+// call once per frame
+void frame_mark();
+
+// exports the events of the last (or the ongoing) capture
+bool save_chrome_trace(std::filesystem::path const & path);
+
+struct Zone
+{
+	char const * name;
+	u64 begin_ns;
+	bool is_active;
+
+	explicit Zone(char const * name) :
+		name(name), is_active(is_capturing.load(std::memory_order_relaxed))
+	{
+		if (is_active)
+		{
+			get_thread_buffer().depth++;
+			begin_ns = now_ns();
+		}
+	}
+
+	~Zone()
+	{
+		if (not is_active)
+			return;
+
+		auto end_ns = now_ns();
+		auto & buffer = get_thread_buffer();
+		buffer.depth--;
+
+		auto idx = buffer.write_count.load(std::memory_order_relaxed);
+		buffer.events[idx % ThreadBuffer::CAPACITY] = {
+			.name = name,
+			.begin_ns = begin_ns,
+			.end_ns = end_ns,
+			.depth = buffer.depth,
+		};
+		buffer.write_count.store(idx + 1, std::memory_order_release);
+	}
+
+	COPY(Zone, delete)
+	MOVE(Zone, delete)
+};
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+#define PROFILE_ZONE(name) Profiler::Zone const PROFILE_CONCAT(_profile_zone_, __LINE__)(name)
@@ -0,0 +1,186 @@
+#include "quantize.hpp"
+#include "profiler.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+namespace Geometry
+{
+namespace
+{
+// the integer of a normalized value, rounded to the nearest one
+template<typename T>
+T to_norm(f32 value)
+{
+	auto constexpr min = std::is_signed_v<T> ? -1.f : 0.f;
+	return T(std::lround(glm::clamp(value, min, 1.f) * f32(std::numeric_limits<T>::max())));
+}
+
+// as the gpu reads them, see the OpenGL 4.6 spec section 2.3.5.1 (Conversion from Normalized Fixed-Point to Floating-Point)
+template<typename T>
+f32 from_norm(T value)
+{ return glm::max(f32(value) / f32(std::numeric_limits<T>::max()), -1.f); }
+
+void write_component(byte * destination, Type::Value type, f32 value)
+{
+	using enum Type::Value;
+	switch (type)
+	{
+	case F32: std::memcpy(destination, &value, sizeof(f32)); return;
+	case F16: { auto half = glm::packHalf1x16(value); std::memcpy(destination, &half, sizeof(u16)); return; }
+	case I8NORM: { auto v = to_norm<i8>(value); std::memcpy(destination, &v, sizeof(v)); return; }
+	case I16NORM: { auto v = to_norm<i16>(value); std::memcpy(destination, &v, sizeof(v)); return; }
+	case U8NORM: { auto v = to_norm<u8>(value); std::memcpy(destination, &v, sizeof(v)); return; }
+	case U16NORM: { auto v = to_norm<u16>(value); std::memcpy(destination, &v, sizeof(v)); return; }
+	default: assert_failure("Attribute can not be quantized into this type");
+	}
+}
+
+f32 read_component(byte const * source, Type::Value type)
+{
+	using enum Type::Value;
+	switch (type)
+	{
+	case F32: { f32 v; std::memcpy(&v, source, sizeof(v)); return v; }
+	case F16: { u16 v; std::memcpy(&v, source, sizeof(v)); return glm::unpackHalf1x16(v); }
+	case I8NORM: { i8 v; std::memcpy(&v, source, sizeof(v)); return from_norm(v); }
+	case I16NORM: { i16 v; std::memcpy(&v, source, sizeof(v)); return from_norm(v); }
+	case U8NORM: { u8 v; std::memcpy(&v, source, sizeof(v)); return from_norm(v); }
+	case U16NORM: { u16 v; std::memcpy(&v, source, sizeof(v)); return from_norm(v); }
+	default: assert_failure("Attribute can not be quantized into this type");
+	}
+}
+}
+
+f32x2 encode_octahedral(f32x3 const & normal)
+{
+	auto const n = normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+	if (n.z >= 0)
+		return {n.x, n.y};
+
+	// the lower half folds over the diagonals
+	return {
+		(1 - glm::abs(n.y)) * (n.x >= 0 ? 1.f : -1.f),
+		(1 - glm::abs(n.x)) * (n.y >= 0 ? 1.f : -1.f),
+	};
+}
+
+f32x3 decode_octahedral(f32x2 const & encoded)
+{
+	f32x3 n(encoded.x, encoded.y, 1 - glm::abs(encoded.x) - glm::abs(encoded.y));
+	auto const t = glm::max(-n.z, 0.f);
+	n.x += n.x >= 0 ? -t : t;
+	n.y += n.y >= 0 ? -t : t;
+	return glm::normalize(n);
+}
+
+Layout get_source_layout(Layout const & target)
+{
+	auto source = target;
+	for (auto & attribute: source.attributes)
+	{
+		if (not attribute.is_used() or not holds_alternative<Key::Common>(attribute.key.name))
+			continue;
+
+		using enum Key::Common;
+		auto const common = get<Key::Common>(attribute.key.name);
+		if (common != POSITION and common != NORMAL and common != TANGENT and common != TEXCOORD)
+			continue;
+
+		auto const dimension = attribute.is_octahedral() ? attribute.type.dimension + 1 : attribute.type.dimension;
+		attribute.type = Type{Type::F32, u8(dimension)};
+	}
+	return source;
+}
+
+QuantizationErrors quantize(Primitive & primitive, Layout const & target, Quantization const & quantization)
+{
+	PROFILE_ZONE("Geometry::quantize");
+
+	auto const vertex_count = primitive.get_vertex_count();
+
+	QuantizationErrors errors;
+	for (auto i = 0; i < ATTRIBUTE_COUNT; ++i)
+	{
+		auto const & source_attribute = primitive.layout->attributes[i];
+		auto const & target_attribute = target.attributes[i];
+		if (not target_attribute.is_used() or source_attribute.type == target_attribute.type)
+			continue;
+
+		assert(source_attribute.key == target_attribute.key, "Target layout has different attributes");
+		assert(source_attribute.type.value == Type::F32, "Only F32 attributes are quantized");
+
+		auto const source_dimension = source_attribute.type.dimension;
+		auto const target_dimension = target_attribute.type.dimension;
+		auto const component_type = target_attribute.type.value;
+		auto const component_size = target_attribute.type.size();
+		auto const is_position = target_attribute.key == Key{Key::POSITION, 0} and target_attribute.type.is_normalized();
+
+		auto const source = primitive.data.buffers[i].span_as<f32 const>();
+		ByteBuffer buffer(target_attribute.type.vector_size() * vertex_count);
+		f32 max_error = 0;
+		for (usize vertex = 0; vertex < vertex_count; ++vertex)
+		{
+			auto const * in = source.data() + vertex * source_dimension;
+			auto * out = buffer.begin() + vertex * target_attribute.type.vector_size();
+
+			if (target_attribute.is_octahedral())
+			{
+				auto const normal = glm::normalize(f32x3(in[0], in[1], in[2]));
+				auto const encoded = encode_octahedral(normal);
+
+				// rounding each component to the nearest is not the closest direction, the 4 neighbors are tried
+				auto const step = 1 / f32(component_size == 1 ? std::numeric_limits<i8>::max() : std::numeric_limits<i16>::max());
+				auto const floor = glm::floor(encoded / step) * step;
+				f32x2 best(0); // a zero length normal has no closest candidate
+				f32 best_error = std::numeric_limits<f32>::max();
+				for (auto corner = 0; corner < 4; ++corner)
+				{
+					f32x2 candidate(floor.x + step * f32(corner & 1), floor.y + step * f32(corner >> 1));
+					write_component(out, component_type, candidate.x);
+					write_component(out + component_size, component_type, candidate.y);
+					auto const decoded = decode_octahedral({
+						read_component(out, component_type), read_component(out + component_size, component_type)
+					});
+					auto const error = 2 * glm::asin(glm::min(glm::distance(decoded, normal) / 2, 1.f)); // acos is imprecise near 0
+					if (error < best_error)
+						best_error = error, best = candidate;
+				}
+				write_component(out, component_type, best.x);
+				write_component(out + component_size, component_type, best.y);
+				if (target_dimension == 3) // tangent handedness
+					write_component(out + 2 * component_size, component_type, in[3] < 0 ? -1.f : 1.f);
+				max_error = glm::max(max_error, best_error);
+			}
+			else if (is_position)
+			{
+				f32x3 const position(in[0], in[1], in[2]);
+				auto const normalized = (position - quantization.box.min) / quantization.scale;
+				f32x3 decoded;
+				for (auto c = 0; c < 3; ++c)
+				{
+					write_component(out + c * component_size, component_type, normalized[c]);
+					decoded[c] = read_component(out + c * component_size, component_type);
+				}
+				decoded = quantization.box.min + decoded * quantization.scale;
+				max_error = glm::max(max_error, glm::distance(decoded, position));
+			}
+			else
+			{
+				assert(source_dimension == target_dimension, "Quantized attributes keep their dimension");
+				for (auto c = 0; c < target_dimension; ++c)
+				{
+					write_component(out + c * component_size, component_type, in[c]);
+					auto const decoded = read_component(out + c * component_size, component_type);
+					max_error = glm::max(max_error, glm::abs(decoded - in[c]));
+				}
+			}
+		}
+
+		primitive.data.buffers[i] = move(buffer);
+		errors.max_errors[i] = max_error;
+	}
+
+	primitive.layout = &target;
+	return errors;
+}
+}
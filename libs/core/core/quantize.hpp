@@ -0,0 +1,55 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+
+// Compact vertex attributes, the F32 attributes of a primitive are converted into the types of a target layout
+//  positions: normalized relative to a box with a single scale, so the dequantization folds into the node matrix
+//    without skewing the normals (shaders transform them with the same matrix and normalize)
+//  normals, tangents: octahedral in 2 normalized components, tangents keep the handedness as the 3rd (see Attribute::is_octahedral)
+//  the rest: F16 or normalized integers of the same dimension, clamped to their range
+// Shaders read an octahedral attribute as <name>_octahedral, the generated vertex layout has decode_octahedral for it
+namespace Geometry
+{
+struct Quantization
+{
+	AABB box; // of the positions, object space
+	f32 scale; // the longest side of the box
+	f32x4x4 dequantization; // normalized positions into object space
+
+	// identity unless target has normalized positions
+	static Quantization from_box(AABB const & box, Layout const & target)
+	{
+		auto const is_quantized = std::ranges::any_of(
+			target, [](Attribute const & a) { return a.is_used() and a.key == Key{Key::POSITION, 0} and a.type.is_normalized(); }
+		);
+		if (not is_quantized or box.is_empty())
+			return {.box = box, .scale = 1, .dequantization = f32x4x4(1)};
+
+		auto const scale = glm::max(glm::compMax(box.max - box.min), std::numeric_limits<f32>::min());
+		return {
+			.box = box,
+			.scale = scale,
+			.dequantization = glm::translate(box.min) * glm::scale(f32x3(scale)),
+		};
+	}
+};
+
+// per attribute, the largest error measured after decoding, 0 if it was not converted
+// object space distance for the positions, radians for the normals and tangents, absolute for the rest
+struct QuantizationErrors
+{
+	array<f32, ATTRIBUTE_COUNT> max_errors{};
+};
+
+// the layout a primitive is read in before quantize converts it into target
+// POSITION, NORMAL, TANGENT and TEXCOORD become F32 (their gltf type), the rest stay as they are
+Layout get_source_layout(Layout const & target);
+
+// the primitive's layout has the same attributes as target, afterwards it points to target
+QuantizationErrors quantize(Primitive & primitive, Layout const & target, Quantization const & quantization);
+
+// of a unit vector, both components in [-1, 1]
+f32x2 encode_octahedral(f32x3 const & normal);
+f32x3 decode_octahedral(f32x2 const & encoded);
+}
@@ -0,0 +1,300 @@
+#include "simplify.hpp"
+#include "profiler.hpp"
+
+namespace Geometry
+{
+namespace
+{
+using Quadric = Simplifier::Quadric;
+
+// squared distance to the plane dot(normal, p) + d = 0
+Quadric from_plane(f64x3 normal, f64 d)
+{
+	return {
+		.a00 = normal.x * normal.x, .a01 = normal.x * normal.y, .a02 = normal.x * normal.z, .a03 = normal.x * d,
+		.a11 = normal.y * normal.y, .a12 = normal.y * normal.z, .a13 = normal.y * d,
+		.a22 = normal.z * normal.z, .a23 = normal.z * d,
+		.a33 = d * d,
+	};
+}
+
+void add(Quadric & q, Quadric const & other)
+{
+	q.a00 += other.a00, q.a01 += other.a01, q.a02 += other.a02, q.a03 += other.a03;
+	q.a11 += other.a11, q.a12 += other.a12, q.a13 += other.a13;
+	q.a22 += other.a22, q.a23 += other.a23;
+	q.a33 += other.a33;
+}
+
+f64 evaluate(Quadric const & q, f32x3 const & point)
+{
+	f64 const x = point.x, y = point.y, z = point.z;
+	auto const error = q.a00 * x * x + 2 * q.a01 * x * y + 2 * q.a02 * x * z + 2 * q.a03 * x
+					   + q.a11 * y * y + 2 * q.a12 * y * z + 2 * q.a13 * y
+					   + q.a22 * z * z + 2 * q.a23 * z
+					   + q.a33;
+	return glm::max(error, 0.); // rounding can make it slightly negative
+}
+
+struct Collapse
+{
+	f64 cost; // quadric_error plus the normal term, orders the collapses
+	f64 quadric_error;
+	u32 from, to;
+
+	bool operator<(Collapse const & other) const
+	{
+		if (cost != other.cost) return cost < other.cost;
+		if (from != other.from) return from < other.from;
+		return to < other.to;
+	}
+};
+}
+
+void Simplifier::init(SimplifyDesc const & desc, span<u32 const> source_indices)
+{
+	PROFILE_ZONE("Simplifier::init");
+
+	assert(source_indices.size() % 3 == 0, "Indices must be a triangle list");
+	assert(desc.normals.empty() or desc.normals.size() == desc.positions.size());
+
+	positions = desc.positions;
+	normals = desc.normals;
+	indices.assign(source_indices.begin(), source_indices.end());
+	max_quadric_error = 0;
+
+	auto const vertex_count = positions.size();
+	auto const bounds = Bounds::from_points(positions);
+	auto const normal_scale = f64(desc.normal_weight) * bounds.sphere.radius;
+	normal_cost_scale = normal_scale * normal_scale;
+
+	// unweighted planes, so the cost is at least the squared distance to any of the planes around
+	quadrics.assign(vertex_count, Quadric{});
+	for (usize t = 0; t < indices.size(); t += 3)
+	{
+		f64x3 const p0 = positions[indices[t + 0]], p1 = positions[indices[t + 1]], p2 = positions[indices[t + 2]];
+		auto const cross = glm::cross(p1 - p0, p2 - p0);
+		auto const length = glm::length(cross);
+		if (length == 0)
+			continue;
+
+		auto const normal = cross / length;
+		auto const plane = from_plane(normal, -glm::dot(normal, p0));
+		for (auto i = 0; i < 3; ++i)
+			add(quadrics[indices[t + i]], plane);
+	}
+
+	// an edge that does not have exactly 2 triangles is a boundary (or a seam, its other side uses other vertices)
+	vector<std::pair<u32, u32>> edges;
+	edges.reserve(indices.size());
+	for (usize t = 0; t < indices.size(); t += 3)
+		for (auto i = 0; i < 3; ++i)
+		{
+			auto a = indices[t + i], b = indices[t + (i + 1) % 3];
+			edges.emplace_back(glm::min(a, b), glm::max(a, b));
+		}
+	std::ranges::sort(edges);
+
+	is_locked.assign(vertex_count, false);
+	for (usize begin = 0; begin < edges.size();)
+	{
+		auto end = begin + 1;
+		while (end < edges.size() and edges[end] == edges[begin])
+			++end;
+
+		if (end - begin != 2)
+			is_locked[edges[begin].first] = is_locked[edges[begin].second] = true;
+		begin = end;
+	}
+
+	_remap.resize(vertex_count);
+	for (u32 i = 0; i < vertex_count; ++i)
+		_remap[i] = i;
+}
+
+void Simplifier::simplify(usize target_index_count, f32 max_error)
+{
+	PROFILE_ZONE("Simplifier::simplify");
+
+	auto const vertex_count = positions.size();
+	auto const quadric_error_limit = f64(max_error) * max_error;
+
+	vector<Collapse> collapses;
+	while (indices.size() > target_index_count)
+	{
+		auto const triangle_count = indices.size() / 3;
+
+		// triangles around each vertex
+		_triangle_offsets.assign(vertex_count + 1, 0);
+		for (auto index: indices)
+			_triangle_offsets[index + 1]++;
+		for (usize i = 0; i < vertex_count; ++i)
+			_triangle_offsets[i + 1] += _triangle_offsets[i];
+		_vertex_triangles.resize(indices.size());
+		{
+			auto offsets = _triangle_offsets;
+			for (usize i = 0; i < indices.size(); ++i)
+				_vertex_triangles[offsets[indices[i]]++] = u32(i / 3);
+		}
+
+		auto const make_collapse = [&](u32 from, u32 to)
+		{
+			auto quadric = quadrics[from];
+			add(quadric, quadrics[to]);
+			Collapse collapse{.cost = 0, .quadric_error = evaluate(quadric, positions[to]), .from = from, .to = to};
+			collapse.cost = collapse.quadric_error;
+			if (not normals.empty())
+			{
+				auto const difference = f64x3(normals[from]) - f64x3(normals[to]);
+				collapse.cost += normal_cost_scale * glm::dot(difference, difference);
+			}
+			return collapse;
+		};
+
+		// every edge once, in the cheaper direction that removes an unlocked vertex
+		// an edge with an unlocked vertex has 2 triangles that wind it oppositely, so only the a < b side is taken
+		collapses.clear();
+		for (usize t = 0; t < indices.size(); t += 3)
+			for (auto i = 0; i < 3; ++i)
+			{
+				auto const a = indices[t + i], b = indices[t + (i + 1) % 3];
+				if (a > b or (is_locked[a] and is_locked[b]))
+					continue;
+
+				auto collapse = is_locked[a] ? make_collapse(b, a) : make_collapse(a, b);
+				if (not is_locked[a] and not is_locked[b])
+					if (auto other = make_collapse(b, a); other < collapse)
+						collapse = other;
+				collapses.push_back(collapse);
+			}
+		std::sort(collapses.begin(), collapses.end());
+		collapses.erase(std::unique(collapses.begin(), collapses.end(), [](Collapse const & l, Collapse const & r)
+		{ return l.from == r.from and l.to == r.to; }), collapses.end());
+
+		// no triangle around from should flip or degenerate when from moves onto to,
+		// and the edge should only share its 2 opposite vertices (link condition), otherwise the surface folds onto itself
+		auto const is_valid = [&](u32 from, u32 to)
+		{
+			for (auto k = _triangle_offsets[to]; k < _triangle_offsets[to + 1]; ++k)
+				for (auto i = 0; i < 3; ++i)
+					_is_neighbor[indices[_vertex_triangles[k] * 3 + i]] = 1;
+
+			u32 shared_count = 0;
+			for (auto k = _triangle_offsets[from]; k < _triangle_offsets[from + 1]; ++k)
+				for (auto i = 0; i < 3; ++i)
+				{
+					auto const vertex = indices[_vertex_triangles[k] * 3 + i];
+					if (vertex != from and vertex != to and _is_neighbor[vertex] == 1)
+						shared_count++, _is_neighbor[vertex] = 2; // count once
+				}
+
+			for (auto k = _triangle_offsets[to]; k < _triangle_offsets[to + 1]; ++k)
+				for (auto i = 0; i < 3; ++i)
+					_is_neighbor[indices[_vertex_triangles[k] * 3 + i]] = 0;
+
+			if (shared_count > 2)
+				return false;
+
+			for (auto k = _triangle_offsets[from]; k < _triangle_offsets[from + 1]; ++k)
+			{
+				auto const * triangle = indices.data() + _vertex_triangles[k] * 3;
+				if (triangle[0] == to or triangle[1] == to or triangle[2] == to)
+					continue; // removed
+
+				auto const corner = triangle[0] == from ? 0 : triangle[1] == from ? 1 : 2;
+				auto const & p1 = positions[triangle[(corner + 1) % 3]];
+				auto const & p2 = positions[triangle[(corner + 2) % 3]];
+				auto const before = glm::cross(p1 - positions[from], p2 - positions[from]);
+				auto const after = glm::cross(p1 - positions[to], p2 - positions[to]);
+				if (glm::dot(before, after) <= 0.25f * glm::length(before) * glm::length(after))
+					return false;
+			}
+			return true;
+		};
+
+		// independent collapses, so the validity checks see the current triangles
+		auto const triangles_to_remove = (indices.size() - target_index_count + 2) / 3;
+		usize removed_triangle_count = 0;
+		vector<u32> collapsed;
+		_is_touched.assign(vertex_count, 0);
+		_is_neighbor.assign(vertex_count, 0);
+		for (auto const & [cost, quadric_error, from, to]: collapses)
+		{
+			// the normal term can order a farther collapse before a closer one, so the rest is still tried
+			if (quadric_error > quadric_error_limit)
+				continue;
+			if (_is_touched[from] or _is_touched[to] or not is_valid(from, to))
+				continue;
+
+			_remap[from] = to;
+			collapsed.push_back(from);
+			add(quadrics[to], quadrics[from]);
+			max_quadric_error = glm::max(max_quadric_error, quadric_error);
+
+			_is_touched[to] = 1;
+			for (auto k = _triangle_offsets[from]; k < _triangle_offsets[from + 1]; ++k)
+			{
+				auto const * triangle = indices.data() + _vertex_triangles[k] * 3;
+				_is_touched[triangle[0]] = _is_touched[triangle[1]] = _is_touched[triangle[2]] = 1;
+				removed_triangle_count += triangle[0] == to or triangle[1] == to or triangle[2] == to;
+			}
+
+			if (removed_triangle_count >= triangles_to_remove)
+				break;
+		}
+
+		if (collapsed.empty())
+			break;
+
+		usize write = 0;
+		for (usize t = 0; t < triangle_count; ++t)
+		{
+			auto const a = _remap[indices[t * 3 + 0]], b = _remap[indices[t * 3 + 1]], c = _remap[indices[t * 3 + 2]];
+			if (a == b or b == c or c == a)
+				continue;
+
+			indices[write++] = a, indices[write++] = b, indices[write++] = c;
+		}
+		indices.resize(write);
+
+		for (auto from: collapsed)
+			_remap[from] = from;
+	}
+}
+
+void generate_lods(Primitive & primitive, span<f32 const> ratios, f32 normal_weight)
+{
+	PROFILE_ZONE("Geometry::generate_lods");
+
+	primitive.lods.clear();
+
+	auto const positions = primitive.find_f32x3(Key::POSITION);
+	if (positions.empty())
+		return;
+
+	Simplifier simplifier;
+	simplifier.init(
+		{
+			.positions = positions,
+			.normals = primitive.find_f32x3(Key::NORMAL),
+			.normal_weight = normal_weight,
+		},
+		primitive.indices
+	);
+
+	auto const triangle_count = primitive.indices.size() / 3;
+	for (auto ratio: ratios)
+	{
+		simplifier.simplify(usize(f64(triangle_count) * ratio) * 3);
+
+		auto const previous_size = primitive.lods.empty() ? primitive.indices.size() : primitive.lods.back().indices.size();
+		if (simplifier.indices.size() > previous_size * 9 / 10)
+			break; // stuck on the locked vertices
+
+		primitive.lods.push_back({
+			.indices = simplifier.indices,
+			.error = simplifier.get_error(),
+		});
+	}
+}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "core.hpp"
+#include "geometry.hpp"
+
+// Mesh simplification with quadric error metrics (https://www.cs.cmu.edu/~garland/Papers/quadrics.pdf)
+// Edges are collapsed onto one of their vertices, so the simplified indices reuse the vertices (and their attributes)
+// Boundary, seam (same position, split attributes) and non-manifold vertices are locked, they are never removed
+// Deterministic, every pass collapses the cheapest independent edges in a total order, single threaded
+namespace Geometry
+{
+struct SimplifyDesc
+{
+	span<f32x3 const> positions;
+	span<f32x3 const> normals = {}; // optional, a collapse also costs the change of the normal
+	f32 normal_weight = 0.05; // relative to the radius of the mesh
+};
+
+struct Simplifier
+{
+	span<f32x3 const> positions;
+	span<f32x3 const> normals;
+	f64 normal_cost_scale;
+
+	struct Quadric
+	{
+		f64 a00, a01, a02, a03, a11, a12, a13, a22, a23, a33;
+	};
+	vector<Quadric> quadrics;
+	vector<bool> is_locked;
+
+	vector<u32> indices; // current
+	// of the collapses so far, the squared distance to the source planes, without the normal term that only ranks them
+	f64 max_quadric_error = 0;
+
+	// reused between the passes
+	vector<u32> _triangle_offsets, _vertex_triangles;
+	vector<u32> _remap;
+	vector<u8> _is_touched, _is_neighbor;
+
+	void init(SimplifyDesc const & desc, span<u32 const> source_indices);
+
+	// continues from the current indices, stops early when every remaining collapse moves the surface more than max_error
+	void simplify(usize target_index_count, f32 max_error = std::numeric_limits<f32>::max());
+
+	// object space distance the current surface may deviate from the source one
+	f32 get_error() const
+	{ return f32(glm::sqrt(max_quadric_error)); }
+};
+
+// appends a lod per ratio (of the full detail triangle count), stops when a lod would save less than 10%
+void generate_lods(Primitive & primitive, span<f32 const> ratios, f32 normal_weight = SimplifyDesc{}.normal_weight);
+}
@@ -0,0 +1,346 @@
+#include "transform_kernels.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define TransformKernels_X64
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TransformKernels_TARGET_AVX2
+#else
+#define TransformKernels_TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+#endif
+
+namespace TransformKernels
+{
+namespace
+{
+// glm stores quaternions as x, y, z, w unless GLM_FORCE_QUAT_DATA_WXYZ is defined
+static_assert(sizeof(f32quat) == 4 * sizeof(f32) and sizeof(f32x3) == 3 * sizeof(f32));
+static_assert(sizeof(f32x4x4) == 16 * sizeof(f32));
+
+void calculate_transforms_scalar(
+	usize count, f32x3 const * positions, f32quat const * rotations, f32x3 const * scales, f32x4x4 * matrices
+)
+{
+	for (usize i = 0; i < count; ++i)
+	{
+		f32x4x4 transform = glm::mat4_cast(rotations[i]);
+		transform[3] = f32x4(positions[i], 1);
+		transform[0] *= scales[i][0];
+		transform[1] *= scales[i][1];
+		transform[2] *= scales[i][2];
+		matrices[i] = transform;
+	}
+}
+
+void apply_parents_scalar(usize count, f32x4x4 const * parent_matrices, u32 const * parent_indices, f32x4x4 * matrices)
+{
+	for (usize i = 0; i < count; ++i)
+		matrices[i] = parent_matrices[parent_indices[i]] * matrices[i];
+}
+
+#ifdef TransformKernels_X64
+// 4 nodes per iteration, every lane is a node
+void calculate_transforms_sse(
+	usize count, f32x3 const * positions, f32quat const * rotations, f32x3 const * scales, f32x4x4 * matrices
+)
+{
+	auto const one = _mm_set1_ps(1), two = _mm_set1_ps(2), zero = _mm_setzero_ps();
+
+	usize i = 0;
+	for (; i + 4 <= count; i += 4)
+	{
+		auto qx = _mm_loadu_ps(&rotations[i + 0].x);
+		auto qy = _mm_loadu_ps(&rotations[i + 1].x);
+		auto qz = _mm_loadu_ps(&rotations[i + 2].x);
+		auto qw = _mm_loadu_ps(&rotations[i + 3].x);
+		_MM_TRANSPOSE4_PS(qx, qy, qz, qw);
+
+		auto const load_component = [i](f32x3 const * vectors, u32 c)
+		{ return _mm_setr_ps(vectors[i + 0][c], vectors[i + 1][c], vectors[i + 2][c], vectors[i + 3][c]); };
+
+		// same as glm::mat3_cast
+		auto qxx = _mm_mul_ps(qx, qx), qyy = _mm_mul_ps(qy, qy), qzz = _mm_mul_ps(qz, qz);
+		auto qxz = _mm_mul_ps(qx, qz), qxy = _mm_mul_ps(qx, qy), qyz = _mm_mul_ps(qy, qz);
+		auto qwx = _mm_mul_ps(qw, qx), qwy = _mm_mul_ps(qw, qy), qwz = _mm_mul_ps(qw, qz);
+
+		__m128 columns[4][4] = {
+			{
+				_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qyy, qzz))),
+				_mm_mul_ps(two, _mm_add_ps(qxy, qwz)),
+				_mm_mul_ps(two, _mm_sub_ps(qxz, qwy)),
+				zero,
+			},
+			{
+				_mm_mul_ps(two, _mm_sub_ps(qxy, qwz)),
+				_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qzz))),
+				_mm_mul_ps(two, _mm_add_ps(qyz, qwx)),
+				zero,
+			},
+			{
+				_mm_mul_ps(two, _mm_add_ps(qxz, qwy)),
+				_mm_mul_ps(two, _mm_sub_ps(qyz, qwx)),
+				_mm_sub_ps(one, _mm_mul_ps(two, _mm_add_ps(qxx, qyy))),
+				zero,
+			},
+			{
+				load_component(positions, 0),
+				load_component(positions, 1),
+				load_component(positions, 2),
+				one,
+			},
+		};
+
+		for (u32 c = 0; c < 3; ++c)
+		{
+			auto scale = load_component(scales, c);
+			for (u32 r = 0; r < 4; ++r) // w too, 0 * -s is -0 in glm
+				columns[c][r] = _mm_mul_ps(columns[c][r], scale);
+		}
+
+		// lanes to matrices
+		for (u32 c = 0; c < 4; ++c)
+		{
+			auto & column = columns[c];
+			_MM_TRANSPOSE4_PS(column[0], column[1], column[2], column[3]);
+			for (u32 lane = 0; lane < 4; ++lane)
+				_mm_storeu_ps(&matrices[i + lane][c][0], column[lane]);
+		}
+	}
+
+	calculate_transforms_scalar(count - i, positions + i, rotations + i, scales + i, matrices + i);
+}
+
+void apply_parents_sse(usize count, f32x4x4 const * parent_matrices, u32 const * parent_indices, f32x4x4 * matrices)
+{
+	for (usize i = 0; i < count; ++i)
+	{
+		auto const & parent = parent_matrices[parent_indices[i]];
+		auto p0 = _mm_loadu_ps(&parent[0][0]);
+		auto p1 = _mm_loadu_ps(&parent[1][0]);
+		auto p2 = _mm_loadu_ps(&parent[2][0]);
+		auto p3 = _mm_loadu_ps(&parent[3][0]);
+
+		auto & matrix = matrices[i];
+		for (u32 c = 0; c < 4; ++c)
+		{
+			auto column = _mm_loadu_ps(&matrix[c][0]);
+			// same order as glm: ((p0 * x + p1 * y) + p2 * z) + p3 * w
+			auto result = _mm_mul_ps(p0, _mm_shuffle_ps(column, column, _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm_add_ps(result, _mm_mul_ps(p1, _mm_shuffle_ps(column, column, _MM_SHUFFLE(1, 1, 1, 1))));
+			result = _mm_add_ps(result, _mm_mul_ps(p2, _mm_shuffle_ps(column, column, _MM_SHUFFLE(2, 2, 2, 2))));
+			result = _mm_add_ps(result, _mm_mul_ps(p3, _mm_shuffle_ps(column, column, _MM_SHUFFLE(3, 3, 3, 3))));
+			_mm_storeu_ps(&matrix[c][0], result);
+		}
+	}
+}
+
+// lambdas do not inherit the target attribute, so the helpers are functions
+TransformKernels_TARGET_AVX2
+__m256 load_component_x8(f32x3 const * vectors, u32 c)
+{
+	return _mm256_setr_ps(
+		vectors[0][c], vectors[1][c], vectors[2][c], vectors[3][c],
+		vectors[4][c], vectors[5][c], vectors[6][c], vectors[7][c]
+	);
+}
+
+// 8 nodes per iteration, the 128 bit halves are transposed separately (lanes 0-3 and 4-7)
+TransformKernels_TARGET_AVX2
+void calculate_transforms_avx2(
+	usize count, f32x3 const * positions, f32quat const * rotations, f32x3 const * scales, f32x4x4 * matrices
+)
+{
+	auto const one = _mm256_set1_ps(1), two = _mm256_set1_ps(2), zero = _mm256_setzero_ps();
+
+	usize i = 0;
+	for (; i + 8 <= count; i += 8)
+	{
+		auto const load_quaternions = [rotations](usize first, __m128 (& q)[4])
+		{
+			for (u32 k = 0; k < 4; ++k)
+				q[k] = _mm_loadu_ps(&rotations[first + k].x);
+			_MM_TRANSPOSE4_PS(q[0], q[1], q[2], q[3]);
+		};
+		__m128 low[4], high[4];
+		load_quaternions(i, low);
+		load_quaternions(i + 4, high);
+		auto qx = _mm256_set_m128(high[0], low[0]);
+		auto qy = _mm256_set_m128(high[1], low[1]);
+		auto qz = _mm256_set_m128(high[2], low[2]);
+		auto qw = _mm256_set_m128(high[3], low[3]);
+
+		// same as glm::mat3_cast
+		auto qxx = _mm256_mul_ps(qx, qx), qyy = _mm256_mul_ps(qy, qy), qzz = _mm256_mul_ps(qz, qz);
+		auto qxz = _mm256_mul_ps(qx, qz), qxy = _mm256_mul_ps(qx, qy), qyz = _mm256_mul_ps(qy, qz);
+		auto qwx = _mm256_mul_ps(qw, qx), qwy = _mm256_mul_ps(qw, qy), qwz = _mm256_mul_ps(qw, qz);
+
+		__m256 columns[4][4] = {
+			{
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qyy, qzz))),
+				_mm256_mul_ps(two, _mm256_add_ps(qxy, qwz)),
+				_mm256_mul_ps(two, _mm256_sub_ps(qxz, qwy)),
+				zero,
+			},
+			{
+				_mm256_mul_ps(two, _mm256_sub_ps(qxy, qwz)),
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qzz))),
+				_mm256_mul_ps(two, _mm256_add_ps(qyz, qwx)),
+				zero,
+			},
+			{
+				_mm256_mul_ps(two, _mm256_add_ps(qxz, qwy)),
+				_mm256_mul_ps(two, _mm256_sub_ps(qyz, qwx)),
+				_mm256_sub_ps(one, _mm256_mul_ps(two, _mm256_add_ps(qxx, qyy))),
+				zero,
+			},
+			{
+				load_component_x8(positions + i, 0),
+				load_component_x8(positions + i, 1),
+				load_component_x8(positions + i, 2),
+				one,
+			},
+		};
+
+		for (u32 c = 0; c < 3; ++c)
+		{
+			auto scale = load_component_x8(scales + i, c);
+			for (u32 r = 0; r < 4; ++r) // w too, 0 * -s is -0 in glm
+				columns[c][r] = _mm256_mul_ps(columns[c][r], scale);
+		}
+
+		// lanes to matrices, an in-lane 4x4 transpose per half
+		for (u32 c = 0; c < 4; ++c)
+		{
+			auto & column = columns[c];
+			auto t0 = _mm256_unpacklo_ps(column[0], column[1]);
+			auto t1 = _mm256_unpacklo_ps(column[2], column[3]);
+			auto t2 = _mm256_unpackhi_ps(column[0], column[1]);
+			auto t3 = _mm256_unpackhi_ps(column[2], column[3]);
+			__m256 lanes[4] = {
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 2, 3, 2)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(1, 0, 1, 0)),
+				_mm256_shuffle_ps(t2, t3, _MM_SHUFFLE(3, 2, 3, 2)),
+			};
+			for (u32 lane = 0; lane < 4; ++lane)
+			{
+				_mm_storeu_ps(&matrices[i + lane][c][0], _mm256_castps256_ps128(lanes[lane]));
+				_mm_storeu_ps(&matrices[i + 4 + lane][c][0], _mm256_extractf128_ps(lanes[lane], 1));
+			}
+		}
+	}
+
+	calculate_transforms_sse(count - i, positions + i, rotations + i, scales + i, matrices + i);
+}
+
+// 2 columns per instruction
+TransformKernels_TARGET_AVX2
+void apply_parents_avx2(usize count, f32x4x4 const * parent_matrices, u32 const * parent_indices, f32x4x4 * matrices)
+{
+	for (usize i = 0; i < count; ++i)
+	{
+		auto const & parent = parent_matrices[parent_indices[i]];
+		auto p0 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(&parent[0][0]));
+		auto p1 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(&parent[1][0]));
+		auto p2 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(&parent[2][0]));
+		auto p3 = _mm256_broadcast_ps(reinterpret_cast<__m128 const *>(&parent[3][0]));
+
+		auto & matrix = matrices[i];
+		for (u32 c = 0; c < 4; c += 2)
+		{
+			auto columns = _mm256_loadu_ps(&matrix[c][0]);
+			auto result = _mm256_mul_ps(p0, _mm256_permute_ps(columns, _MM_SHUFFLE(0, 0, 0, 0)));
+			result = _mm256_fmadd_ps(p1, _mm256_permute_ps(columns, _MM_SHUFFLE(1, 1, 1, 1)), result);
+			result = _mm256_fmadd_ps(p2, _mm256_permute_ps(columns, _MM_SHUFFLE(2, 2, 2, 2)), result);
+			result = _mm256_fmadd_ps(p3, _mm256_permute_ps(columns, _MM_SHUFFLE(3, 3, 3, 3)), result);
+			_mm256_storeu_ps(&matrix[c][0], result);
+		}
+	}
+}
+#endif
+
+Isa detect_isa()
+{
+#ifdef TransformKernels_X64
+#if defined(_MSC_VER)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7)
+		return Isa::SSE;
+
+	__cpuid(info, 1);
+	bool const has_fma = info[2] & (1 << 12);
+	bool const has_os_xsave = info[2] & (1 << 27);
+	bool const has_avx = info[2] & (1 << 28);
+	// the os must save the ymm registers too
+	if (not (has_fma and has_os_xsave and has_avx) or (_xgetbv(0) & 0b110) != 0b110)
+		return Isa::SSE;
+
+	__cpuidex(info, 7, 0);
+	bool const has_avx2 = info[1] & (1 << 5);
+	return has_avx2 ? Isa::AVX2 : Isa::SSE;
+#else
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2") and __builtin_cpu_supports("fma") ? Isa::AVX2 : Isa::SSE;
+#endif
+#else
+	return Isa::Scalar;
+#endif
+}
+
+struct Dispatch
+{
+	Isa isa;
+	decltype(&calculate_transforms_scalar) calculate_transforms;
+	decltype(&apply_parents_scalar) apply_parents;
+
+	static Dispatch of(Isa isa)
+	{
+		switch (isa)
+		{
+#ifdef TransformKernels_X64
+		case Isa::AVX2:
+			return {isa, calculate_transforms_avx2, apply_parents_avx2};
+		case Isa::SSE:
+			return {isa, calculate_transforms_sse, apply_parents_sse};
+#endif
+		default:
+			return {Isa::Scalar, calculate_transforms_scalar, apply_parents_scalar};
+		}
+	}
+};
+
+Isa const supported_isa = detect_isa();
+Dispatch dispatch = Dispatch::of(supported_isa);
+}
+
+char const * to_string(Isa isa)
+{
+	switch (isa)
+	{
+	case Isa::Scalar: return "Scalar";
+	case Isa::SSE: return "SSE";
+	case Isa::AVX2: return "AVX2";
+	}
+	return "Unknown";
+}
+
+Isa get_supported_isa()
+{ return supported_isa; }
+
+Isa get_isa()
+{ return dispatch.isa; }
+
+void set_isa(Isa isa)
+{ dispatch = Dispatch::of(std::min(isa, supported_isa)); }
+
+void calculate_transforms(
+	usize count, f32x3 const * positions, f32quat const * rotations, f32x3 const * scales, f32x4x4 * matrices
+)
+{ dispatch.calculate_transforms(count, positions, rotations, scales, matrices); }
+
+void apply_parents(usize count, f32x4x4 const * parent_matrices, u32 const * parent_indices, f32x4x4 * matrices)
+{ dispatch.apply_parents(count, parent_matrices, parent_indices, matrices); }
+}
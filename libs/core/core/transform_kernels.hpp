@@ -0,0 +1,31 @@
+#pragma once
+
+#include "core.hpp"
+
+// Batched transform math, the best instruction set the cpu supports is picked at runtime
+// Scalar and SSE results are identical to glm (same operation order, no fma)
+// AVX2 uses fma (and lets the compiler contract), its results may differ from glm in the last bits
+namespace TransformKernels
+{
+enum struct Isa : u8
+{
+	Scalar,
+	SSE,
+	AVX2,
+};
+char const * to_string(Isa isa);
+
+// best one the cpu (and the os) supports
+Isa get_supported_isa();
+Isa get_isa();
+// clamped to the supported one, useful for comparing the kernels
+void set_isa(Isa isa);
+
+// matrices[i] = translate(positions[i]) * mat4_cast(rotations[i]) * scale(scales[i])
+void calculate_transforms(
+	usize count, f32x3 const * positions, f32quat const * rotations, f32x3 const * scales, f32x4x4 * matrices
+);
+
+// matrices[i] = parent_matrices[parent_indices[i]] * matrices[i]
+void apply_parents(usize count, f32x4x4 const * parent_matrices, u32 const * parent_indices, f32x4x4 * matrices);
+}
@@ -1,5 +1,7 @@
 #include "core_windows.hpp"
 
+#include <core/profiler.hpp>
+#include <core/transform_kernels.hpp>
 #include <file_io/core.hpp>
 #include <opengl/globals.hpp>
 
@@ -30,9 +32,9 @@ void GameWindow::init(Context const & ctx)
 	border.init(ctx, *this);
 
 	// Load gizmo meshes
-	for (auto & [_, mesh]: ctx.editor_assets.meshes)
+	for (auto & mesh: ctx.editor_assets.meshes.datas)
 		for (auto & drawable: mesh.drawables)
-			drawable.load();
+			drawable.load(ctx.game.instance_buffer);
 }
 
 void GameWindow::update(Context & ctx)
@@ -165,13 +167,14 @@ void GameWindow::render(Context const & ctx)
 
 		auto view = visit([](Render::Camera auto & c) { return c.get_view_without_translate(); }, ctx.game.camera);
 		auto proj = glm::ortho<f32>(-1, +1, -1, +1, -1, +1);
-		auto transform = proj * view;
+		auto & mesh = ctx.editor_assets.meshes.get("AxisGizmo:mesh:0:Cube"_name);
+		auto transform = proj * view * mesh.dequantization;
 		glUniformMatrix4fv(
 			GetLocation(gizmo_program.uniform_mappings, "transform"),
 			1, false, begin(transform)
 		);
 
-		for (auto & drawable: ctx.editor_assets.meshes.get("AxisGizmo:mesh:0:Cube"_name).drawables)
+		for (auto & drawable: mesh.drawables)
 		{
 			glBindVertexArray(drawable.vertex_array.id);
 			glDrawElements(GL_TRIANGLES, drawable.vertex_array.element_count, GL_UNSIGNED_INT, nullptr);
@@ -223,8 +226,8 @@ void GameWindow::Border::render(Context const & ctx, GameWindow const & game_win
 		return;
 
 	auto & [_, node_index] = *it;
-	auto const & node = scene_tree.get(node_index);
-	if (node.mesh == nullptr)
+	auto node = scene_tree.get(node_index);
+	if (node.mesh.is_null())
 		return;
 
 	using namespace GL;
@@ -243,16 +246,17 @@ void GameWindow::Border::render(Context const & ctx, GameWindow const & game_win
 	// initialize
 	glEnable(GL_SCISSOR_TEST), glScissor(i32x2(border_width), framebuffers[0].resolution - i32(2 * border_width));
 
-	auto & jump_flood_init_program = ctx.editor_assets.programs.get("jump_flood_init");
+	auto & jump_flood_init_program = ctx.editor_assets.programs.get("jump_flood_init"_name);
 	glUseProgram(jump_flood_init_program.id);
 	auto view = visit([](Render::Camera auto & c){ return c.get_view(); }, ctx.game.camera);
 	auto proj = visit([](Render::Camera auto & c){ return c.get_projection(); }, ctx.game.camera);
-	auto transform = proj * view * node.matrix;
+	auto & mesh = ctx.game.assets.meshes.get(node.mesh);
+	auto transform = proj * view * node.matrix * mesh.dequantization;
 	glUniformMatrix4fv(
 		GetLocation(jump_flood_init_program.uniform_mappings, "transform"),
 		1, false, begin(transform)
 	);
-	for (auto & drawable: node.mesh->drawables)
+	for (auto & drawable: mesh.drawables)
 	{
 		glBindVertexArray(drawable.vertex_array.id);
 		glDrawElements(GL_TRIANGLES, drawable.vertex_array.element_count, GL_UNSIGNED_INT, nullptr);
@@ -261,7 +265,7 @@ void GameWindow::Border::render(Context const & ctx, GameWindow const & game_win
 	glDisable(GL_SCISSOR_TEST);
 
 	// jump flood
-	auto & jump_flood_program = ctx.editor_assets.programs.get("jump_flood");
+	auto & jump_flood_program = ctx.editor_assets.programs.get("jump_flood"_name);
 	glUseProgram(jump_flood_program.id);
 
 	i32 step = glm::compMax(framebuffers[0].resolution) / 2;
@@ -287,7 +291,7 @@ void GameWindow::Border::render(Context const & ctx, GameWindow const & game_win
 
 	// finalize border
 	glViewport(i32x2(0), game_window.framebuffer.resolution);
-	auto & border_program = ctx.editor_assets.programs.get("finalize_border");
+	auto & border_program = ctx.editor_assets.programs.get("finalize_border"_name);
 	glUseProgram(border_program.id);
 	glBindFramebuffer(GL_FRAMEBUFFER, game_window.framebuffer.id);
 	glUniformHandleui64ARB(
@@ -326,6 +330,83 @@ void MetricsWindow::update(Context & ctx)
 	}
 
 	TextFMT("Frame: {:6}, Time: {:7.2f}", ctx.state.frame_info.idx, ctx.state.frame_info.seconds_since_start);
+
+	{
+		auto const & stats = ctx.game.render_stats;
+		TextFMT("Nodes:     {:6}, culled: {:6}", stats.node_count, stats.culled_node_count);
+		TextFMT("Drawables: {:6}, culled: {:6}", stats.drawable_count, stats.culled_drawable_count);
+		TextFMT("Meshlets:  {:6}, culled: {:6}", stats.meshlet_count, stats.culled_meshlet_count);
+		TextFMT("Draws:     {:6}, calls:  {:6}", stats.draw_count, stats.draw_call_count);
+		TextFMT("Triangles: {}", stats.triangle_count);
+		TextFMT("Binds, material: {}, vertex array: {}", stats.material_bind_count, stats.vertex_array_bind_count);
+		TextFMT(
+			"Instances: {:6}, groups: {:6}, ratio: {:.2f}",
+			stats.instance_count, stats.instance_group_count, ctx.game.instance_groups.get_ratio()
+		);
+
+		auto const & bvh = ctx.game.scene_bvh.bvh;
+		TextFMT("BVH nodes: {:6}, SAH cost: {:6.2f}", bvh.nodes.size(), bvh.calculate_cost());
+
+		auto const & ring = ctx.game.frame_ring_buffer.allocator;
+		TextFMT(
+			"Ring: {} KiB (peak {} KiB) of {} KiB per frame, waits: {}",
+			ring.last_frame_size >> 10, ring.peak_size >> 10, ring.segment_size >> 10, ring.wait_count
+		);
+
+		auto const & frame_allocator = Render::frame_allocator;
+		TextFMT(
+			"Frame allocator: {} KiB (peak {} KiB) of {} KiB, allocations: {}, overflows: {}",
+			frame_allocator.last_frame_size >> 10, frame_allocator.peak_size >> 10, frame_allocator.capacity >> 10,
+			frame_allocator.allocation_count, frame_allocator.overflow_count
+		);
+		TextFMT("Peak RSS: {} MiB", get_peak_rss() >> 20);
+		for (auto const & [name, arena]: ctx.game.assets.gltf_arena_stats)
+			TextFMT(
+				"Loaded {}: {} allocations, {} KiB in {} arena blocks",
+				name, arena.allocation_count, arena.allocated_size >> 10, arena.block_count
+			);
+	}
+
+
+	Spacing(), Separator(), Text("Profiler");
+
+	if (Profiler::is_capturing)
+	{
+		Text("Capturing...");
+		SameLine();
+		if (Button("Stop"))
+			Profiler::stop_capture();
+	}
+	else
+	{
+		u32 const min_count = 1, max_count = 120;
+		SliderScalar("Frames", ImGuiDataType_U32, &capture_frame_count, &min_count, &max_count);
+		if (Button("Capture frames"))
+			Profiler::capture_frames(capture_frame_count);
+
+		// the first capture is the startup
+		SameLine();
+		if (Button("Save last capture"))
+		{
+			auto path = ctx.game.assets.descriptions.root / "capture.json";
+			if (Profiler::save_chrome_trace(path))
+				fmt::print("Profiler capture is saved to {}\n", path);
+		}
+	}
+
+
+	Spacing(), Separator(), Text("Transform kernels");
+
+	using TransformKernels::Isa;
+	for (auto isa: {Isa::Scalar, Isa::SSE, Isa::AVX2})
+	{
+		BeginDisabled(TransformKernels::get_supported_isa() < isa);
+		if (RadioButton(TransformKernels::to_string(isa), TransformKernels::get_isa() == isa))
+			TransformKernels::set_isa(isa);
+		EndDisabled();
+		SameLine();
+	}
+	NewLine();
 }
 
 void UniformBufferWindow::update(Context & ctx)
@@ -335,10 +416,10 @@ void UniformBufferWindow::update(Context & ctx)
 	auto & uniform_blocks = ctx.game.assets.uniform_blocks;
 	auto & selected_name = ctx.state.selected_uniform_buffer_name;
 
-	if (BeginCombo("Uniform Buffer", selected_name.string.data()))
+	if (BeginCombo("Uniform Buffer", selected_name.string().data()))
 	{
 		for (auto const & [name, _]: uniform_blocks)
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name;
 
 		EndCombo();
@@ -365,7 +446,7 @@ void UniformBufferWindow::update(Context & ctx)
 
 			for (auto const & [key, variable]: uniform_buffer.variables)
 			{
-				TableNextColumn(), TextFMT("{}", key);
+				TableNextColumn(), TextFMT("{}", key.string());
 				TableNextColumn(), TextFMT("{}", variable.offset);
 				TableNextColumn(), TextFMT("{}", GL::glsl_uniform_type_to_string(variable.glsl_type));
 			}
@@ -390,12 +471,12 @@ void ProgramWindow::update(Context & ctx)
 
 	auto & selected_name = ctx.state.selected_program_name;
 
-	if (BeginCombo("Program", selected_name.string.data()))
+	if (BeginCombo("Program", selected_name.string().data()))
 	{
 		Selectable("Game", false, ImGuiSelectableFlags_Disabled);
 		for (auto const & [name, _]: ctx.game.assets.programs)
 		{
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, assets = &ctx.game.assets;
 
 			if (ctx.game.assets.program_errors.contains(name))
@@ -405,7 +486,7 @@ void ProgramWindow::update(Context & ctx)
 		Selectable("Editor", false, ImGuiSelectableFlags_Disabled);
 		for (auto const & [name, _]: ctx.editor_assets.programs)
 		{
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, assets = &ctx.editor_assets;
 
 			if (ctx.editor_assets.program_errors.contains(name))
@@ -570,10 +651,10 @@ void TextureWindow::update(Context & ctx)
 	auto & textures = ctx.game.assets.textures;
 	auto & selected_name = ctx.state.selected_texture_name;
 
-	if (BeginCombo("Texture", selected_name.string.data()))
+	if (BeginCombo("Texture", selected_name.string().data()))
 	{
 		for (auto & [name, _]: textures)
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, is_texture_changed = true;
 
 		EndCombo();
@@ -656,10 +737,10 @@ void CubemapWindow::update(Context & ctx)
 	auto & cubemaps = ctx.game.assets.texture_cubemaps;
 	auto & selected_name = ctx.state.selected_cubemap_name;
 
-	if (BeginCombo("Cubemap", selected_name.string.data()))
+	if (BeginCombo("Cubemap", selected_name.string().data()))
 	{
 		for (auto & [name, _]: cubemaps)
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, is_changed = true;
 
 		EndCombo();
@@ -726,7 +807,7 @@ void CubemapWindow::render(const Context & ctx)
 	glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.id);
 	glViewport(i32x2(0), framebuffer.resolution);
 
-	auto & environment_mapping_program = ctx.game.assets.programs.get("environment_mapping");
+	auto & environment_mapping_program = ctx.game.assets.programs.get("environment_mapping"_name);
 	glUseProgram(environment_mapping_program.id);
 	glUniformHandleui64ARB(
 		GetLocation(environment_mapping_program.uniform_mappings, "environment_map"),
@@ -804,10 +885,10 @@ void VolumeWindow::update(Context & ctx)
 	auto & volumes = ctx.game.assets.volumes;
 	auto & selected_name = ctx.state.selected_volume_name;
 
-	if (BeginCombo("Volume", selected_name.string.data()))
+	if (BeginCombo("Volume", selected_name.string().data()))
 	{
 		for (auto & [name, _]: volumes)
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, is_changed = true;
 
 		EndCombo();
@@ -887,7 +968,7 @@ void VolumeWindow::render(const Context & ctx)
 	f32 clear_depth(1);
 	glClearNamedFramebufferfv(framebuffer.id, GL_DEPTH, 0, &clear_depth);
 
-	auto & volume_slice_program = ctx.editor_assets.programs.get("volume_slice");
+	auto & volume_slice_program = ctx.editor_assets.programs.get("volume_slice"_name);
 	glUseProgram(volume_slice_program.id);
 	glUniformHandleui64ARB(
 		GetLocation(volume_slice_program.uniform_mappings, "volume"),
@@ -932,10 +1013,10 @@ void MeshWindow::update(Context & ctx)
 	auto & meshes = ctx.game.assets.meshes;
 	auto & selected_name = ctx.state.selected_mesh_name;
 
-	if (BeginCombo("Mesh", selected_name.string.data()))
+	if (BeginCombo("Mesh", selected_name.string().data()))
 	{
-		for (auto const & [name, _]: meshes)
-			if (Selectable(name.string.data()))
+		for (auto const & name: meshes.names)
+			if (Selectable(name.string().data()))
 				selected_name = name;
 
 		EndCombo();
@@ -948,6 +1029,18 @@ void MeshWindow::update(Context & ctx)
 	auto & mesh = meshes.get(selected_name);
 
 
+	// the drawables of a mesh share the layout they are quantized into
+	if (auto const & stats = mesh.quantization_stats; not mesh.drawables.empty() and stats.size != stats.source_size)
+	{
+		Spacing(), Separator(), Text("Quantization");
+
+		TextFMT("Vertex data: {} -> {} bytes", stats.source_size, stats.size);
+		auto const & layout = *mesh.drawables.front().primitive.layout;
+		for (auto a = 0; a < Geometry::ATTRIBUTE_COUNT; ++a)
+			if (auto const error = stats.errors.max_errors[a]; error != 0)
+				TextFMT("{} {} max error {:.3g}", layout.attributes[a].key, layout.attributes[a].type, error);
+	}
+
 	Spacing(), Separator(), Text("Drawables");
 
 	if (mesh.drawables.empty())
@@ -976,7 +1069,7 @@ void MeshWindow::update(Context & ctx)
 		{
 			if (Button("Load all drawables"))
 				for (auto & drawable: mesh.drawables)
-					drawable.load();
+					drawable.load(ctx.game.instance_buffer);
 		}
 	}
 
@@ -1013,7 +1106,7 @@ void MeshWindow::update(Context & ctx)
 
 
 	Spacing(), Separator();
-	LabelText("Material", "%s", drawable.named_material.name.string.data());
+	LabelText("Material", "%s", ctx.game.assets.materials.name_of(drawable.material).string().data());
 }
 
 void NodeEditor::update(Context & ctx)
@@ -1024,18 +1117,18 @@ void NodeEditor::update(Context & ctx)
 	auto & selected_name = ctx.state.selected_node_name;
 
 	bool node_changed = false;
-	if (BeginCombo("Node", selected_name.string.data()))
+	if (BeginCombo("Node", selected_name.string().data()))
 	{
 		// provide empty option to deselect
 		if (Selectable("##"))
 			selected_name = "", node_changed = true;
 
 		auto indent = GetStyle().IndentSpacing;
-		for (auto & node: scene_tree.depth_first())
+		for (auto node: scene_tree.depth_first())
 		{
 			if (node.depth) Indent(indent * node.depth);
 
-			if (Selectable(node.name.string.data()))
+			if (Selectable(node.name.string().data()))
 				selected_name = node.name, node_changed = true;
 
 			if (node.depth) Unindent(indent * node.depth);
@@ -1051,23 +1144,25 @@ void NodeEditor::update(Context & ctx)
 	else
 	{
 		auto & [_, node_index] = *it;
-		auto & node = scene_tree.get(node_index);
+		auto node = scene_tree.get(node_index);
 
 		auto const & parent_name = node.depth == 0
 								   ? "-"
-								   : scene_tree.get({node.depth - 1, node.parent_index}).name.string.data();
+								   : scene_tree.get({node.depth - 1, node.parent_index}).name.string().data();
 		LabelText("Parent", "%s", parent_name);
 
-		auto const & mesh_name = node.mesh == nullptr
+		auto const & mesh_name = node.mesh.is_null()
 								 ? "-"
-								 : "<TODO>";
+								 : ctx.game.assets.meshes.name_of(node.mesh).string().data();
 		LabelText("Mesh", "%s", mesh_name);
 
 
 		Spacing(), Separator(), Text("Transform");
 		auto & transform = node.transform;
 
-		SliderFloat3("Position", begin(transform.position), -2, 2, "%.2f");
+		bool is_transform_changed = false;
+
+		is_transform_changed |= SliderFloat3("Position", begin(transform.position), -2, 2, "%.2f");
 
 		if (node_changed)
 		{
@@ -1077,13 +1172,20 @@ void NodeEditor::update(Context & ctx)
 		if (SliderFloat3("Rotation", begin(mesh_orientation), 0, 360, "%.2f"))
 		{
 			transform.rotation = glm::quat(glm::radians(mesh_orientation));
+			is_transform_changed = true;
 		}
 
 		auto scalar_scale = transform.scale.x;
-		SliderFloat(
+		if (SliderFloat(
 			"Scale", &scalar_scale, 0.001, 10, "%.3f", ImGuiSliderFlags_Logarithmic | ImGuiSliderFlags_NoRoundToFormat
-		);
-		transform.scale = f32x3(scalar_scale);
+		))
+		{
+			transform.scale = f32x3(scalar_scale);
+			is_transform_changed = true;
+		}
+
+		if (is_transform_changed)
+			scene_tree.mark_dirty(node_index);
 	}
 }
 
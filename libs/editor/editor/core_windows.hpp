@@ -56,6 +56,8 @@ struct MetricsWindow : WindowBase
 	moving_average<30> average_game_update;
 	moving_average<30> average_game_render;
 
+	u32 capture_frame_count = 10;
+
 	void update(Context & ctx) override;
 };
 
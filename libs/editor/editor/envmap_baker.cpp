@@ -18,10 +18,10 @@ void EnvmapBakerWindow::update(Editor::Context & ctx)
 
 	Separator();
 
-	if (BeginCombo("Texture", selected_name.string.data()))
+	if (BeginCombo("Texture", selected_name.string().data()))
 	{
 		for (auto & [name, _]: textures)
-			if (Selectable(name.string.data()))
+			if (Selectable(name.string().data()))
 				selected_name = name, is_texture_changed = true;
 
 		EndCombo();
@@ -169,7 +169,7 @@ void EnvmapBakerWindow::generate_envmap(Editor::Context const & ctx) const
 
 		/// Map equirectangular into cubemap
 		auto const cubemap_face_dimensions = i32x2(1024);
-		auto cubemap_name = Name(selected_name.string + "_cubemap");
+		auto cubemap_name = Name(fmt::format("{}_cubemap", selected_name.string()));
 		auto & cubemap = cubemaps.get_or_generate(cubemap_name);
 		if (cubemap.id == 0)
 			cubemap.init(TextureCubemap::ImageDesc{
@@ -209,7 +209,7 @@ void EnvmapBakerWindow::generate_envmap(Editor::Context const & ctx) const
 
 		/// Generate diffuse envmap
 		auto const d_face_dimensions = i32x2(32);
-		auto d_name = Name(selected_name.string + "_diffuse");
+		auto d_name = Name(fmt::format("{}_diffuse", selected_name.string()));
 		auto & d_envmap = cubemaps.get_or_generate(d_name);
 		if (d_envmap.id == 0)
 			d_envmap.init(TextureCubemap::ImageDesc{
@@ -246,7 +246,7 @@ void EnvmapBakerWindow::generate_envmap(Editor::Context const & ctx) const
 
 		/// Generate specular envmap
 		auto const s_face_dimensions = i32x2(1024);
-		auto s_name = Name(selected_name.string + "_specular");
+		auto s_name = Name(fmt::format("{}_specular", selected_name.string()));
 		auto & s_envmap = cubemaps.get_or_generate(s_name);
 		if (s_envmap.id == 0)
 			s_envmap.init(TextureCubemap::ImageDesc{
@@ -298,7 +298,7 @@ void EnvmapBakerWindow::generate_envmap(Editor::Context const & ctx) const
 
 
 		/// Save textures
-		auto asset_dir = ctx.game.assets.descriptions.root / "envmap" / selected_name.string;
+		auto asset_dir = ctx.game.assets.descriptions.root / "envmap" / selected_name.string();
 
 		if (std::filesystem::exists(asset_dir))
 		{
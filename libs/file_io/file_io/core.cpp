@@ -40,6 +40,17 @@ ByteBuffer LoadAsBytes(std::filesystem::path const & path, usize file_size)
 	return buffer;
 }
 
+ByteBuffer LoadAsBytes(std::filesystem::path const & path, usize file_size, std::pmr::memory_resource & resource)
+{
+	assert(std::filesystem::exists(path));
+	std::basic_ifstream<byte> file(path, std::ios::in | std::ios::binary);
+
+	ByteBuffer buffer(file_size, resource);
+	file.read(buffer.data.get(), file_size);
+
+	return buffer;
+}
+
 std::string LoadAsString(std::filesystem::path const & path)
 {
 	assert(std::filesystem::exists(path));
@@ -9,6 +9,8 @@ ByteBuffer LoadAsBytes(std::filesystem::path const & path);
 
 ByteBuffer LoadAsBytes(std::filesystem::path const & path, usize file_size);
 
+ByteBuffer LoadAsBytes(std::filesystem::path const & path, usize file_size, std::pmr::memory_resource & resource);
+
 std::string LoadAsString(std::filesystem::path const & path);
 
 struct Image
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "core.hpp"
+
+#include <core/named.hpp>
+
+namespace GL
+{
+// A variable of a uniform or storage block, get_ref resolves it once so setting it is a single copy
+struct VariableRef
+{
+	u32 offset;
+	GLenum glsl_type;
+};
+
+// glsl type a C++ type is written as, GL_NONE if there is no single match (then it is not checked)
+template<typename T>
+consteval GLenum glsl_type_of()
+{
+	if constexpr (std::same_as<T, f32>) return GL_FLOAT;
+	else if constexpr (std::same_as<T, f64>) return GL_DOUBLE;
+	else if constexpr (std::same_as<T, f32x2>) return GL_FLOAT_VEC2;
+	else if constexpr (std::same_as<T, f32x3>) return GL_FLOAT_VEC3;
+	else if constexpr (std::same_as<T, f32x4>) return GL_FLOAT_VEC4;
+	else if constexpr (std::same_as<T, i32>) return GL_INT;
+	else if constexpr (std::same_as<T, i32x2>) return GL_INT_VEC2;
+	else if constexpr (std::same_as<T, i32x3>) return GL_INT_VEC3;
+	else if constexpr (std::same_as<T, i32x4>) return GL_INT_VEC4;
+	else if constexpr (std::same_as<T, u32>) return GL_UNSIGNED_INT;
+	else if constexpr (std::same_as<T, u32x2>) return GL_UNSIGNED_INT_VEC2;
+	else if constexpr (std::same_as<T, u32x3>) return GL_UNSIGNED_INT_VEC3;
+	else if constexpr (std::same_as<T, u32x4>) return GL_UNSIGNED_INT_VEC4;
+	else if constexpr (std::same_as<T, i64>) return GL_INT64_ARB;
+	else if constexpr (std::same_as<T, u64>) return GL_UNSIGNED_INT64_ARB;
+	else if constexpr (std::same_as<T, bool>) return GL_BOOL;
+	else if constexpr (std::same_as<T, f32x4x4>) return GL_FLOAT_MAT4;
+	else return GL_NONE;
+}
+
+// debug builds check the C++ type against the glsl type
+template<typename T>
+void write_variable(byte * destination, VariableRef const & variable, T const & data)
+{
+	if constexpr (glsl_type_of<T>() != GL_NONE)
+		assert(variable.glsl_type == glsl_type_of<T>(), "C++ type does not match the glsl type of the variable");
+
+	std::memcpy(destination + variable.offset, &data, sizeof(T));
+}
+
+template<typename T>
+void read_variable(byte const * source, VariableRef const & variable, T & destination)
+{
+	if constexpr (glsl_type_of<T>() != GL_NONE)
+		assert(variable.glsl_type == glsl_type_of<T>(), "C++ type does not match the glsl type of the variable");
+
+	std::memcpy(&destination, source + variable.offset, sizeof(T));
+}
+
+// a member of a C++ struct that mirrors a block, see UniformBlock::is_layout_of
+struct StructMember
+{
+	Name key;
+	u32 offset;
+	GLenum glsl_type;
+};
+#define GL_STRUCT_MEMBER(Struct, member, key) \
+    GL::StructMember{key, u32(offsetof(Struct, member)), GL::glsl_type_of<decltype(Struct::member)>()}
+
+// true if every variable has a member with the same offset and type, so the struct can be copied as a whole
+template<typename Variables>
+bool is_layout_of(Variables const & variables, u32 data_size, usize struct_size, std::initializer_list<StructMember> members)
+{
+	if (struct_size > data_size or members.size() != variables.size())
+		return false;
+
+	for (auto const & member: members)
+	{
+		auto const it = variables.find(member.key);
+		if (it == variables.end())
+			return false;
+
+		auto const & variable = it->second;
+		if (variable.offset != member.offset)
+			return false;
+		if (member.glsl_type != GL_NONE and variable.glsl_type != member.glsl_type)
+			return false;
+	}
+	return true;
+}
+}
@@ -36,22 +36,29 @@ struct MappedBuffer : OpenGLObject
 //		);
 //	}
 
-//	struct EmptyDesc
-//	{
-//		GLenum usage = GL_STATIC_DRAW;
-//		usize size;
-//	};
-//
-//	void init(EmptyDesc const &  desc)
-//	{
-//		glCreateBuffers(1, &id);
-//		glNamedBufferData(
-//			id,
-//			 desc.size,
-//			nullptr,
-//			 desc.usage
-//		);
-//	}
+	struct EmptyDesc
+	{
+		BufferStorageMask usage = GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT;
+		BufferAccessMask access = GL_MAP_PERSISTENT_BIT | GL_MAP_WRITE_BIT | GL_MAP_FLUSH_EXPLICIT_BIT;
+		usize size;
+	};
+
+	void init(EmptyDesc const & desc)
+	{
+		glCreateBuffers(1, &id);
+		glNamedBufferStorage(
+			id,
+			desc.size,
+			nullptr,
+			desc.usage
+		);
+
+		map = (byte *) glMapNamedBufferRange(
+			id,
+			0, desc.size,
+			desc.access
+		);
+	}
 
 	struct UniformBlockDesc
 	{
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <core/allocators.hpp>
+
+#include "core.hpp"
+
+namespace GL
+{
+struct SyncFences
+{
+	using Fence = GLsync;
+
+	Fence insert()
+	{ return glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT); }
+
+	void wait(Fence fence)
+	{
+		// the flush makes sure the fence gets signaled eventually
+		while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1'000'000'000) == GL_TIMEOUT_EXPIRED)
+			;
+	}
+
+	void release(Fence fence)
+	{ glDeleteSync(fence); }
+};
+
+// Persistently mapped buffer for the data that does not outlive the frame (see Render::GameBase::frame_ring_buffer)
+// A segment per frame in flight, so writing this frame's data never races with the gpu reading the previous frames'
+struct RingBuffer : OpenGLObject
+{
+	RingAllocator<SyncFences> allocator;
+	byte * map = nullptr;
+
+	CTOR(RingBuffer, default);
+	COPY(RingBuffer, delete);
+	MOVE(RingBuffer, delete);
+
+	~RingBuffer()
+	{
+		// the gpu may still be reading the last frames
+		allocator.wait_all();
+		glDeleteBuffers(1, &id);
+	}
+
+	struct Desc
+	{
+		u32 segment_count = 3;
+		usize segment_size;
+	};
+
+	void init(Desc const & desc)
+	{
+		// any allocation can be bound as a uniform or a storage block
+		i32 uniform_alignment, storage_alignment;
+		glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &uniform_alignment);
+		glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &storage_alignment);
+
+		allocator.init({
+			.segment_count = desc.segment_count,
+			.segment_size = desc.segment_size,
+			.alignment = usize(glm::max(16, glm::max(uniform_alignment, storage_alignment))),
+		});
+		create_storage();
+	}
+
+	void begin_frame()
+	{ allocator.begin_frame(); }
+
+	void end_frame()
+	{ allocator.end_frame(); }
+
+	// only before the first allocation of a frame, waits for the gpu when the segments grow
+	void reserve(usize segment_size)
+	{
+		if (segment_size <= allocator.segment_size)
+			return;
+
+		allocator.resize(glm::max(segment_size, allocator.segment_size * 2));
+		glDeleteBuffers(1, &id);
+		create_storage();
+	}
+
+	struct Allocation
+	{
+		byte * pointer;
+		usize offset; // from the start of the buffer
+		usize size;
+	};
+
+	Allocation allocate(usize size)
+	{
+		auto offset = allocator.allocate(size);
+		assert(offset.has_value(), "RingBuffer segment is full, reserve more at the start of the frame");
+		return {.pointer = map + *offset, .offset = *offset, .size = size};
+	}
+
+	template<typename T>
+	Allocation allocate_copy(span<T const> data)
+	{
+		auto allocation = allocate(data.size_bytes());
+		std::memcpy(allocation.pointer, data.data(), data.size_bytes());
+		return allocation;
+	}
+
+	void bind(GLenum target, u32 binding, Allocation const & allocation) const
+	{ glBindBufferRange(target, binding, id, allocation.offset, allocation.size); }
+
+	void create_storage()
+	{
+		// coherent, so the writes need no flushes
+		glCreateBuffers(1, &id);
+		glNamedBufferStorage(
+			id,
+			allocator.get_capacity(),
+			nullptr,
+			GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_MAP_WRITE_BIT
+		);
+		map = (byte *) glMapNamedBufferRange(
+			id,
+			0, allocator.get_capacity(),
+			GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT | GL_MAP_WRITE_BIT
+		);
+	}
+};
+}
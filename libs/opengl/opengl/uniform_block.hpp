@@ -2,6 +2,10 @@
 
 #include "core.hpp"
 #include "shader_mappings.hpp"
+#include "block_variable.hpp"
+
+#include <core/named.hpp>
+#include <core/flat_map.hpp>
 
 namespace GL
 {
@@ -12,13 +16,8 @@ struct UniformBlock
 	usize aligned_size;
 	std::string key;
 
-	struct Variable
-	{
-		u32 offset;
-		GLenum glsl_type;
-	};
-	// TODO(bekorn): Name can be utilized here to reduce string hashing
-	std::unordered_map<std::string, Variable> variables;
+	using Variable = VariableRef;
+	FlatMap<Name, Variable, Name::Hasher> variables;
 
 	struct Desc
 	{
@@ -42,22 +41,36 @@ struct UniformBlock
 			});
 	}
 
+	// resolve once, then set without the lookup
+	VariableRef get_ref(Name const & variable_key) const
+	{ return variables.at(variable_key); }
+
 	template<typename T>
-	void set(byte * destination, std::string const & variable_key, T const & data) const
-	{
-		std::memcpy(
-			destination + variables.at(variable_key).offset,
-			&data, sizeof(T)
-		);
-	}
+	void set(byte * destination, VariableRef const & variable, T const & data) const
+	{ write_variable(destination, variable, data); }
+
+	template<typename T>
+	void set(byte * destination, Name const & variable_key, T const & data) const
+	{ write_variable(destination, variables.at(variable_key), data); }
+
+	template<typename T>
+	void get(const byte * buffer, VariableRef const & variable, T & destination) const
+	{ read_variable(buffer, variable, destination); }
+
+	template<typename T>
+	void get(const byte * buffer, Name const & variable_key, T & destination) const
+	{ read_variable(buffer, variables.at(variable_key), destination); }
+
+	bool is_layout_of(usize struct_size, std::initializer_list<StructMember> members) const
+	{ return GL::is_layout_of(variables, data_size, struct_size, members); }
 
+	// only for structs that pass is_layout_of
 	template<typename T>
-	void get(const byte * buffer, std::string const & variable_key, T & destination) const
+	void set_struct(byte * destination, T const & data) const
 	{
-		std::memcpy(
-			&destination,
-			buffer + variables.at(variable_key).offset, sizeof(T)
-		);
+		static_assert(std::is_trivially_copyable_v<T>);
+		assert(sizeof(T) <= data_size, "Struct is larger than the uniform block");
+		std::memcpy(destination, &data, sizeof(T));
 	}
 };
 }
\ No newline at end of file
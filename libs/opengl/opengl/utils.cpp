@@ -234,6 +234,7 @@ GLenum to_glenum(Geometry::Type::Value type)
 	switch (type)
 	{
 	case F32: return GL_FLOAT;
+	case F16: return GL_HALF_FLOAT;
 	case I8:
 	case I8NORM: return GL_BYTE;
 	case I16:
@@ -16,6 +16,14 @@ struct VertexArray : OpenGLObject
 	Buffer element_buffer;
 	GLsizei element_count;
 
+	// the full detail elements then the lods of the primitive, [0] is the full detail
+	struct ElementRange
+	{
+		u32 first;
+		u32 count;
+	};
+	vector<ElementRange> element_ranges;
+
 	CTOR(VertexArray, default);
 	COPY(VertexArray, delete);
 	MOVE(VertexArray, default);
@@ -77,10 +85,24 @@ struct VertexArray : OpenGLObject
 			buffer_offset += static_cast<GLintptr>(buffer.size);
 		}
 
-		element_buffer.init(Buffer::Desc{
+		element_ranges.clear();
+		element_ranges.push_back({.first = 0, .count = u32(desc.primitive.indices.size())});
+		for (auto const & lod: desc.primitive.lods)
+		{
+			auto const & last = element_ranges.back();
+			element_ranges.push_back({.first = last.first + last.count, .count = u32(lod.indices.size())});
+		}
+
+		element_buffer.init(Buffer::EmptyDesc{
 			.usage = desc.usage,
-			.data = span((byte *) desc.primitive.indices.data(), desc.primitive.indices.size() * sizeof(u32)),
+			.size = (element_ranges.back().first + element_ranges.back().count) * sizeof(u32),
 		});
+		glNamedBufferSubData(element_buffer.id, 0, desc.primitive.indices.size() * sizeof(u32), desc.primitive.indices.data());
+		for (usize i = 0; i < desc.primitive.lods.size(); ++i)
+		{
+			auto const & [first, count] = element_ranges[i + 1];
+			glNamedBufferSubData(element_buffer.id, first * sizeof(u32), count * sizeof(u32), desc.primitive.lods[i].indices.data());
+		}
 
 		glVertexArrayElementBuffer(id, element_buffer.id);
 
@@ -143,6 +165,28 @@ struct VertexArray : OpenGLObject
 		glVertexArrayElementBuffer(id, element_buffer.id);
 
 		element_count = desc.element_count;
+		element_ranges = {{.first = 0, .count = u32(desc.element_count)}};
+	}
+
+	// a mat4 per instance in 4 consecutive locations, offset by the base instance of the draw
+	struct InstanceMatrixDesc
+	{
+		Buffer const & buffer;
+		u32 location;
+		u32 binding;
+	};
+
+	void add_instance_matrix(InstanceMatrixDesc const & desc)
+	{
+		glVertexArrayVertexBuffer(id, desc.binding, desc.buffer.id, 0, sizeof(f32x4x4));
+		glVertexArrayBindingDivisor(id, desc.binding, 1);
+
+		for (u32 column = 0; column < 4; ++column)
+		{
+			glVertexArrayAttribFormat(id, desc.location + column, 4, GL_FLOAT, false, column * sizeof(f32x4));
+			glEnableVertexArrayAttrib(id, desc.location + column);
+			glVertexArrayAttribBinding(id, desc.location + column, desc.binding);
+		}
 	}
 
 	void update(Geometry::Primitive const & primitive)
@@ -0,0 +1,106 @@
+# Generates a C++ struct with the std430 layout of a block from a json schema
+# usage: cmake -DSCHEMA=<schema.json> -DOUTPUT=<header.hpp> -P std430_struct.cmake
+#
+# schema: {"name", "namespace", "block", "members": [{"name", "type"}]}
+#  "block" prefixes the variable keys as the shader introspection reports them ("<block>.<member>")
+#  types are glsl scalars, vectors, mat4 and uint64_t/int64_t (bindless handles), arrays are not supported
+
+cmake_minimum_required(VERSION 3.20)
+
+if (NOT DEFINED SCHEMA OR NOT DEFINED OUTPUT)
+    message(FATAL_ERROR "SCHEMA and OUTPUT must be defined")
+endif ()
+
+# glsl type -> C++ type, size, std430 alignment
+function(std430_type glsl_type out_cpp out_size out_alignment)
+    set(types
+        "float:f32:4:4"       "vec2:f32x2:8:8"      "vec3:f32x3:12:16"     "vec4:f32x4:16:16"
+        "int:i32:4:4"         "ivec2:i32x2:8:8"     "ivec3:i32x3:12:16"    "ivec4:i32x4:16:16"
+        "uint:u32:4:4"        "uvec2:u32x2:8:8"     "uvec3:u32x3:12:16"    "uvec4:u32x4:16:16"
+        "int64_t:i64:8:8"     "uint64_t:u64:8:8"    "mat4:f32x4x4:64:16"
+    )
+    foreach (type IN LISTS types)
+        string(REPLACE ":" ";" type "${type}")
+        list(GET type 0 glsl)
+        if (glsl STREQUAL glsl_type)
+            list(GET type 1 cpp)
+            list(GET type 2 size)
+            list(GET type 3 alignment)
+            set(${out_cpp} ${cpp} PARENT_SCOPE)
+            set(${out_size} ${size} PARENT_SCOPE)
+            set(${out_alignment} ${alignment} PARENT_SCOPE)
+            return()
+        endif ()
+    endforeach ()
+    message(FATAL_ERROR "${SCHEMA}: type ${glsl_type} is not supported")
+endfunction()
+
+file(READ ${SCHEMA} schema)
+string(JSON name GET ${schema} name)
+string(JSON namespace GET ${schema} namespace)
+string(JSON block GET ${schema} block)
+string(JSON member_count LENGTH ${schema} members)
+get_filename_component(schema_name ${SCHEMA} NAME)
+
+set(fields "")
+set(layout_members "")
+set(asserts "")
+set(offset 0)
+set(struct_alignment 1)
+set(pad_count 0)
+
+math(EXPR last_member "${member_count} - 1")
+foreach (i RANGE ${last_member})
+    string(JSON member_name GET ${schema} members ${i} name)
+    string(JSON member_type GET ${schema} members ${i} type)
+    std430_type(${member_type} cpp size alignment)
+
+    math(EXPR aligned_offset "(${offset} + ${alignment} - 1) / ${alignment} * ${alignment}")
+    if (aligned_offset GREATER offset)
+        math(EXPR pad_size "${aligned_offset} - ${offset}")
+        string(APPEND fields "\tu8 _pad${pad_count}[${pad_size}]{};\n")
+        math(EXPR pad_count "${pad_count} + 1")
+    endif ()
+    if (alignment GREATER struct_alignment)
+        set(struct_alignment ${alignment})
+    endif ()
+
+    string(APPEND fields "\t${cpp} ${member_name}{};\n")
+    string(APPEND layout_members "\t\t\tGL_STRUCT_MEMBER(${name}, ${member_name}, \"${block}.${member_name}\"),\n")
+    string(APPEND asserts "static_assert(offsetof(${name}, ${member_name}) == ${aligned_offset});\n")
+    math(EXPR offset "${aligned_offset} + ${size}")
+endforeach ()
+
+# array stride, the struct is aligned to its largest member
+math(EXPR struct_size "(${offset} + ${struct_alignment} - 1) / ${struct_alignment} * ${struct_alignment}")
+if (struct_size GREATER offset)
+    math(EXPR pad_size "${struct_size} - ${offset}")
+    string(APPEND fields "\tu8 _pad${pad_count}[${pad_size}]{};\n")
+endif ()
+
+set(header "// generated from ${schema_name} by std430_struct.cmake, do not edit
+#pragma once
+
+#include <core/core.hpp>
+#include <opengl/block_variable.hpp>
+
+namespace ${namespace}
+{
+// std430 layout of the ${block} block, an array of these is a valid buffer of the block
+struct alignas(${struct_alignment}) ${name}
+{
+${fields}
+	// the shader's block must have exactly these variables
+	template<typename Block>
+	static bool is_layout_of(Block const & block)
+	{
+		return block.is_layout_of(sizeof(${name}), {
+${layout_members}		});
+	}
+};
+${asserts}static_assert(sizeof(${name}) == ${struct_size});
+static_assert(std::is_trivially_copyable_v<${name}>);
+}
+")
+
+file(WRITE ${OUTPUT} "${header}")
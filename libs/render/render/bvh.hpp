@@ -0,0 +1,467 @@
+#pragma once
+
+#include <core/core.hpp>
+#include <core/bounds.hpp>
+#include <core/named.hpp>
+#include <core/profiler.hpp>
+
+#include "scene.hpp"
+#include "mesh.hpp"
+
+namespace Render
+{
+// Bounding volume hierarchy over items with boxes, built with binned SAH
+// When the boxes change, refit recalculates the node boxes and rotate fixes the worst of the degradation
+// see Wald, On fast Construction of SAH-based Bounding Volume Hierarchies (2007)
+// and Kopta et al., Fast, Effective BVH Updates for Animated Scenes (2012)
+struct BVH
+{
+	static constexpr u32 BIN_COUNT = 16;
+	static constexpr u32 MAX_LEAF_SIZE = 4;
+	static constexpr u32 NONE = std::numeric_limits<u32>::max();
+
+	struct Node
+	{
+		Geometry::AABB box;
+		u32 parent = NONE;
+		u32 left = NONE;
+		u32 right = NONE;
+		u32 first_item = 0; // in item_order
+		u32 item_count = 0;
+
+		bool is_leaf() const
+		{ return left == NONE; }
+	};
+	vector<Node> nodes; // root is the first one
+	vector<Geometry::AABB> item_boxes;
+	vector<u32> item_order; // leaves refer to the ranges of this
+
+	vector<u32> _postorder; // reused by refit and rotate
+
+	// only during build, partitioned in place so every node's items stay contiguous
+	struct BuildItem
+	{
+		Geometry::AABB box;
+		f32x3 centroid;
+		u32 item;
+	};
+	vector<BuildItem> _build_items;
+
+	usize size() const
+	{ return item_boxes.size(); }
+
+	void build(span<Geometry::AABB const> boxes)
+	{
+		PROFILE_ZONE("BVH::build");
+
+		item_boxes.assign(boxes.begin(), boxes.end());
+		item_order.resize(boxes.size());
+
+		nodes.clear();
+		if (boxes.empty())
+			return;
+
+		_build_items.resize(boxes.size());
+		for (u32 i = 0; i < boxes.size(); ++i)
+			_build_items[i] = {.box = boxes[i], .centroid = boxes[i].center(), .item = i};
+
+		nodes.reserve(2 * boxes.size() / MAX_LEAF_SIZE + 1);
+		nodes.push_back({.first_item = 0, .item_count = u32(boxes.size())});
+
+		vector<u32> stack{0};
+		while (not stack.empty())
+		{
+			auto node_index = stack.back();
+			stack.pop_back();
+
+			if (auto split = find_split(nodes[node_index]); split.has_value())
+			{
+				auto [left, right] = *split;
+				left.parent = right.parent = node_index;
+
+				u32 left_index = nodes.size(), right_index = nodes.size() + 1;
+				auto & node = nodes[node_index];
+				node.left = left_index;
+				node.right = right_index;
+				node.item_count = 0;
+
+				// invalidates node
+				nodes.push_back(left);
+				nodes.push_back(right);
+				stack.push_back(left_index);
+				stack.push_back(right_index);
+			}
+		}
+
+		for (u32 i = 0; i < _build_items.size(); ++i)
+			item_order[i] = _build_items[i].item;
+		_build_items = {};
+	}
+
+	void set_item_box(u32 item, Geometry::AABB const & box)
+	{ item_boxes[item] = box; }
+
+	// recalculates the node boxes from the item boxes
+	void refit()
+	{
+		PROFILE_ZONE("BVH::refit");
+
+		calculate_postorder();
+		for (auto node_index: _postorder)
+			update_box(node_index);
+	}
+
+	// swaps a child with a grandchild when it makes the child smaller, expects fitting boxes
+	// returns the number of rotations
+	u32 rotate()
+	{
+		PROFILE_ZONE("BVH::rotate");
+
+		u32 rotation_count = 0;
+		calculate_postorder();
+		for (auto node_index: _postorder)
+		{
+			auto & node = nodes[node_index];
+			if (node.is_leaf())
+				continue;
+
+			// (child that is kept, grandchild under the other child, node to swap with it)
+			struct Rotation
+			{
+				u32 parent_of_grandchild;
+				u32 grandchild;
+				u32 child;
+				f32 area_reduction;
+			} best{.area_reduction = 0};
+
+			auto const consider = [&](u32 child, u32 other_child)
+			{
+				auto const & other = nodes[other_child];
+				if (other.is_leaf())
+					return;
+
+				auto old_area = other.box.surface_area();
+				for (auto [grandchild, sibling]: {std::pair{other.left, other.right}, std::pair{other.right, other.left}})
+				{
+					// child takes the place of grandchild, other_child's box becomes child + sibling
+					auto new_box = nodes[child].box;
+					new_box.expand(nodes[sibling].box);
+					auto reduction = old_area - new_box.surface_area();
+					if (reduction > best.area_reduction)
+						best = {.parent_of_grandchild = other_child, .grandchild = grandchild, .child = child, .area_reduction = reduction};
+				}
+			};
+			consider(node.left, node.right);
+			consider(node.right, node.left);
+
+			if (best.area_reduction <= 0)
+				continue;
+
+			// swap the places of child and grandchild
+			auto & child_slot = node.left == best.child ? node.left : node.right;
+			auto & other = nodes[best.parent_of_grandchild];
+			auto & grandchild_slot = other.left == best.grandchild ? other.left : other.right;
+
+			child_slot = best.grandchild;
+			grandchild_slot = best.child;
+			nodes[best.grandchild].parent = node_index;
+			nodes[best.child].parent = best.parent_of_grandchild;
+
+			update_box(best.parent_of_grandchild);
+			rotation_count++;
+		}
+		return rotation_count;
+	}
+
+	// calls f(item) for the items whose box intersects the frustum
+	template<typename F>
+	void query(Geometry::Frustum const & frustum, F && f) const
+	{ traverse([&frustum](Geometry::AABB const & box) { return frustum.intersects(box); }, f); }
+
+	// calls f(item) for the items whose box overlaps the box
+	template<typename F>
+	void query(Geometry::AABB const & range, F && f) const
+	{
+		auto const overlaps = [&range](Geometry::AABB const & box)
+		{ return all(lessThanEqual(range.min, box.max)) and all(lessThanEqual(box.min, range.max)); };
+		traverse(overlaps, f);
+	}
+
+	struct RayHit
+	{
+		u32 item;
+		f32 distance;
+	};
+
+	// nearest item box along the ray
+	optional<RayHit> raycast(Geometry::Ray const & ray) const
+	{
+		if (nodes.empty())
+			return nullopt;
+
+		auto const inverse_direction = 1.f / ray.direction;
+		optional<RayHit> nearest;
+		auto max_distance = ray.max_distance;
+
+		vector<u32> stack{0};
+		while (not stack.empty())
+		{
+			auto const & node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (not node.box.intersect_ray(ray.origin, inverse_direction, max_distance).has_value())
+				continue;
+
+			if (node.is_leaf())
+			{
+				for (auto i = node.first_item; i < node.first_item + node.item_count; ++i)
+				{
+					auto item = item_order[i];
+					if (auto distance = item_boxes[item].intersect_ray(ray.origin, inverse_direction, max_distance))
+					{
+						nearest = RayHit{.item = item, .distance = *distance};
+						max_distance = *distance;
+					}
+				}
+			}
+			else
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+		return nearest;
+	}
+
+	// SAH cost relative to the root, useful to see how much refits degrade the tree
+	f32 calculate_cost() const
+	{
+		if (nodes.empty())
+			return 0;
+
+		f32 cost = 0;
+		for (auto const & node: nodes)
+			cost += node.box.surface_area() * (node.is_leaf() ? node.item_count : 1);
+		return cost / nodes[0].box.surface_area();
+	}
+
+	template<typename Test, typename F>
+	void traverse(Test const & test, F & f) const
+	{
+		if (nodes.empty())
+			return;
+
+		vector<u32> stack{0};
+		while (not stack.empty())
+		{
+			auto const & node = nodes[stack.back()];
+			stack.pop_back();
+
+			if (not test(node.box))
+				continue;
+
+			if (node.is_leaf())
+			{
+				for (auto i = node.first_item; i < node.first_item + node.item_count; ++i)
+					if (test(item_boxes[item_order[i]]))
+						f(item_order[i]);
+			}
+			else
+			{
+				stack.push_back(node.right);
+				stack.push_back(node.left);
+			}
+		}
+	}
+
+	void update_box(u32 node_index)
+	{
+		auto & node = nodes[node_index];
+		node.box = {};
+		if (node.is_leaf())
+			for (auto i = node.first_item; i < node.first_item + node.item_count; ++i)
+				node.box.expand(item_boxes[item_order[i]]);
+		else
+			node.box.expand(nodes[node.left].box), node.box.expand(nodes[node.right].box);
+	}
+
+	void calculate_postorder()
+	{
+		_postorder.clear();
+		if (nodes.empty())
+			return;
+
+		// reversed (node, right, left) preorder is a postorder
+		vector<u32> stack{0};
+		while (not stack.empty())
+		{
+			auto node_index = stack.back();
+			stack.pop_back();
+			_postorder.push_back(node_index);
+
+			auto const & node = nodes[node_index];
+			if (not node.is_leaf())
+			{
+				stack.push_back(node.left);
+				stack.push_back(node.right);
+			}
+		}
+		std::ranges::reverse(_postorder);
+	}
+
+	// fills the node's box, returns the children if splitting is cheaper than keeping a leaf
+	optional<std::pair<Node, Node>> find_split(Node & node)
+	{
+		span<BuildItem> items(_build_items.data() + node.first_item, node.item_count);
+
+		Geometry::AABB centroid_box;
+		for (auto const & item: items)
+		{
+			node.box.expand(item.box);
+			centroid_box.expand(item.centroid);
+		}
+
+		if (node.item_count <= MAX_LEAF_SIZE)
+			return nullopt;
+
+		struct Bin
+		{
+			Geometry::AABB box;
+			u32 count = 0;
+		};
+
+		auto const centroid_extent = centroid_box.max - centroid_box.min;
+		auto const bin_scale = f32(BIN_COUNT) / centroid_extent; // inf on flat axes, they are skipped
+		auto const bin_of = [&](BuildItem const & item, u32 axis)
+		{
+			auto bin = u32((item.centroid[axis] - centroid_box.min[axis]) * bin_scale[axis]);
+			return glm::min(bin, BIN_COUNT - 1);
+		};
+
+		f32 best_cost = std::numeric_limits<f32>::max();
+		u32 best_axis = 0, best_split = 0;
+		for (u32 axis = 0; axis < 3; ++axis)
+		{
+			if (centroid_extent[axis] <= 0)
+				continue;
+
+			array<Bin, BIN_COUNT> bins;
+			for (auto const & item: items)
+			{
+				auto & bin = bins[bin_of(item, axis)];
+				bin.box.expand(item.box);
+				bin.count++;
+			}
+
+			// right to left sweep, then left to right evaluates every split
+			array<f32, BIN_COUNT> right_costs;
+			Geometry::AABB right_box;
+			u32 right_count = 0;
+			for (u32 i = BIN_COUNT - 1; i > 0; --i)
+			{
+				right_box.expand(bins[i].box);
+				right_count += bins[i].count;
+				right_costs[i] = right_count == 0 ? 0 : right_box.surface_area() * right_count;
+			}
+
+			Geometry::AABB left_box;
+			u32 left_count = 0;
+			for (u32 split = 1; split < BIN_COUNT; ++split)
+			{
+				left_box.expand(bins[split - 1].box);
+				left_count += bins[split - 1].count;
+				if (left_count == 0 or left_count == node.item_count)
+					continue;
+
+				auto cost = left_box.surface_area() * left_count + right_costs[split];
+				if (cost < best_cost)
+					best_cost = cost, best_axis = axis, best_split = split;
+			}
+		}
+
+		// all centroids are at the same point, no split can separate them
+		if (best_cost == std::numeric_limits<f32>::max())
+			return nullopt;
+
+		auto const leaf_cost = node.box.surface_area() * node.item_count;
+		if (best_cost >= leaf_cost and node.item_count <= 4 * MAX_LEAF_SIZE)
+			return nullopt;
+
+		auto middle = std::partition(
+			items.begin(), items.end(), [&](BuildItem const & item) { return bin_of(item, best_axis) < best_split; }
+		);
+		auto left_count = u32(middle - items.begin());
+		return std::pair{
+			Node{.first_item = node.first_item, .item_count = left_count},
+			Node{.first_item = node.first_item + left_count, .item_count = node.item_count - left_count},
+		};
+	}
+};
+
+// Keeps a BVH over the Scene::Tree nodes that have meshes, rebuilt when nodes are added, refitted when they move
+struct SceneBVH
+{
+	BVH bvh;
+	vector<Scene::Tree::Index> item2node;
+	vector<vector<u32>> node2item; // per level, BVH::NONE for the nodes without a mesh
+	optional<u32> tree_version;
+
+	// rotating after every refit keeps the tree from degrading over time
+	bool should_rotate = true;
+
+	static Geometry::AABB world_box_of(
+		Scene::Tree const & tree, Scene::Tree::Index const & index, DenseManaged<Mesh> const & meshes
+	)
+	{
+		auto const & level = tree.levels[index.depth];
+		Geometry::AABB box;
+		for (auto const & drawable: meshes.get(level.meshes[index.index]).drawables)
+			box.expand(drawable.primitive.bounds.box.transformed(level.matrices[index.index]));
+		return box;
+	}
+
+	// changed_indices is the result of Scene::Tree::update_transforms
+	void update(Scene::Tree const & tree, DenseManaged<Mesh> const & meshes, span<Scene::Tree::Index const> changed_indices)
+	{
+		if (tree_version != tree.version)
+		{
+			rebuild(tree, meshes);
+			return;
+		}
+
+		if (changed_indices.empty())
+			return;
+
+		for (auto const & index: changed_indices)
+			if (auto item = node2item[index.depth][index.index]; item != BVH::NONE)
+				bvh.set_item_box(item, world_box_of(tree, index, meshes));
+
+		bvh.refit();
+		if (should_rotate)
+			bvh.rotate();
+	}
+
+	void rebuild(Scene::Tree const & tree, DenseManaged<Mesh> const & meshes)
+	{
+		tree_version = tree.version;
+		item2node.clear();
+		node2item.resize(tree.levels.size());
+
+		vector<Geometry::AABB> boxes;
+		for (u32 depth = 0; depth < tree.levels.size(); ++depth)
+		{
+			auto const & level = tree.levels[depth];
+			node2item[depth].assign(level.size(), BVH::NONE);
+			for (u32 i = 0; i < level.size(); ++i)
+				if (not level.meshes[i].is_null())
+				{
+					node2item[depth][i] = item2node.size();
+					item2node.push_back({depth, i});
+					boxes.push_back(world_box_of(tree, {depth, i}, meshes));
+				}
+		}
+
+		bvh.build(boxes);
+	}
+};
+}
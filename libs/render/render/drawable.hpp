@@ -10,20 +10,29 @@ namespace Render
 struct Drawable
 {
 	Geometry::Primitive const & primitive;
-	Named<unique_one<IMaterial>> const named_material;
+	Handle<Material_gltf_pbrMetallicRoughness> material;
 
 	GL::VertexArray vertex_array;
 
+	// every vertex array reads the instance matrices from the same buffer (see GameBase::instance_buffer)
+	static constexpr u32 INSTANCE_MATRIX_LOCATION = 12;
+	static constexpr u32 INSTANCE_MATRIX_BINDING = 15;
+
 	bool is_loaded() const
 	{
 		return vertex_array.id != 0;
 	}
 
-	void load()
+	void load(GL::Buffer const & instance_buffer)
 	{
 		vertex_array.init(GL::VertexArray::Desc{
 			.primitive = primitive
 		});
+		vertex_array.add_instance_matrix(GL::VertexArray::InstanceMatrixDesc{
+			.buffer = instance_buffer,
+			.location = INSTANCE_MATRIX_LOCATION,
+			.binding = INSTANCE_MATRIX_BINDING,
+		});
 	}
 
 	void unload()
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <core/core.hpp>
+#include <core/allocators.hpp>
 
 namespace Render
 {
@@ -10,4 +11,7 @@ struct FrameInfo
 	f64 seconds_since_start;
 	f32 seconds_since_last_frame;
 };
+
+// for the data that does not outlive the frame, reset at the start of every frame
+inline FrameAllocator frame_allocator;
 }
\ No newline at end of file
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "camera.hpp"
+#include "bvh.hpp"
+#include "render_queue.hpp"
+#include "instancing.hpp"
 
+#include <opengl/ring_buffer.hpp>
 #include <render/glfw.hpp>
 #include <asset_recipes/assets.hpp>
 
@@ -19,8 +23,37 @@ struct GameBase
 	f32 clear_depth = 1;
 	GL::FrameBuffer framebuffer;
 
+	// for the gpu data that does not outlive the frame, fenced so the gpu is done with a segment before it is rewritten
+	// owned here so it is deleted while the GL context is alive
+	GL::RingBuffer frame_ring_buffer;
+
 	variant<PerspectiveCamera, OrthographicCamera> camera;
 
+	// over assets.scene_tree, for culling and the editor queries
+	SceneBVH scene_bvh;
+	RenderQueue render_queue;
+	InstanceGroups instance_groups;
+	// of instance_groups.matrices, the instanced draws refill it, every drawable is loaded with it
+	GL::Buffer instance_buffer;
+
+	// of the last render
+	struct RenderStats
+	{
+		u32 node_count = 0; // with a mesh
+		u32 culled_node_count = 0;
+		u32 drawable_count = 0; // of the visible nodes
+		u32 culled_drawable_count = 0;
+		u32 meshlet_count = 0; // of the meshlet culled drawables
+		u32 culled_meshlet_count = 0;
+		u32 draw_count = 0;
+		u32 triangle_count = 0;
+		u32 draw_call_count = 0;
+		u32 material_bind_count = 0;
+		u32 vertex_array_bind_count = 0;
+		u32 instance_count = 0;
+		u32 instance_group_count = 0;
+	} render_stats;
+
 	virtual ~GameBase() = default;
 
 	virtual void init() = 0;
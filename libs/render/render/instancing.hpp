@@ -0,0 +1,68 @@
+#pragma once
+
+#include <core/core.hpp>
+#include <core/named.hpp>
+#include <core/profiler.hpp>
+
+#include "mesh.hpp"
+
+namespace Render
+{
+// Visible nodes grouped by their mesh, each drawable of a mesh is drawn once for all the instances
+// deterministic, groups are ordered by the mesh slot and the instances keep their input order
+struct InstanceGroups
+{
+	struct Group
+	{
+		Handle<Mesh> mesh;
+		u32 first_instance;
+		u32 instance_count;
+	};
+	vector<Group> groups;
+	vector<f32x4x4> matrices; // of the instances, group by group
+	vector<u32> _offsets; // reused, per mesh slot
+	vector<Handle<Mesh>> _slot_meshes; // reused
+
+	void clear()
+	{
+		groups.clear();
+		matrices.clear();
+	}
+
+	// counting sort over the mesh slots
+	void build(span<Handle<Mesh> const> meshes, span<f32x4x4 const * const> instance_matrices)
+	{
+		PROFILE_ZONE("InstanceGroups::build");
+
+		assert(meshes.size() == instance_matrices.size());
+		clear();
+
+		u32 slot_count = 0;
+		for (auto const & mesh: meshes)
+			slot_count = glm::max(slot_count, mesh.index + 1);
+
+		_offsets.assign(slot_count + 1, 0);
+		_slot_meshes.resize(slot_count);
+		for (auto const & mesh: meshes)
+		{
+			_offsets[mesh.index + 1]++;
+			_slot_meshes[mesh.index] = mesh;
+		}
+
+		for (u32 slot = 0; slot < slot_count; ++slot)
+		{
+			if (auto count = _offsets[slot + 1]; count != 0)
+				groups.push_back({.mesh = _slot_meshes[slot], .first_instance = _offsets[slot], .instance_count = count});
+			_offsets[slot + 1] += _offsets[slot];
+		}
+
+		matrices.resize(meshes.size());
+		for (usize i = 0; i < meshes.size(); ++i)
+			matrices[_offsets[meshes[i].index]++] = *instance_matrices[i];
+	}
+
+	// instances per group, 1 means nothing is shared
+	f32 get_ratio() const
+	{ return groups.empty() ? 0 : f32(matrices.size()) / f32(groups.size()); }
+};
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <core/geometry.hpp>
+
+namespace Render
+{
+// Picks the lod of a primitive by how many pixels its error covers on the screen,
+// an object space error e at the distance d covers e * scale * pixels_per_unit / d pixels (no / d in orthographic)
+struct LodSelector
+{
+	f32x3 camera_position;
+	f32 pixels_per_unit; // at the unit distance in perspective
+	bool is_perspective;
+	f32 pixel_error; // the most a lod may deviate on the screen
+
+	static LodSelector make(f32x4x4 const & projection, f32x3 const & camera_position, i32 viewport_height, f32 pixel_error)
+	{
+		return {
+			.camera_position = camera_position,
+			.pixels_per_unit = projection[1][1] * f32(viewport_height) * 0.5f,
+			.is_perspective = projection[3][3] == 0,
+			.pixel_error = pixel_error,
+		};
+	}
+
+	// the closest point of the world box decides, so the whole primitive is within the pixel error
+	u32 select(Geometry::Primitive const & primitive, f32x4x4 const & matrix, Geometry::AABB const & world_box) const
+	{
+		if (primitive.lods.empty())
+			return 0;
+
+		f32 distance = 1;
+		if (is_perspective)
+		{
+			auto const outside = glm::max(glm::abs(camera_position - world_box.center()) - world_box.half_extent(), f32x3(0));
+			distance = glm::length(outside);
+			if (distance == 0) // inside the box
+				return 0;
+		}
+
+		// non-uniform scales are covered by the longest axis, like Sphere::transformed
+		auto const length_squared = [](f32x4 const & v)
+		{ return glm::dot(f32x3(v), f32x3(v)); };
+		auto const scale = glm::sqrt(glm::max(
+			glm::max(length_squared(matrix[0]), length_squared(matrix[1])), length_squared(matrix[2])
+		));
+
+		return primitive.select_lod(pixel_error * distance / (pixels_per_unit * scale));
+	}
+};
+}
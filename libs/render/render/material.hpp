@@ -3,71 +3,30 @@
 #include <opengl/core.hpp>
 #include <opengl/storage_block.hpp>
 
+// generated from codegen/material_gltf_pbrMetallicRoughness.json
+#include <render/material_gltf_pbrMetallicRoughness.hpp>
+
 namespace Render
 {
-struct IMaterial
-{
-	// the functionality should be compatible with any shader,
-	// but the data should be tightly coupled with individual shaders
-
-	// TODO(bekorn): maybe generate the concrete Material structs with another program then compile this program.
-	//  implication: no dynamic materials! for rendering purposes, ok. However, for an editor, this can be bad.
-	//  maybe: the material class can be C-simple that it can be loaded dynamically on runtime (via a dll).
-	//   so jit compile the generated Material into a dll and watch for changed dlls on this side.
-
-	virtual GL::StorageBlock const & get_block() const = 0;
-	virtual void write_to_buffer(byte * buffer) const = 0;
-	virtual void read_from_buffer(const byte * buffer) = 0;
-};
+// Materials are plain structs in the std430 layout of their shader's block, generated at build time,
+// so a material is uploaded with a memcpy and an array of them is a valid buffer of the block
+// implication: no dynamic materials, a new material type needs a new schema (see libs/render/codegen)
 
-// for now, here is an example concrete Material
-struct Material_gltf_pbrMetallicRoughness final : IMaterial
+struct Material_gltf_pbrMetallicRoughness : Generated::Material_gltf_pbrMetallicRoughness
 {
 	static inline GL::StorageBlock block;
 
-	GL::StorageBlock const & get_block() const final
-	{ return block; }
-
-	u64 base_color_texture_handle{0};
-	f32x4 base_color_factor{0, 0, 0, 0};
-
-	u64 metallic_roughness_texture_handle{0};
-	f32x2 metallic_roughness_factor{0, 0};
-
-	u64 emissive_texture_handle{0};
-	f32x3 emissive_factor{0, 0, 0};
-
-	u64 occlusion_texture_handle{0};
-	u64 normal_texture_handle{0};
-
-	void write_to_buffer(byte * buffer) const final
+	static void init_block(GL::StorageBlock::Desc const & desc)
 	{
-		block.set(buffer, "Material.base_color_texture_handle", base_color_texture_handle);
-		block.set(buffer, "Material.base_color_factor", base_color_factor);
-
-		block.set(buffer, "Material.metallic_roughness_texture_handle", metallic_roughness_texture_handle);
-		block.set(buffer, "Material.metallic_roughness_factor", metallic_roughness_factor);
-
-		block.set(buffer, "Material.emissive_texture_handle", emissive_texture_handle);
-		block.set(buffer, "Material.emissive_factor", emissive_factor);
-
-		block.set(buffer, "Material.occlusion_texture_handle", occlusion_texture_handle);
-		block.set(buffer, "Material.normal_texture_handle", normal_texture_handle);
+		block.init(desc);
+		assert(is_layout_of(block), "Material block of the shader does not match material_gltf_pbrMetallicRoughness.json");
 	}
 
-	void read_from_buffer(const byte * buffer) final
-	{
-		block.get(buffer, "Material.base_color_texture_handle", base_color_texture_handle);
-		block.get(buffer, "Material.base_color_factor", base_color_factor);
-
-		block.get(buffer, "Material.metallic_roughness_texture_handle", metallic_roughness_texture_handle);
-		block.get(buffer, "Material.metallic_roughness_factor", metallic_roughness_factor);
+	byte * data()
+	{ return reinterpret_cast<byte *>(this); }
 
-		block.get(buffer, "Material.emissive_texture_handle", emissive_texture_handle);
-		block.get(buffer, "Material.emissive_factor", emissive_factor);
-
-		block.get(buffer, "Material.occlusion_texture_handle", occlusion_texture_handle);
-		block.get(buffer, "Material.normal_texture_handle", normal_texture_handle);
-	}
+	byte const * data() const
+	{ return reinterpret_cast<byte const *>(this); }
 };
-}
\ No newline at end of file
+static_assert(sizeof(Material_gltf_pbrMetallicRoughness) == sizeof(Generated::Material_gltf_pbrMetallicRoughness));
+}
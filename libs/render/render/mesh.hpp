@@ -1,6 +1,7 @@
 #pragma once
 
 #include <core/core.hpp>
+#include <core/quantize.hpp>
 
 #include "drawable.hpp"
 
@@ -9,6 +10,17 @@ namespace Render
 struct Mesh
 {
 	vector<Drawable> drawables;
+	// quantized positions into object space, applied after the node matrix (see Geometry::Quantization)
+	f32x4x4 dequantization = f32x4x4(1);
+
+	// what the quantization at load saved and cost, summed and maxed over the drawables
+	struct QuantizationStats
+	{
+		usize source_size = 0; // vertex data before quantize, in bytes
+		usize size = 0;
+		Geometry::QuantizationErrors errors;
+	};
+	QuantizationStats quantization_stats;
 
 	CTOR(Mesh, default)
 	COPY(Mesh, delete)
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <core/meshlet.hpp>
+
+namespace Render
+{
+// Culls the meshlets of a primitive on the cpu, by the frustum and by their normal cones (see Geometry::is_backfacing)
+// the visible ones are merged into runs of consecutive meshlets, as ranges of the primitive's indices
+struct MeshletCuller
+{
+	Geometry::Frustum frustum;
+	f32x4 eye; // world space
+
+	static MeshletCuller make(Geometry::Frustum const & frustum, f32x4x4 const & view, f32x4x4 const & projection)
+	{
+		auto const inverse_view = glm::inverse(view);
+		return {
+			.frustum = frustum,
+			// the camera position, or its +z (towards the camera) in orthographic
+			.eye = projection[3][3] == 0 ? inverse_view[3] : inverse_view[2],
+		};
+	}
+
+	// emit(first_index, index_count) per run, returns how many meshlets are culled
+	u32 cull(Geometry::Primitive const & primitive, f32x4x4 const & matrix, auto && emit) const
+	{
+		// a mirroring matrix flips the winding the gpu culls by, only the frustum is tested then
+		auto const is_mirrored = glm::determinant(f32x3x3(matrix)) < 0;
+		auto const object_eye = glm::inverse(matrix) * eye;
+
+		u32 culled_count = 0;
+		u32 run_first = 0, run_count = 0; // in triangles
+		for (auto const & meshlet: primitive.meshlets)
+		{
+			auto const is_visible = frustum.intersects(meshlet.sphere.transformed(matrix)) and
+									(is_mirrored or not Geometry::is_backfacing(meshlet, object_eye));
+			if (not is_visible)
+			{
+				culled_count++;
+				continue;
+			}
+
+			if (run_count != 0 and run_first + run_count == meshlet.first_triangle)
+			{
+				run_count += meshlet.triangle_count;
+				continue;
+			}
+
+			if (run_count != 0)
+				emit(run_first * 3, run_count * 3);
+			run_first = meshlet.first_triangle, run_count = meshlet.triangle_count;
+		}
+		if (run_count != 0)
+			emit(run_first * 3, run_count * 3);
+
+		return culled_count;
+	}
+};
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <core/core.hpp>
+#include <core/geometry.hpp>
+#include <core/profiler.hpp>
+#include <opengl/vao.hpp>
+#include <opengl/ring_buffer.hpp>
+
+#include <unordered_map>
+
+namespace Render
+{
+// as glMultiDrawElementsIndirect reads it
+struct DrawElementsIndirectCommand
+{
+	u32 count;
+	u32 instance_count;
+	u32 first_index;
+	i32 base_vertex;
+	u32 base_instance;
+};
+static_assert(sizeof(DrawElementsIndirectCommand) == 5 * 4);
+
+// std430 layout of the Draw struct in the indirect shaders
+struct DrawData
+{
+	u32 transform_index; // into the per frame transform buffer
+	u32 material_index;
+};
+static_assert(sizeof(DrawData) == 8);
+
+// Primitives of the same layout packed into one primitive, attribute by attribute
+// indices stay relative to their primitive, the draws offset them with base_vertex
+struct MergedGeometry
+{
+	struct Range
+	{
+		u32 first_index;
+		u32 index_count;
+		i32 base_vertex;
+	};
+
+	Geometry::Primitive primitive;
+	vector<Range> ranges; // in the order of the packed primitives
+
+	void pack(Geometry::Layout const & layout, span<Geometry::Primitive const * const> primitives)
+	{
+		primitive.layout = &layout;
+		ranges.clear();
+		ranges.reserve(primitives.size());
+
+		// any used attribute gives the vertex count
+		auto const first_used = std::ranges::find_if(layout.attributes, &Geometry::Attribute::is_used);
+		assert(first_used != layout.attributes.end(), "Layout has no attributes");
+		auto const first_used_idx = first_used - layout.attributes.begin();
+
+		u32 vertex_count = 0, index_count = 0;
+		for (auto const * p: primitives)
+		{
+			assert(p->layout == &layout, "Primitives must share the layout");
+			auto const primitive_vertex_count = u32(p->data.buffers[first_used_idx].size / first_used->type.vector_size());
+
+			ranges.push_back({
+				.first_index = index_count,
+				.index_count = u32(p->indices.size()),
+				.base_vertex = i32(vertex_count),
+			});
+			vertex_count += primitive_vertex_count;
+			index_count += p->indices.size();
+		}
+
+		for (auto i = 0; i < Geometry::ATTRIBUTE_COUNT; ++i)
+		{
+			auto const & attribute = layout.attributes[i];
+			if (not attribute.is_used())
+			{
+				primitive.data.buffers[i] = {};
+				continue;
+			}
+
+			auto & buffer = primitive.data.buffers[i];
+			buffer = ByteBuffer(usize(vertex_count) * attribute.type.vector_size());
+
+			usize offset = 0;
+			for (auto const * p: primitives)
+			{
+				auto const & source = p->data.buffers[i];
+				std::memcpy(buffer.begin() + offset, source.begin(), source.size);
+				offset += source.size;
+			}
+			assert(offset == buffer.size, "Attribute sizes do not match the vertex counts");
+		}
+
+		primitive.indices.clear();
+		primitive.indices.reserve(index_count);
+		for (auto const * p: primitives)
+			primitive.indices.insert(primitive.indices.end(), p->indices.begin(), p->indices.end());
+
+		primitive.calculate_bounds();
+	}
+};
+
+// commands and per draw data of a frame, draw i reads draws[gl_DrawID]
+struct IndirectCommands
+{
+	vector<DrawElementsIndirectCommand> commands;
+	vector<DrawData> draws;
+
+	void clear()
+	{
+		commands.clear();
+		draws.clear();
+	}
+
+	void push(MergedGeometry::Range const & range, u32 transform_index, u32 material_index)
+	{
+		commands.push_back({
+			.count = range.index_count,
+			.instance_count = 1,
+			.first_index = range.first_index,
+			.base_vertex = range.base_vertex,
+			.base_instance = u32(draws.size()),
+		});
+		draws.push_back({
+			.transform_index = transform_index,
+			.material_index = material_index,
+		});
+	}
+};
+
+// One merged vertex array and one glMultiDrawElementsIndirect per layout
+// pack and push are cpu only, load and upload need a context
+struct MultiDraw
+{
+	static constexpr u32 DRAW_BINDING = 4; // of the Draws block in the indirect shaders
+
+	struct Batch
+	{
+		MergedGeometry geometry;
+		IndirectCommands commands;
+
+		GL::VertexArray vertex_array;
+		// of the current frame
+		GL::RingBuffer::Allocation command_allocation;
+		GL::RingBuffer::Allocation draw_allocation;
+	};
+	vector<Batch> batches;
+
+	struct Location
+	{
+		u32 batch_index;
+		MergedGeometry::Range range;
+	};
+	std::unordered_map<Geometry::Primitive const *, Location> locations;
+
+	// duplicates are packed once
+	void pack(span<Geometry::Primitive const * const> primitives)
+	{
+		PROFILE_ZONE("MultiDraw::pack");
+
+		batches.clear();
+		locations.clear();
+
+		vector<Geometry::Layout const *> layouts;
+		vector<vector<Geometry::Primitive const *>> primitives_per_layout;
+		for (auto const * primitive: primitives)
+		{
+			if (locations.contains(primitive))
+				continue;
+
+			auto layout_idx = std::ranges::find(layouts, primitive->layout) - layouts.begin();
+			if (layout_idx == layouts.size())
+			{
+				layouts.push_back(primitive->layout);
+				primitives_per_layout.emplace_back();
+			}
+			primitives_per_layout[layout_idx].push_back(primitive);
+			locations.emplace(primitive, Location{.batch_index = u32(layout_idx)});
+		}
+
+		batches.resize(layouts.size());
+		for (auto i = 0; i < layouts.size(); ++i)
+		{
+			auto const & layout_primitives = primitives_per_layout[i];
+			auto & geometry = batches[i].geometry;
+			geometry.pack(*layouts[i], layout_primitives);
+
+			for (auto j = 0; j < layout_primitives.size(); ++j)
+				locations.at(layout_primitives[j]).range = geometry.ranges[j];
+		}
+	}
+
+	void load()
+	{
+		for (auto & batch: batches)
+		{
+			batch.vertex_array.init(GL::VertexArray::Desc{
+				.primitive = batch.geometry.primitive,
+			});
+		}
+	}
+
+	void clear()
+	{
+		for (auto & batch: batches)
+			batch.commands.clear();
+	}
+
+	void push(Geometry::Primitive const & primitive, u32 transform_index, u32 material_index)
+	{
+		auto const & [batch_index, range] = locations.at(&primitive);
+		batches[batch_index].commands.push(range, transform_index, material_index);
+	}
+
+	void upload(GL::RingBuffer & ring)
+	{
+		for (auto & batch: batches)
+		{
+			auto const & [commands, draws] = batch.commands;
+			if (commands.empty())
+				continue;
+
+			batch.command_allocation = ring.allocate_copy(span<DrawElementsIndirectCommand const>(commands));
+			batch.draw_allocation = ring.allocate_copy(span<DrawData const>(draws));
+		}
+	}
+};
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <core/core.hpp>
+#include <core/profiler.hpp>
+
+#include <bit>
+
+namespace Render
+{
+// 64 bit draw sort key, the most significant field changes the least often when submitting in order
+// | pass 4 | program 12 | material 16 | vertex array 16 | depth 16 |
+// ids are truncated to their fields, a collision only worsens the order, the binds are still compared by value
+struct SortKey
+{
+	enum struct Pass : u8
+	{
+		Opaque,
+		Transparent,
+	};
+
+	static u64 make(Pass pass, u32 program, u32 material_index, u32 vertex_array, f32 depth)
+	{
+		// positive floats keep their order as integers, the top 16 bits are a coarse but monotonic depth
+		auto depth_bits = std::bit_cast<u32>(glm::max(depth, 0.f)) >> 16;
+		if (pass == Pass::Transparent)
+			depth_bits = 0xFFFF - depth_bits; // back to front
+
+		return u64(u8(pass) & 0xF) << 60
+			   | u64(program & 0xFFF) << 48
+			   | u64(material_index & 0xFFFF) << 32
+			   | u64(vertex_array & 0xFFFF) << 16
+			   | u64(depth_bits);
+	}
+};
+
+// Draws are pushed as (key, index into the caller's draw list) and sorted with an LSD radix sort
+struct RenderQueue
+{
+	struct Entry
+	{
+		u64 key;
+		u32 index;
+	};
+	vector<Entry> entries;
+	vector<Entry> _scratch; // reused between sorts
+
+	void clear()
+	{ entries.clear(); }
+
+	void push(u64 key, u32 index)
+	{ entries.push_back({key, index}); }
+
+	// stable, 8 passes of 8 bits, the passes where every key has the same byte are skipped
+	void sort()
+	{
+		PROFILE_ZONE("RenderQueue::sort");
+
+		constexpr u32 DIGIT_BITS = 8, RADIX = 1 << DIGIT_BITS, PASS_COUNT = 64 / DIGIT_BITS;
+
+		array<array<u32, RADIX>, PASS_COUNT> histograms{};
+		for (auto const & entry: entries)
+			for (u32 pass = 0; pass < PASS_COUNT; ++pass)
+				histograms[pass][(entry.key >> (pass * DIGIT_BITS)) & (RADIX - 1)]++;
+
+		_scratch.resize(entries.size());
+		for (u32 pass = 0; pass < PASS_COUNT; ++pass)
+		{
+			auto & histogram = histograms[pass];
+			if (std::ranges::find(histogram, entries.size()) != histogram.end())
+				continue;
+
+			// histogram into offsets
+			u32 offset = 0;
+			for (auto & count: histogram)
+				count = std::exchange(offset, offset + count);
+
+			for (auto const & entry: entries)
+				_scratch[histogram[(entry.key >> (pass * DIGIT_BITS)) & (RADIX - 1)]++] = entry;
+
+			entries.swap(_scratch);
+		}
+	}
+};
+}
@@ -4,6 +4,10 @@
 
 #include <core/core.hpp>
 #include <core/utils.hpp>
+#include <core/flat_map.hpp>
+#include <core/profiler.hpp>
+#include <core/jobs.hpp>
+#include <core/transform_kernels.hpp>
 #include <render/mesh.hpp>
 
 namespace Scene
@@ -14,7 +18,7 @@ struct Transform
 	f32quat rotation{1, 0, 0, 0};
 	f32x3 scale{1, 1, 1};
 
-	f32x4x4 calculate_transform() const
+	static f32x4x4 calculate_transform(f32x3 const & position, f32quat const & rotation, f32x3 const & scale)
 	{
 		f32x4x4 transform = glm::mat4_cast(rotation);
 
@@ -28,113 +32,418 @@ struct Transform
 
 		return transform;
 	}
+
+	f32x4x4 calculate_transform() const
+	{ return calculate_transform(position, rotation, scale); }
 };
 
+// Nodes are stored per depth (level) as structure of arrays, the hot transform data is contiguous
+// and the names are kept in a cold table, so updating the transforms and drawing does not touch them
 struct Tree
 {
+	// description of a node, only used to add them
 	struct Node
 	{
 		Name name;
 		u32 depth;
 		u32 parent_index;
 		Transform transform;
-		f32x4x4 matrix;
-		Render::Mesh * mesh = nullptr;
+		Handle<Render::Mesh> mesh;
+	};
+
+	struct Level
+	{
+		// hot
+		vector<f32x3> positions;
+		vector<f32quat> rotations;
+		vector<f32x3> scales;
+		vector<f32x4x4> matrices;
+		vector<u32> parent_indices; // in the previous level
+		vector<Handle<Render::Mesh>> meshes;
+		vector<u8> is_dirty; // transform is modified, set by mark_dirty
+		vector<u8> is_changed; // matrix is recalculated by the last update_transforms
+		bool has_dirty = false;
+		bool has_changed = false;
+		// cold
+		vector<Name> names;
+
+		usize size() const
+		{ return names.size(); }
 	};
-	vector<vector<Node>> nodes{1}; // root depth always exists
+	vector<Level> levels{1}; // root depth always exists
 
 	struct Index
 	{
 		u32 depth;
 		u32 index;
 	};
-	Managed<Index> named_indices;
+	FlatMap<Name, Index, Name::Hasher> named_indices;
 
 	u32 version = 0;
 
+	bool has_dirty = false;
+	vector<Index> changed_indices; // by the last update_transforms
+
+	// references into the levels, invalidated by add
+	struct TransformRef
+	{
+		f32x3 & position;
+		f32quat & rotation;
+		f32x3 & scale;
+
+		f32x4x4 calculate_transform() const
+		{ return Transform::calculate_transform(position, rotation, scale); }
+	};
+
+	struct NodeRef
+	{
+		Name const & name;
+		u32 depth;
+		u32 parent_index;
+		TransformRef transform;
+		f32x4x4 & matrix;
+		Handle<Render::Mesh> & mesh;
+	};
+
 	Index add(Node const & node)
 	{
 		version++;
 
-		if (nodes.size() < node.depth + 1)
-			nodes.resize(node.depth + 1);
+		if (levels.size() < node.depth + 1)
+			levels.resize(node.depth + 1);
+
+		auto & level = levels[node.depth];
+		auto index = Index{.depth = node.depth, .index = u32(level.size())};
 
-		auto index = Index{.depth = node.depth, .index = u32(nodes[node.depth].size())};
+		level.positions.push_back(node.transform.position);
+		level.rotations.push_back(node.transform.rotation);
+		level.scales.push_back(node.transform.scale);
+		level.matrices.push_back(f32x4x4(1));
+		level.parent_indices.push_back(node.parent_index);
+		level.meshes.push_back(node.mesh);
+		level.is_dirty.push_back(true);
+		level.is_changed.push_back(false);
+		level.names.push_back(node.name);
+		level.has_dirty = has_dirty = true;
 
-		nodes[index.depth].push_back(node);
-		named_indices.generate(node.name, index);
+		if (not named_indices.try_emplace(node.name, index).second)
+			fmt::print(stderr, "!! Resource is not emplaced: {}\n", node.name);
 
 		return index;
 	}
 
-	Node & get(Index const & index)
-	{ return nodes[index.depth][index.index]; }
+	NodeRef get(Index const & index)
+	{
+		auto & level = levels[index.depth];
+		auto const i = index.index;
+		return {
+			.name = level.names[i],
+			.depth = index.depth,
+			.parent_index = level.parent_indices[i],
+			.transform = {
+				.position = level.positions[i],
+				.rotation = level.rotations[i],
+				.scale = level.scales[i],
+			},
+			.matrix = level.matrices[i],
+			.mesh = level.meshes[i],
+		};
+	}
+
+	// must be called after modifying the transform of a node, its subtree is updated too
+	void mark_dirty(Index const & index)
+	{
+		auto & level = levels[index.depth];
+		level.is_dirty[index.index] = true;
+		level.has_dirty = has_dirty = true;
+	}
+
+	void set_transform(Index const & index, Transform const & transform)
+	{
+		auto & level = levels[index.depth];
+		level.positions[index.index] = transform.position;
+		level.rotations[index.index] = transform.rotation;
+		level.scales[index.index] = transform.scale;
+		mark_dirty(index);
+	}
 
 	usize size() const
 	{
 		usize size = 0;
-		for (auto & depth : nodes)
-			size += depth.size();
+		for (auto & level: levels)
+			size += level.size();
 		return size;
 	}
 
-	void update_transforms()
+	// levels smaller than the threshold are not worth distributing to the workers
+	static constexpr u32 PARALLEL_LEVEL_THRESHOLD = 4096;
+	static constexpr u32 PARALLEL_BATCH_SIZE = 1024;
+
+	// only recalculates the dirty nodes and their subtrees, level by level
+	// every node depends only on the previous level, so a level is split into batches for the workers
+	// returns the nodes whose matrix has changed, valid until the next call
+	vector<Index> const & update_transforms(bool is_parallel = true)
 	{
-		for (auto & node: nodes[0])
-			node.matrix = node.transform.calculate_transform();
+		changed_indices.clear();
+		if (not has_dirty)
+			return changed_indices;
+
+		bool is_parent_level_changed = false;
+		for (u32 depth = 0; depth < levels.size(); ++depth)
+		{
+			auto & level = levels[depth];
+
+			if (not level.has_dirty and not is_parent_level_changed)
+			{
+				// nothing can change in this level, only the stale flags of the previous update are cleared
+				if (level.has_changed)
+					std::ranges::fill(level.is_changed, false), level.has_changed = false;
+				is_parent_level_changed = false;
+				continue;
+			}
+
+			if (is_parallel and level.size() >= PARALLEL_LEVEL_THRESHOLD)
+				Jobs::parallel_for(
+					level.size(), PARALLEL_BATCH_SIZE, [this, depth](usize begin, usize end)
+					{ update_level_transforms(depth, begin, end); }
+				);
+			else
+				update_level_transforms(depth, 0, level.size());
 
-		for (auto depth = 1; depth < nodes.size(); ++depth)
-			for (auto & node: nodes[depth])
-				node.matrix = nodes[depth - 1][node.parent_index].matrix * node.transform.calculate_transform();
+			// gathered afterwards to keep the batches independent
+			level.has_changed = false;
+			for (u32 i = 0; i < level.size(); ++i)
+				if (level.is_changed[i])
+				{
+					changed_indices.push_back({depth, i});
+					level.has_changed = true;
+				}
+			std::ranges::fill(level.is_dirty, false);
+			level.has_dirty = false;
+			is_parent_level_changed = level.has_changed;
+		}
+
+		has_dirty = false;
+		return changed_indices;
 	}
 
+	// writes only the [begin, end) range of the level, reads the previous level
+	void update_level_transforms(u32 depth, usize begin, usize end)
+	{
+		auto & level = levels[depth];
+		u8 const * parent_is_changed = depth == 0 ? nullptr : levels[depth - 1].is_changed.data();
+		f32x4x4 const * parent_matrices = depth == 0 ? nullptr : levels[depth - 1].matrices.data();
+
+		for (auto i = begin; i < end; ++i)
+			level.is_changed[i] = level.is_dirty[i] or (parent_is_changed and parent_is_changed[level.parent_indices[i]]);
+
+		// consecutive changed nodes are calculated in batches
+		for (auto i = begin; i < end;)
+		{
+			if (not level.is_changed[i])
+			{
+				++i;
+				continue;
+			}
+
+			auto run_end = i + 1;
+			while (run_end < end and level.is_changed[run_end])
+				++run_end;
+
+			auto const count = run_end - i;
+			TransformKernels::calculate_transforms(
+				count, &level.positions[i], &level.rotations[i], &level.scales[i], &level.matrices[i]
+			);
+			if (depth != 0)
+				TransformKernels::apply_parents(count, parent_matrices, &level.parent_indices[i], &level.matrices[i]);
+
+			i = run_end;
+		}
+	}
+
+	// world matrices of the given nodes back to back, destination must fit indices.size() matrices
+	void gather_matrices(span<Index const> indices, f32x4x4 * destination) const
+	{
+		PROFILE_ZONE("Scene::Tree::gather_matrices");
+
+		for (auto const & [depth, index]: indices)
+			*destination++ = levels[depth].matrices[index];
+	}
+
+	// Built with a counting sort of the children by parent, in linear time and without per node allocations
+	// When only a single subtree is added since the last build, it is spliced into the traversal instead
 	struct DepthFirst
 	{
-		u32 version;
-		unique_array<Node *> traversal;
-		Node ** traversal_end;
+		u32 version = 0;
+		Tree * tree = nullptr;
+		vector<Index> traversal;
+
+		// reused between builds
+		vector<u32> built_level_sizes;
+		// per level, the children of the previous level's node i are children[child_offsets[i], child_offsets[i + 1])
+		vector<vector<u32>> child_offsets;
+		vector<vector<u32>> children;
+		vector<Index> stack;
+
+		void update(Tree & tree)
+		{
+			bool is_built = this->tree != nullptr;
+			this->tree = &tree;
+			if (is_built and version == tree.version)
+				return;
+
+			if (not (is_built and try_insert_subtree()))
+				rebuild();
+
+			version = tree.version;
+			built_level_sizes.resize(tree.levels.size());
+			for (u32 depth = 0; depth < tree.levels.size(); ++depth)
+				built_level_sizes[depth] = tree.levels[depth].size();
+		}
 
-		explicit DepthFirst(Tree & tree):
-			version(tree.version),
-			traversal(new Node*[tree.size()]),
-			traversal_end(traversal.get() + tree.size())
+		void rebuild()
 		{
-			std::forward_list<Node *> linked_traversal;
-			std::unordered_map<const Node *, std::forward_list<Node *>::const_iterator> node2iter;
+			auto const & levels = tree->levels;
 
-			for (auto & node: tree.nodes[0])
+			built_level_sizes.assign(levels.size(), 0);
+			group_children(built_level_sizes);
+
+			traversal.clear();
+			traversal.reserve(tree->size());
+			for (u32 i = 0; i < levels[0].size(); ++i)
+				append_subtree({0, i});
+		}
+
+		// nodes are only appended to the levels, so the new ones are at the ends
+		bool try_insert_subtree()
+		{
+			auto const & levels = tree->levels;
+			auto const old_level_count = built_level_sizes.size();
+
+			// the subtree root is the only new node without a new parent
+			std::optional<Index> subtree_root;
+			for (u32 depth = 0; depth < levels.size(); ++depth)
 			{
-				linked_traversal.push_front(&node);
-				node2iter.emplace(&node, linked_traversal.begin());
+				auto const first_new = depth < old_level_count ? built_level_sizes[depth] : 0;
+				auto const first_new_parent = depth == 0 ? 0 : (depth - 1 < old_level_count ? built_level_sizes[depth - 1] : 0);
+				for (u32 i = first_new; i < levels[depth].size(); ++i)
+					if (depth == 0 or levels[depth].parent_indices[i] < first_new_parent)
+					{
+						if (subtree_root.has_value())
+							return false;
+						subtree_root = Index{depth, i};
+					}
 			}
+			if (not subtree_root.has_value())
+				return false;
 
-			for (auto depth = 1; depth < tree.nodes.size(); ++depth)
-				for (auto & node: tree.nodes[depth])
-				{
-					auto const & parent_node = tree.nodes[depth - 1][node.parent_index];
-					auto const & parent_iter = node2iter.at(&parent_node);
-					auto node_iter = linked_traversal.insert_after(parent_iter, &node);
-					node2iter.emplace(&node, node_iter);
-				}
+			built_level_sizes.resize(levels.size(), 0);
+			group_children(built_level_sizes);
+
+			auto const old_end = traversal.size();
+			append_subtree(*subtree_root);
+			if (subtree_root->depth == 0)
+				return true;
+
+			// goes right after the last descendant of the parent
+			Index parent{subtree_root->depth - 1, levels[subtree_root->depth].parent_indices[subtree_root->index]};
+			usize position = 0;
+			while (traversal[position].depth != parent.depth or traversal[position].index != parent.index)
+				++position;
+			for (++position; position < old_end and traversal[position].depth > parent.depth; ++position);
+
+			std::rotate(traversal.begin() + position, traversal.begin() + old_end, traversal.end());
+			return true;
+		}
 
-			std::ranges::copy(linked_traversal, traversal.get());
+		// only the nodes (and parents) starting from first_indices[depth] are grouped
+		void group_children(vector<u32> const & first_indices)
+		{
+			auto const & levels = tree->levels;
+			child_offsets.resize(levels.size());
+			children.resize(levels.size());
+
+			for (u32 depth = 1; depth < levels.size(); ++depth)
+			{
+				auto const & level = levels[depth];
+				auto const first = first_indices[depth];
+				auto const first_parent = first_indices[depth - 1];
+				auto const parent_count = levels[depth - 1].size() - first_parent;
+
+				auto & offsets = child_offsets[depth];
+				offsets.assign(parent_count + 1, 0);
+				for (u32 i = first; i < level.size(); ++i)
+					if (level.parent_indices[i] >= first_parent)
+						offsets[level.parent_indices[i] - first_parent + 1]++;
+
+				for (u32 p = 0; p < parent_count; ++p)
+					offsets[p + 1] += offsets[p];
+
+				// offsets are used as cursors, which leaves them shifted by one
+				auto & level_children = children[depth];
+				level_children.resize(offsets[parent_count]);
+				for (u32 i = first; i < level.size(); ++i)
+					if (level.parent_indices[i] >= first_parent)
+						level_children[offsets[level.parent_indices[i] - first_parent]++] = i;
+
+				for (u32 p = parent_count; p > 0; --p)
+					offsets[p] = offsets[p - 1];
+				offsets[0] = 0;
+			}
 		}
 
-		PointerIterator<Node> begin() const
-		{ return {traversal.get()}; }
+		// uses the grouping of the last group_children call
+		void append_subtree(Index root)
+		{
+			auto const & levels = tree->levels;
+
+			stack.clear();
+			stack.push_back(root);
+			while (not stack.empty())
+			{
+				auto node = stack.back();
+				stack.pop_back();
+				traversal.push_back(node);
+
+				auto const child_depth = node.depth + 1;
+				if (child_depth == levels.size())
+					continue;
 
-		PointerIterator<Node> end() const
-		{ return {traversal_end}; }
+				auto const & offsets = child_offsets[child_depth];
+				auto const local_index = node.index - built_level_sizes[node.depth];
+				// pushed in reverse, so the first child is visited first
+				for (auto c = offsets[local_index + 1]; c > offsets[local_index]; --c)
+					stack.push_back({child_depth, children[child_depth][c - 1]});
+			}
+		}
+
+		struct Iterator
+		{
+			Tree * tree;
+			Index const * current;
+
+			NodeRef operator*() const
+			{ return tree->get(*current); }
+
+			void operator++()
+			{ ++current; }
+
+			bool operator!=(Iterator const & other) const
+			{ return current != other.current; }
+		};
+
+		Iterator begin() const
+		{ return {tree, traversal.data()}; }
+
+		Iterator end() const
+		{ return {tree, traversal.data() + traversal.size()}; }
 	};
 
-	unique_one<DepthFirst> _cached_depth_first;
+	DepthFirst _depth_first;
 	DepthFirst const & depth_first()
 	{
-		if (_cached_depth_first == nullptr || _cached_depth_first->version != version)
-			_cached_depth_first.reset(new DepthFirst(*this));
-
-		return *_cached_depth_first;
+		_depth_first.update(*this);
+		return _depth_first;
 	}
 };
 }
-
@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+
+#include <core/allocators.hpp>
+
+namespace
+{
+// records the calls, a fence is the index of the frame that inserted it
+struct MockFences
+{
+	using Fence = u32;
+
+	u32 inserted_count = 0;
+	vector<Fence> waited;
+	vector<Fence> released;
+
+	Fence insert()
+	{ return inserted_count++; }
+
+	void wait(Fence fence)
+	{ waited.push_back(fence); }
+
+	void release(Fence fence)
+	{ released.push_back(fence); }
+};
+
+using Ring = RingAllocator<MockFences>;
+
+Ring make_ring(usize segment_size = 100)
+{
+	Ring ring;
+	ring.init({.segment_count = 3, .segment_size = segment_size, .alignment = 16});
+	return ring;
+}
+}
+
+TEST(RingAllocator, AllocatesAlignedWithinTheSegment)
+{
+	auto ring = make_ring();
+	EXPECT_EQ(ring.segment_size, 112) << "segment starts are aligned";
+	EXPECT_EQ(ring.get_capacity(), 3 * 112);
+
+	ring.begin_frame();
+	EXPECT_EQ(ring.segment, 0);
+	EXPECT_EQ(ring.allocate(10), 0);
+	EXPECT_EQ(ring.allocate(20), 16);
+	EXPECT_EQ(ring.allocate(60), 48);
+	ring.end_frame();
+}
+
+TEST(RingAllocator, ReturnsNulloptWhenTheSegmentIsFull)
+{
+	auto ring = make_ring();
+	ring.begin_frame();
+	EXPECT_EQ(ring.allocate(ring.segment_size + 1), nullopt);
+	EXPECT_EQ(ring.allocate(100), 0) << "a failed allocation takes nothing";
+	EXPECT_EQ(ring.allocate(1), nullopt) << "the aligned offset is past the segment";
+	ring.end_frame();
+
+	// the next segment starts empty
+	ring.begin_frame();
+	EXPECT_EQ(ring.allocate(ring.segment_size), ring.segment_size);
+	ring.end_frame();
+}
+
+TEST(RingAllocator, WrapsAroundAndWaitsBeforeReuse)
+{
+	auto ring = make_ring();
+	for (u32 frame = 0; frame < 7; ++frame)
+	{
+		SCOPED_TRACE(frame);
+		ring.begin_frame();
+		EXPECT_EQ(ring.segment, frame % 3);
+		EXPECT_EQ(ring.allocate(10), (frame % 3) * ring.segment_size);
+
+		// the first round has nothing to wait, then every frame waits the one that used its segment
+		if (frame < 3)
+			EXPECT_TRUE(ring.provider.waited.empty());
+		else
+			EXPECT_EQ(ring.provider.waited.back(), frame - 3);
+		EXPECT_EQ(ring.wait_count, frame < 3 ? 0 : frame - 2);
+		EXPECT_EQ(ring.provider.released, ring.provider.waited);
+		ring.end_frame();
+	}
+	EXPECT_EQ(ring.provider.inserted_count, 7);
+}
+
+TEST(RingAllocator, ResizeWaitsForEverySegment)
+{
+	auto ring = make_ring();
+	for (u32 frame = 0; frame < 4; ++frame)
+	{
+		ring.begin_frame();
+		ring.allocate(10);
+		ring.end_frame();
+	}
+	// frames 0 and 1 are waited by frames 3 and 4, segment 0 holds frame 3 and segment 2 frame 2
+	ring.begin_frame();
+	EXPECT_EQ(ring.provider.waited, (vector<u32>{0, 1}));
+
+	ring.resize(300);
+	EXPECT_EQ(ring.segment_size, 304);
+	EXPECT_EQ(ring.get_capacity(), 3 * 304);
+	EXPECT_EQ(ring.provider.waited, (vector<u32>{0, 1, 3, 2})) << "the other segments are waited by index";
+
+	EXPECT_EQ(ring.allocate(250), ring.segment * ring.segment_size);
+	ring.end_frame();
+
+	// nothing left to wait
+	ring.wait_all();
+	EXPECT_EQ(ring.wait_count, 5);
+	ring.wait_all();
+	EXPECT_EQ(ring.wait_count, 5);
+	EXPECT_EQ(ring.provider.released, ring.provider.waited);
+}
+
+TEST(RingAllocator, TracksTheLastAndThePeakFrameSizes)
+{
+	auto ring = make_ring();
+	for (usize size: {40, 90, 10})
+	{
+		ring.begin_frame();
+		ring.allocate(size);
+		ring.end_frame();
+		EXPECT_EQ(ring.last_frame_size, size);
+	}
+	EXPECT_EQ(ring.peak_size, 90);
+}
+
+TEST(FrameAllocator, BumpsAndFallsBackToUpstreamWhenFull)
+{
+	FrameAllocator allocator;
+	allocator.init({.capacity = 256});
+
+	auto * a = allocator.allocate(10, 1);
+	auto * b = allocator.allocate(8, 8);
+	EXPECT_TRUE(allocator.owns(a) and allocator.owns(b));
+	EXPECT_EQ(static_cast<byte *>(b) - static_cast<byte *>(a), 16) << "aligned after the first";
+
+	auto * overflow = allocator.allocate(512, 8);
+	EXPECT_FALSE(allocator.owns(overflow));
+	allocator.deallocate(overflow, 512, 8);
+
+	allocator.reset();
+	EXPECT_EQ(allocator.last_frame_size, 24);
+	EXPECT_EQ(allocator.allocation_count, 3);
+	EXPECT_EQ(allocator.overflow_count, 1);
+	EXPECT_EQ(allocator.allocate(4, 4), a) << "the next frame starts from the beginning";
+}
+
+TEST(FrameAllocator, TracksThePeakOfAllFrames)
+{
+	FrameAllocator allocator;
+	allocator.init({.capacity = 1024});
+	for (usize size: {100, 600, 50})
+	{
+		std::pmr::vector<byte> scratch(size, &allocator);
+		allocator.reset();
+		EXPECT_EQ(allocator.last_frame_size, size);
+		EXPECT_EQ(allocator.allocation_count, 1);
+		EXPECT_EQ(allocator.overflow_count, 0);
+	}
+	EXPECT_EQ(allocator.peak_size, 600);
+}
+
+TEST(LinearArena, CountsTheAllocations)
+{
+	LinearArena arena(64);
+	std::pmr::vector<u32> small(4, &arena);
+	std::pmr::vector<u32> big(100, &arena);
+	EXPECT_EQ(arena.allocation_count, 2);
+	EXPECT_EQ(arena.allocated_size, 4 * 4 + 100 * 4);
+	EXPECT_EQ(arena.blocks.size(), 2) << "the big one gets its own block";
+
+	arena.release();
+	EXPECT_EQ(arena.allocation_count, 0);
+	EXPECT_TRUE(arena.blocks.empty());
+}
+
+TEST(GetPeakRss, IsAtLeastWhatIsTouched)
+{
+	usize constexpr SIZE = 64 << 20;
+	vector<byte> touched(SIZE, byte(1));
+	EXPECT_GE(get_peak_rss(), SIZE);
+}
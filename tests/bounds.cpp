@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <core/bounds.hpp>
+
+#include <random>
+
+using namespace Geometry;
+
+namespace
+{
+f32x4x4 const PROJECTION = glm::perspective(glm::radians(90.f), 1.f, 1.f, 100.f);
+
+AABB make_box(f32x3 const & center, f32 half_extent = 0.5f)
+{ return {.min = center - f32x3(half_extent), .max = center + f32x3(half_extent)}; }
+
+// the smallest signed distance of the box's nearest corner over the planes, negative means outside one of them
+f32 min_margin(Frustum const & frustum, AABB const & box)
+{
+	auto const center = box.center(), half_extent = box.half_extent();
+	auto margin = std::numeric_limits<f32>::max();
+	for (u32 i = 0; i < Frustum::COUNT; ++i)
+	{
+		f32x3 const normal(frustum.normal_xs[i], frustum.normal_ys[i], frustum.normal_zs[i]);
+		auto const radius = glm::dot(glm::abs(normal), half_extent);
+		margin = glm::min(margin, glm::dot(normal, center) + frustum.distances[i] + radius);
+	}
+	return margin;
+}
+
+struct RandomTransforms
+{
+	std::mt19937 random;
+	std::uniform_real_distribution<f32> unit{-1, 1};
+
+	explicit RandomTransforms(u32 seed) :
+		random(seed)
+	{}
+
+	f32x3 vector(f32 scale)
+	{ return f32x3(unit(random), unit(random), unit(random)) * scale; }
+
+	// translation, rotation and a non-uniform scale
+	f32x4x4 trs()
+	{
+		auto axis = vector(1);
+		if (glm::length(axis) < 0.01f)
+			axis = f32x3(0, 1, 0);
+		auto const scale = f32x3(0.1f) + glm::abs(vector(3));
+		return glm::translate(vector(50)) * glm::rotate(unit(random) * 3.14f, axis) * glm::scale(scale);
+	}
+};
+}
+
+TEST(Frustum, ExtractsNormalizedInwardPlanes)
+{
+	auto const frustum = Frustum::from_view_projection(PROJECTION);
+	for (u32 i = 0; i < Frustum::PADDED_COUNT; ++i)
+	{
+		f32x3 const normal(frustum.normal_xs[i], frustum.normal_ys[i], frustum.normal_zs[i]);
+		if (i < Frustum::COUNT)
+			EXPECT_NEAR(glm::length(normal), 1, 1e-5f) << "plane " << i;
+		else
+			EXPECT_EQ(normal, f32x3(0)) << "padding contains everything";
+	}
+
+	// near at z = -1, far at z = -100, 90 degrees so the sides are at |x| = |y| = -z
+	auto const distance_to = [&frustum](u32 plane, f32x3 const & point)
+	{
+		f32x3 const normal(frustum.normal_xs[plane], frustum.normal_ys[plane], frustum.normal_zs[plane]);
+		return glm::dot(normal, point) + frustum.distances[plane];
+	};
+	EXPECT_NEAR(distance_to(4, {0, 0, -1}), 0, 1e-4f);
+	EXPECT_NEAR(distance_to(4, {0, 0, -3}), 2, 1e-4f);
+	EXPECT_NEAR(distance_to(5, {0, 0, -100}), 0, 1e-3f);
+	EXPECT_NEAR(distance_to(5, {0, 0, -90}), 10, 1e-3f);
+	EXPECT_NEAR(distance_to(0, {-10, 0, -10}), 0, 1e-4f);
+	EXPECT_NEAR(distance_to(1, {10, 0, -10}), 0, 1e-4f);
+	EXPECT_NEAR(distance_to(2, {0, -10, -10}), 0, 1e-4f);
+	EXPECT_NEAR(distance_to(3, {0, 10, -10}), 0, 1e-4f);
+	EXPECT_NEAR(distance_to(0, {0, 0, -10}), 10 / glm::sqrt(2.f), 1e-4f);
+}
+
+TEST(Frustum, IntersectsBoxes)
+{
+	auto const frustum = Frustum::from_view_projection(PROJECTION);
+	EXPECT_TRUE(frustum.intersects(make_box({0, 0, -10})));
+	EXPECT_FALSE(frustum.intersects(make_box({0, 0, 10}))) << "behind";
+	EXPECT_FALSE(frustum.intersects(make_box({20, 0, -10}))) << "right";
+	EXPECT_TRUE(frustum.intersects(make_box({10.4f, 0, -10}))) << "straddles the right plane";
+	EXPECT_TRUE(frustum.intersects(make_box({0, 0, -0.7f}))) << "straddles the near plane";
+	EXPECT_FALSE(frustum.intersects(make_box({0, 0, -0.3f}))) << "before the near plane";
+	EXPECT_FALSE(frustum.intersects(make_box({0, 0, -101}))) << "past the far plane";
+	EXPECT_TRUE(frustum.intersects(make_box({0, 0, -50}, 1000))) << "contains the frustum";
+	EXPECT_FALSE(frustum.intersects(AABB{})) << "empty";
+
+	EXPECT_TRUE(frustum.intersects(Sphere{.center = {0, 0, -10}, .radius = 1}));
+	EXPECT_FALSE(frustum.intersects(Sphere{.center = {0, 0, 10}, .radius = 1}));
+	EXPECT_TRUE(frustum.intersects(Sphere{.center = {0, 0, 0.2f}, .radius = 1.5f})) << "reaches over the near plane";
+	EXPECT_FALSE(frustum.intersects(Sphere{}));
+}
+
+// the SSE path, when compiled in, decides like the plane by plane scalar test
+TEST(Frustum, MatchesTheScalarReference)
+{
+	RandomTransforms random(1);
+	u32 mismatch_count = 0, inside_count = 0, sample_count = 0;
+	for (u32 view = 0; view < 50; ++view)
+	{
+		auto const camera = glm::lookAt(random.vector(20), random.vector(20) + f32x3(0, 0, 0.5f), f32x3(0, 1, 0));
+		auto const frustum = Frustum::from_view_projection(PROJECTION * camera);
+		for (u32 i = 0; i < 2000; ++i)
+		{
+			auto const box = make_box(random.vector(60), 0.1f + glm::abs(random.unit(random.random)) * 5);
+			auto const margin = min_margin(frustum, box);
+			if (glm::abs(margin) < 1e-4f) // either answer is right at the boundary
+				continue;
+
+			auto const expected = margin >= 0;
+			mismatch_count += frustum.intersects(box) != expected;
+			inside_count += expected;
+			sample_count++;
+		}
+	}
+	EXPECT_EQ(mismatch_count, 0);
+	EXPECT_GT(inside_count, sample_count / 20) << "both outcomes are sampled";
+	EXPECT_LT(inside_count, sample_count - sample_count / 20);
+}
+
+// Arvo's method gives the box of the 8 transformed corners
+TEST(AABB, TransformedMatchesTheCorners)
+{
+	RandomTransforms random(2);
+	for (u32 i = 0; i < 1000; ++i)
+	{
+		auto const box = make_box(random.vector(10), 0.1f + glm::abs(random.unit(random.random)) * 3);
+		auto const matrix = random.trs();
+
+		AABB expected;
+		for (u32 corner = 0; corner < 8; ++corner)
+		{
+			f32x3 const point(
+				corner & 1 ? box.max.x : box.min.x,
+				corner & 2 ? box.max.y : box.min.y,
+				corner & 4 ? box.max.z : box.min.z
+			);
+			expected.expand(f32x3(matrix * f32x4(point, 1)));
+		}
+
+		auto const transformed = box.transformed(matrix);
+		auto const tolerance = 1e-5f * (1 + glm::length(expected.max - expected.min) + glm::length(expected.center()));
+		for (auto axis = 0; axis < 3; ++axis)
+		{
+			ASSERT_NEAR(transformed.min[axis], expected.min[axis], tolerance) << i;
+			ASSERT_NEAR(transformed.max[axis], expected.max[axis], tolerance) << i;
+		}
+	}
+
+	EXPECT_TRUE(AABB{}.transformed(random.trs()).is_empty());
+}
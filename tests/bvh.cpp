@@ -0,0 +1,214 @@
+#include <gtest/gtest.h>
+
+#include <render/bvh.hpp>
+
+#include <random>
+
+using namespace Geometry;
+using Render::BVH;
+
+namespace
+{
+vector<AABB> make_boxes(u32 count, u32 seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<f32> position(-100, 100), half_extent(0.1f, 2);
+	vector<AABB> boxes(count);
+	for (auto & box: boxes)
+	{
+		f32x3 const center(position(random), position(random), position(random));
+		f32x3 const extent(half_extent(random), half_extent(random), half_extent(random));
+		box = {.min = center - extent, .max = center + extent};
+	}
+	return boxes;
+}
+
+void move_boxes(BVH & bvh, vector<AABB> & boxes, u32 seed)
+{
+	std::mt19937 random(seed);
+	std::uniform_real_distribution<f32> offset(-5, 5);
+	for (u32 i = 0; i < boxes.size(); ++i)
+	{
+		f32x3 const o(offset(random), offset(random), offset(random));
+		boxes[i].min += o, boxes[i].max += o;
+		bvh.set_item_box(i, boxes[i]);
+	}
+}
+
+// half of the items cross the scene in opposite directions, the subtrees built over the start positions get stretched
+void sweep_boxes(BVH & bvh, vector<AABB> & boxes)
+{
+	for (u32 i = 0; i < boxes.size(); i += 2)
+	{
+		auto const o = f32x3(i % 4 == 0 ? 20 : -20, 0, 0);
+		boxes[i].min += o, boxes[i].max += o;
+		bvh.set_item_box(i, boxes[i]);
+	}
+}
+
+bool contains(AABB const & outer, AABB const & inner)
+{ return all(lessThanEqual(outer.min, inner.min)) and all(lessThanEqual(inner.max, outer.max)); }
+
+// parents, fitting boxes, and every item in exactly one leaf
+void expect_valid(BVH const & bvh)
+{
+	ASSERT_FALSE(bvh.nodes.empty());
+	EXPECT_EQ(bvh.nodes[0].parent, BVH::NONE);
+
+	vector<u32> item_leaf_counts(bvh.size(), 0);
+	for (u32 i = 0; i < bvh.nodes.size(); ++i)
+	{
+		auto const & node = bvh.nodes[i];
+		if (node.is_leaf())
+		{
+			EXPECT_GT(node.item_count, 0);
+			for (auto k = node.first_item; k < node.first_item + node.item_count; ++k)
+			{
+				auto const item = bvh.item_order[k];
+				item_leaf_counts[item]++;
+				EXPECT_TRUE(contains(node.box, bvh.item_boxes[item])) << "leaf " << i << ", item " << item;
+			}
+		}
+		else
+			for (auto child: {node.left, node.right})
+			{
+				EXPECT_EQ(bvh.nodes[child].parent, i);
+				EXPECT_TRUE(contains(node.box, bvh.nodes[child].box)) << "node " << i << ", child " << child;
+			}
+	}
+	EXPECT_TRUE(std::ranges::all_of(item_leaf_counts, [](u32 count) { return count == 1; }));
+}
+
+// every item against every query, brute force
+void expect_queries_match(BVH const & bvh, span<AABB const> boxes)
+{
+	auto const collect = [&bvh](auto const & query)
+	{
+		vector<u32> items;
+		bvh.query(query, [&items](u32 item) { items.push_back(item); });
+		std::ranges::sort(items);
+		return items;
+	};
+
+	AABB const range{.min = f32x3(-30, -20, -40), .max = f32x3(20, 30, 10)};
+	vector<u32> expected;
+	for (u32 i = 0; i < boxes.size(); ++i)
+		if (all(lessThanEqual(range.min, boxes[i].max)) and all(lessThanEqual(boxes[i].min, range.max)))
+			expected.push_back(i);
+	EXPECT_EQ(collect(range), expected);
+
+	// looking down -z from the origin, 90 degrees fov, zero to one depth from 1 to 300
+	f32 const near = 1, far = 300;
+	f32x4x4 projection(0);
+	projection[0][0] = 1, projection[1][1] = 1;
+	projection[2][2] = far / (near - far), projection[2][3] = -1, projection[3][2] = -far * near / (far - near);
+	auto const frustum = Frustum::from_view_projection(projection);
+	expected.clear();
+	for (u32 i = 0; i < boxes.size(); ++i)
+		if (frustum.intersects(boxes[i]))
+			expected.push_back(i);
+	EXPECT_EQ(collect(frustum), expected);
+
+	for (auto const & direction: {f32x3(0.3f, 0.2f, -1), f32x3(-1, 0.1f, 0.05f), f32x3(0, 1, 0)})
+	{
+		Ray const ray{.origin = f32x3(1, 2, 3), .direction = glm::normalize(direction)};
+		optional<f32> nearest;
+		for (auto const & box: boxes)
+			if (auto distance = box.intersect_ray(ray.origin, 1.f / ray.direction, ray.max_distance))
+				nearest = glm::min(*distance, nearest.value_or(*distance));
+
+		auto const hit = bvh.raycast(ray);
+		ASSERT_EQ(hit.has_value(), nearest.has_value());
+		if (hit.has_value())
+		{
+			EXPECT_EQ(hit->distance, *nearest);
+			EXPECT_EQ(boxes[hit->item].intersect_ray(ray.origin, 1.f / ray.direction, ray.max_distance), *nearest);
+		}
+	}
+}
+}
+
+TEST(BVH, BuildsAValidTree)
+{
+	for (u32 count: {1, 4, 5, 100, 10000})
+	{
+		SCOPED_TRACE(count);
+		auto const boxes = make_boxes(count, count);
+		BVH bvh;
+		bvh.build(boxes);
+		expect_valid(bvh);
+		expect_queries_match(bvh, boxes);
+
+		// the root is the box of everything
+		AABB all;
+		for (auto const & box: boxes)
+			all.expand(box);
+		EXPECT_EQ(bvh.nodes[0].box.min, all.min);
+		EXPECT_EQ(bvh.nodes[0].box.max, all.max);
+	}
+}
+
+TEST(BVH, HandlesEmptyAndCoincidentItems)
+{
+	BVH bvh;
+	bvh.build({});
+	EXPECT_TRUE(bvh.nodes.empty());
+	EXPECT_FALSE(bvh.raycast({.origin = f32x3(0), .direction = f32x3(0, 0, -1)}).has_value());
+	EXPECT_EQ(bvh.calculate_cost(), 0);
+
+	// all the centroids at one point, no split can separate them, so they end in a single leaf
+	vector<AABB> const same(20, AABB{.min = f32x3(-1), .max = f32x3(1)});
+	bvh.build(same);
+	expect_valid(bvh);
+	EXPECT_EQ(bvh.nodes.size(), 1);
+}
+
+TEST(BVH, RefitKeepsTheQueriesExact)
+{
+	auto boxes = make_boxes(5000, 1);
+	BVH bvh;
+	bvh.build(boxes);
+	for (u32 frame = 0; frame < 3; ++frame)
+	{
+		SCOPED_TRACE(frame);
+		move_boxes(bvh, boxes, frame);
+		bvh.refit();
+		expect_valid(bvh);
+		expect_queries_match(bvh, boxes);
+	}
+}
+
+TEST(BVH, RotateReducesTheCostOfARefittedTree)
+{
+	auto boxes = make_boxes(5000, 2);
+	BVH refitted, rotated;
+	refitted.build(boxes);
+	rotated.build(boxes);
+	auto const built_cost = rotated.calculate_cost();
+
+	u32 rotation_count = 0;
+	for (u32 frame = 0; frame < 10; ++frame)
+	{
+		auto boxes_copy = boxes;
+		sweep_boxes(refitted, boxes_copy);
+		sweep_boxes(rotated, boxes);
+		refitted.refit();
+		rotated.refit();
+
+		auto const cost_before = rotated.calculate_cost();
+		rotation_count += rotated.rotate();
+		EXPECT_LE(rotated.calculate_cost(), cost_before * 1.0001f) << "frame " << frame;
+	}
+
+	EXPECT_GT(rotation_count, 0);
+	EXPECT_LT(rotated.calculate_cost(), refitted.calculate_cost());
+	EXPECT_GT(refitted.calculate_cost(), built_cost) << "the moves degrade a refitted tree";
+	expect_valid(rotated);
+	expect_queries_match(rotated, boxes);
+
+	// a rotation only happens when it reduces the area, a fitting tree settles
+	u32 settled = 0;
+	while (rotated.rotate() != 0 and settled < 100)
+		settled++;
+	EXPECT_LT(settled, 100);
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <core/core.hpp>
+
+// the primitive of editor_assets/model/axis gizmo/axis gizmo.gltf, a cube with an arrow along each axis
+namespace TestData::AxisGizmo
+{
+inline array<f32x3, 80> const POSITIONS{{
+	{0.125f, 0.125f, -0.125f},
+	{0.125f, -0.125f, -0.125f},
+	{0.125f, 0.125f, 0.125f},
+	{0.125f, -0.125f, 0.125f},
+	{-0.125f, 0.125f, -0.125f},
+	{-0.125f, -0.125f, -0.125f},
+	{-0.125f, 0.125f, 0.125f},
+	{-0.125f, -0.125f, 0.125f},
+	{0, 1, -0.0625f},
+	{0.0625f, 1, 0},
+	{0.06694167852401733f, 0.9378164410591125f, -0.06694167852401733f},
+	{-0.06694167852401733f, 0.9378164410591125f, -0.06694167852401733f},
+	{-0.0625f, 1, 0},
+	{0, 1, -0.0625f},
+	{-0.06694167852401733f, 0.9378164410591125f, 0.06694167852401733f},
+	{0, 1, 0.0625f},
+	{-0.0625f, 1, 0},
+	{0.06694167852401733f, 0.9378164410591125f, 0.06694167852401733f},
+	{0.0625f, 1, 0},
+	{0, 1, 0.0625f},
+	{0.0625f, 0, 1},
+	{0, -0.0625f, 1},
+	{0.06694167852401733f, -0.06694167852401733f, 0.9378164410591125f},
+	{0.06694167852401733f, 0.06694167852401733f, 0.9378164410591125f},
+	{0, 0.0625f, 1},
+	{0.0625f, 0, 1},
+	{-0.06694167852401733f, 0.06694167852401733f, 0.9378164410591125f},
+	{-0.0625f, 0, 1},
+	{0, 0.0625f, 1},
+	{-0.06694167852401733f, -0.06694167852401733f, 0.9378164410591125f},
+	{0, -0.0625f, 1},
+	{-0.0625f, 0, 1},
+	{-1, 0, 0.0625f},
+	{-1, -0.0625f, 0},
+	{-0.9378164410591125f, -0.06694167852401733f, 0.06694167852401733f},
+	{-0.9378164410591125f, 0.06694167852401733f, 0.06694167852401733f},
+	{-1, 0.0625f, 0},
+	{-1, 0, 0.0625f},
+	{-0.9378164410591125f, 0.06694167852401733f, -0.06694167852401733f},
+	{-1, 0, -0.0625f},
+	{-1, 0.0625f, 0},
+	{-0.9378164410591125f, -0.06694167852401733f, -0.06694167852401733f},
+	{-1, -0.0625f, 0},
+	{-1, 0, -0.0625f},
+	{0, -1, -0.0625f},
+	{-0.0625f, -1, 0},
+	{-0.06694167852401733f, -0.9378164410591125f, -0.06694167852401733f},
+	{0.06694167852401733f, -0.9378164410591125f, -0.06694167852401733f},
+	{0.0625f, -1, 0},
+	{0, -1, -0.0625f},
+	{0.06694167852401733f, -0.9378164410591125f, 0.06694167852401733f},
+	{0, -1, 0.0625f},
+	{0.0625f, -1, 0},
+	{-0.06694167852401733f, -0.9378164410591125f, 0.06694167852401733f},
+	{-0.0625f, -1, 0},
+	{0, -1, 0.0625f},
+	{1, 0, -0.0625f},
+	{1, -0.0625f, 0},
+	{0.9378164410591125f, -0.06694167852401733f, -0.06694167852401733f},
+	{0.9378164410591125f, 0.06694167852401733f, -0.06694167852401733f},
+	{1, 0.0625f, 0},
+	{1, 0, -0.0625f},
+	{0.9378164410591125f, 0.06694167852401733f, 0.06694167852401733f},
+	{1, 0, 0.0625f},
+	{1, 0.0625f, 0},
+	{0.9378164410591125f, -0.06694167852401733f, 0.06694167852401733f},
+	{1, -0.0625f, 0},
+	{1, 0, 0.0625f},
+	{-0.0625f, 0, -1},
+	{0, -0.0625f, -1},
+	{-0.06694167852401733f, -0.06694167852401733f, -0.9378164410591125f},
+	{-0.06694167852401733f, 0.06694167852401733f, -0.9378164410591125f},
+	{0, 0.0625f, -1},
+	{-0.0625f, 0, -1},
+	{0.06694167852401733f, 0.06694167852401733f, -0.9378164410591125f},
+	{0.0625f, 0, -1},
+	{0, 0.0625f, -1},
+	{0.06694167852401733f, -0.06694167852401733f, -0.9378164410591125f},
+	{0, -0.0625f, -1},
+	{0.0625f, 0, -1},
+}};
+
+// u16norm
+inline array<u16x4, 80> const COLORS{{
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{264, 264, 264, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 65535, 0, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{0, 0, 65535, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{8708, 0, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{0, 8708, 0, 65535},
+	{65535, 0, 0, 65535},
+	{65535, 80, 80, 65535},
+	{56032, 20, 20, 65535},
+	{55500, 0, 0, 65535},
+	{65535, 20, 20, 65535},
+	{65535, 0, 0, 65535},
+	{55500, 20, 20, 65535},
+	{65535, 80, 80, 65535},
+	{65535, 20, 20, 65535},
+	{55500, 139, 139, 65535},
+	{65535, 80, 80, 65535},
+	{65535, 80, 80, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+	{0, 0, 8708, 65535},
+}};
+
+inline array<u32, 468> const INDICES{
+	2, 0, 10, 9, 18, 17, 2, 10, 9, 9, 17, 2,
+	18, 9, 8, 18, 8, 13, 15, 19, 18, 13, 12, 16,
+	16, 15, 18, 13, 16, 18, 6, 2, 17, 19, 15, 14,
+	6, 17, 19, 19, 14, 6, 3, 2, 23, 25, 20, 22,
+	3, 23, 25, 25, 22, 3, 4, 6, 14, 16, 12, 11,
+	4, 14, 16, 16, 11, 4, 7, 3, 22, 21, 30, 29,
+	7, 22, 21, 21, 29, 7, 30, 21, 20, 30, 20, 25,
+	27, 31, 30, 25, 24, 28, 28, 27, 30, 25, 28, 30,
+	6, 7, 29, 31, 27, 26, 6, 29, 31, 31, 26, 6,
+	7, 6, 35, 37, 32, 34, 7, 35, 37, 37, 34, 7,
+	2, 6, 26, 28, 24, 23, 2, 26, 28, 28, 23, 2,
+	5, 7, 34, 33, 42, 41, 5, 34, 33, 33, 41, 5,
+	42, 33, 32, 42, 32, 37, 39, 43, 42, 37, 36, 40,
+	40, 39, 42, 37, 40, 42, 4, 5, 41, 43, 39, 38,
+	4, 41, 43, 43, 38, 4, 5, 1, 47, 49, 44, 46,
+	5, 47, 49, 49, 46, 5, 6, 4, 38, 40, 36, 35,
+	6, 38, 40, 40, 35, 6, 7, 5, 46, 45, 54, 53,
+	7, 46, 45, 45, 53, 7, 54, 45, 44, 54, 44, 49,
+	51, 55, 54, 49, 48, 52, 52, 51, 54, 49, 52, 54,
+	3, 7, 53, 55, 51, 50, 3, 53, 55, 55, 50, 3,
+	1, 0, 59, 61, 56, 58, 1, 59, 61, 61, 58, 1,
+	1, 3, 50, 52, 48, 47, 1, 50, 52, 52, 47, 1,
+	3, 1, 58, 57, 66, 65, 3, 58, 57, 57, 65, 3,
+	66, 57, 56, 66, 56, 61, 63, 67, 66, 61, 60, 64,
+	64, 63, 66, 61, 64, 66, 2, 3, 65, 67, 63, 62,
+	2, 65, 67, 67, 62, 2, 5, 4, 71, 73, 68, 70,
+	5, 71, 73, 73, 70, 5, 0, 2, 62, 64, 60, 59,
+	0, 62, 64, 64, 59, 0, 1, 5, 70, 69, 78, 77,
+	1, 70, 69, 69, 77, 1, 78, 69, 68, 78, 68, 73,
+	75, 79, 78, 73, 72, 76, 76, 75, 78, 73, 76, 78,
+	0, 1, 77, 79, 75, 74, 0, 77, 79, 79, 74, 0,
+	4, 0, 74, 76, 72, 71, 4, 74, 76, 76, 71, 4,
+	8, 9, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+	20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31,
+	32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43,
+	44, 45, 46, 47, 48, 49, 50, 51, 52, 53, 54, 55,
+	56, 57, 58, 59, 60, 61, 62, 63, 64, 65, 66, 67,
+	68, 69, 70, 71, 72, 73, 74, 75, 76, 77, 78, 79,
+	0, 4, 11, 13, 8, 10, 0, 11, 13, 13, 10, 0,
+};
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <core/dirty_set.hpp>
+
+#include <random>
+
+namespace
+{
+using Ranges = vector<std::pair<u32, u32>>;
+
+Ranges get_ranges(DirtySet const & set)
+{
+	Ranges ranges;
+	set.for_each_range([&ranges](u32 first, u32 count) { ranges.emplace_back(first, count); });
+	return ranges;
+}
+
+// the runs of a plain bool per index
+Ranges get_ranges(vector<bool> const & marked)
+{
+	Ranges ranges;
+	for (u32 i = 0; i < marked.size();)
+	{
+		if (not marked[i])
+		{
+			++i;
+			continue;
+		}
+		auto end = i;
+		while (end < marked.size() and marked[end])
+			++end;
+		ranges.emplace_back(i, end - i);
+		i = end;
+	}
+	return ranges;
+}
+}
+
+TEST(DirtySet, MarkingTwiceCountsOnce)
+{
+	DirtySet set;
+	EXPECT_TRUE(set.empty());
+
+	set.mark(5), set.mark(5), set.mark(200), set.mark(5);
+	EXPECT_EQ(set.size(), 2);
+	EXPECT_TRUE(set.is_marked(5));
+	EXPECT_TRUE(set.is_marked(200));
+	EXPECT_FALSE(set.is_marked(6));
+	EXPECT_FALSE(set.is_marked(100000)) << "past the words";
+	EXPECT_EQ(get_ranges(set), (Ranges{{5, 1}, {200, 1}}));
+}
+
+TEST(DirtySet, CoalescesAcrossWords)
+{
+	DirtySet set;
+	for (u32 i = 60; i < 70; ++i)
+		set.mark(i);
+	EXPECT_EQ(get_ranges(set), (Ranges{{60, 10}}));
+
+	// a full word joins both of its neighbors
+	for (u32 i = 64; i < 200; ++i)
+		set.mark(i);
+	set.mark(0), set.mark(63 + 192);
+	EXPECT_EQ(get_ranges(set), (Ranges{{0, 1}, {60, 140}, {255, 1}}));
+
+	// the last bit of a word and the first of the next
+	DirtySet edges;
+	edges.mark(127), edges.mark(128);
+	edges.mark(191);
+	EXPECT_EQ(get_ranges(edges), (Ranges{{127, 2}, {191, 1}}));
+}
+
+TEST(DirtySet, ClearKeepsNothing)
+{
+	DirtySet set;
+	for (u32 i = 0; i < 1000; i += 3)
+		set.mark(i);
+	set.clear();
+
+	EXPECT_TRUE(set.empty());
+	EXPECT_EQ(set.size(), 0);
+	EXPECT_FALSE(set.is_marked(999));
+	EXPECT_TRUE(get_ranges(set).empty());
+
+	set.mark(1);
+	EXPECT_EQ(get_ranges(set), (Ranges{{1, 1}}));
+}
+
+TEST(DirtySet, MatchesBruteForce)
+{
+	std::mt19937 random(1);
+	DirtySet set; // reused like the materials are, clear keeps the words
+	for (auto pattern = 0; pattern < 2000; ++pattern)
+	{
+		SCOPED_TRACE(pattern);
+		vector<bool> marked(1000, false);
+		auto const max_index = 1 + random() % 1000, mark_count = random() % 300;
+		for (u32 i = 0; i < mark_count; ++i)
+		{
+			auto const index = random() % max_index;
+			set.mark(index), marked[index] = true;
+		}
+		if (pattern % 7 == 0) // every index, a single range
+			for (u32 i = 0; i < max_index; ++i)
+				set.mark(i), marked[i] = true;
+
+		ASSERT_EQ(get_ranges(set), get_ranges(marked));
+		ASSERT_EQ(set.size(), std::ranges::count(marked, true));
+		for (u32 i = 0; i < marked.size(); ++i)
+			ASSERT_EQ(set.is_marked(i), marked[i]) << i;
+		set.clear();
+	}
+}
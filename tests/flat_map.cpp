@@ -0,0 +1,146 @@
+#include <gtest/gtest.h>
+
+#include <core/flat_map.hpp>
+#include <core/named.hpp>
+
+#include <map>
+#include <random>
+
+namespace
+{
+// every key in the same group, the probe sequence has to walk past full groups
+struct CollidingHasher
+{
+	usize operator()(u32 key) const
+	{ return key % 4; }
+};
+
+template<typename Map>
+void expect_same(Map const & map, std::map<u32, u32> const & reference)
+{
+	ASSERT_EQ(map.size(), reference.size());
+	for (auto const & [key, value]: reference)
+	{
+		ASSERT_TRUE(map.contains(key)) << "key " << key;
+		EXPECT_EQ(map.at(key), value) << "key " << key;
+	}
+
+	usize visited = 0;
+	for (auto const & [key, value]: map)
+	{
+		EXPECT_EQ(reference.at(key), value);
+		visited++;
+	}
+	EXPECT_EQ(visited, reference.size());
+}
+
+// random inserts, erases and overwrites over a small key range, so keys come back after being erased
+template<typename Map>
+void run_random_operations(u32 key_range)
+{
+	Map map;
+	std::map<u32, u32> reference;
+	std::mt19937 random{key_range};
+	for (u32 i = 0; i < 20'000; ++i)
+	{
+		auto const key = u32(random() % key_range);
+		switch (random() % 4)
+		{
+		case 0:
+		case 1:
+		{
+			auto const [slot, is_emplaced] = map.try_emplace(key, i);
+			EXPECT_EQ(is_emplaced, reference.try_emplace(key, i).second);
+			EXPECT_EQ(slot->first, key);
+			break;
+		}
+		case 2:
+			EXPECT_EQ(map.erase(key), reference.erase(key) == 1);
+			break;
+		case 3:
+			map[key] = i, reference[key] = i;
+			break;
+		}
+		if (i % 1000 == 0)
+			expect_same(map, reference);
+	}
+	expect_same(map, reference);
+
+	// the removed keys stay removed
+	for (u32 key = 0; key < key_range; ++key)
+		EXPECT_EQ(map.find(key) == map.end(), not reference.contains(key));
+}
+}
+
+TEST(FlatMap, MatchesStdMap)
+{
+	for (u32 key_range: {10u, 100u, 5000u})
+	{
+		SCOPED_TRACE(key_range);
+		run_random_operations<FlatMap<u32, u32>>(key_range);
+	}
+}
+
+TEST(FlatMap, MatchesStdMapWhenEveryKeyCollides)
+{
+	for (u32 key_range: {10u, 100u})
+	{
+		SCOPED_TRACE(key_range);
+		run_random_operations<FlatMap<u32, u32, CollidingHasher>>(key_range);
+	}
+}
+
+TEST(FlatMap, ReservesBelowTheMaxLoadFactor)
+{
+	FlatMap<u32, u32> map;
+	map.reserve(1000);
+	auto const capacity = map.capacity;
+	EXPECT_GE(capacity - capacity / 8, 1000);
+
+	for (u32 i = 0; i < 1000; ++i)
+		map.try_emplace(i, i);
+	EXPECT_EQ(map.capacity, capacity) << "no rehash after reserve";
+}
+
+TEST(FlatMap, ReusesErasedSlotsWithoutGrowing)
+{
+	FlatMap<u32, u32> map;
+	for (u32 i = 0; i < 100; ++i)
+		map.try_emplace(i, i);
+	auto const capacity = map.capacity;
+
+	// the same number of keys churning forever, tombstones are dropped by rehashing in place
+	// it grows at most once, so the map stays under half full and the in place rehashes stay rare
+	for (u32 i = 100; i < 100'000; ++i)
+	{
+		map.erase(i - 100);
+		map.try_emplace(i, i);
+	}
+	EXPECT_EQ(map.size(), 100);
+	EXPECT_LE(map.capacity, capacity * 2);
+	for (u32 i = 100'000 - 100; i < 100'000; ++i)
+		EXPECT_EQ(map.at(i), i);
+}
+
+TEST(FlatMap, CopiesMovesAndClears)
+{
+	FlatMap<Name, std::string, Name::Hasher> map;
+	for (auto name: {"albedo", "normal", "roughness", "metallic"})
+		map.try_emplace(Name(name), name);
+
+	auto copy = map;
+	EXPECT_EQ(copy.size(), 4);
+	EXPECT_EQ(copy.at(Name("normal")), "normal");
+
+	auto moved = move(map);
+	EXPECT_EQ(moved.size(), 4);
+	EXPECT_EQ(map.size(), 0);
+	EXPECT_FALSE(map.contains(Name("normal")));
+
+	moved.clear();
+	EXPECT_TRUE(moved.empty());
+	EXPECT_TRUE(moved.begin() == moved.end());
+	EXPECT_FALSE(moved.contains(Name("albedo")));
+	EXPECT_EQ(copy.at(Name("albedo")), "albedo") << "the copy owns its values";
+	EXPECT_THROW(moved.at(Name("albedo")), std::out_of_range);
+}
@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+
+#include <render/instancing.hpp>
+
+#include <random>
+
+using namespace Render;
+
+namespace
+{
+// the instance's input index is stored in its matrix, so the output order can be traced back
+struct Instances
+{
+	vector<Handle<Mesh>> meshes;
+	vector<f32x4x4> matrices;
+	vector<f32x4x4 const *> matrix_pointers;
+
+	explicit Instances(span<u32 const> mesh_slots)
+	{
+		for (u32 i = 0; i < mesh_slots.size(); ++i)
+		{
+			meshes.push_back({.index = mesh_slots[i], .generation = mesh_slots[i] * 3});
+			matrices.emplace_back(f32(i));
+		}
+		for (auto const & matrix: matrices)
+			matrix_pointers.push_back(&matrix);
+	}
+};
+
+u32 input_index(f32x4x4 const & matrix)
+{ return u32(matrix[0][0]); }
+}
+
+TEST(InstanceGroups, GroupsBySlotAndKeepsTheInstanceOrder)
+{
+	Instances const instances(array<u32, 8>{4, 1, 4, 0, 1, 4, 7, 1});
+	InstanceGroups groups;
+	groups.build(instances.meshes, instances.matrix_pointers);
+
+	ASSERT_EQ(groups.groups.size(), 4);
+	vector<u32> slots, firsts, counts;
+	for (auto const & group: groups.groups)
+	{
+		slots.push_back(group.mesh.index);
+		firsts.push_back(group.first_instance);
+		counts.push_back(group.instance_count);
+		EXPECT_EQ(group.mesh.generation, group.mesh.index * 3) << "the handle is kept whole";
+	}
+	EXPECT_EQ(slots, (vector<u32>{0, 1, 4, 7}));
+	EXPECT_EQ(firsts, (vector<u32>{0, 1, 4, 7}));
+	EXPECT_EQ(counts, (vector<u32>{1, 3, 3, 1}));
+
+	vector<u32> order;
+	for (auto const & matrix: groups.matrices)
+		order.push_back(input_index(matrix));
+	EXPECT_EQ(order, (vector<u32>{3, 1, 4, 7, 0, 2, 5, 6}));
+	EXPECT_FLOAT_EQ(groups.get_ratio(), 2);
+}
+
+TEST(InstanceGroups, MatchesBruteForce)
+{
+	std::mt19937 random(3);
+	InstanceGroups groups; // reused like the game does
+	for (u32 instance_count: {0, 1, 50, 10000})
+	{
+		SCOPED_TRACE(instance_count);
+		vector<u32> slots;
+		for (u32 i = 0; i < instance_count; ++i)
+			slots.push_back(random() % 37);
+		Instances const instances(slots);
+		groups.build(instances.meshes, instances.matrix_pointers);
+
+		// slots ascending, instances of a slot in their input order
+		vector<u32> expected_order;
+		usize expected_group_count = 0;
+		for (u32 slot = 0; slot < 37; ++slot)
+		{
+			auto const before = expected_order.size();
+			for (u32 i = 0; i < instance_count; ++i)
+				if (slots[i] == slot)
+					expected_order.push_back(i);
+			expected_group_count += expected_order.size() != before;
+		}
+
+		vector<u32> order;
+		for (auto const & matrix: groups.matrices)
+			order.push_back(input_index(matrix));
+		EXPECT_EQ(order, expected_order);
+		ASSERT_EQ(groups.groups.size(), expected_group_count);
+
+		// the groups are contiguous and cover every instance
+		u32 next_instance = 0;
+		for (auto const & group: groups.groups)
+		{
+			EXPECT_EQ(group.first_instance, next_instance);
+			for (u32 i = 0; i < group.instance_count; ++i)
+				EXPECT_EQ(slots[order[group.first_instance + i]], group.mesh.index);
+			next_instance += group.instance_count;
+		}
+		EXPECT_EQ(next_instance, instance_count);
+	}
+}
@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <core/mesh_optimize.hpp>
+#include <core/simplify.hpp>
+
+#include "meshes.hpp"
+
+using namespace Geometry;
+
+namespace
+{
+vector<std::pair<char const *, TestData::Mesh>> get_meshes()
+{
+	TestData::Mesh spheres;
+	for (u32 i = 0; i < 5; ++i)
+		TestData::add_sphere(spheres, 12, {f32(i) * 0.8f, 0.3f * f32(i % 2), 0}, 0.7f);
+
+	return {
+		{"axis gizmo", TestData::axis_gizmo()},
+		{"grid", TestData::grid(48, 0.05f)},
+		{"shuffled grid", TestData::shuffle_triangles(TestData::grid(48, 0.05f))},
+		{"sphere", TestData::sphere(24)},
+		{"shuffled spheres", TestData::shuffle_triangles(spheres)},
+	};
+}
+
+vector<f32x3> get_positions(Primitive const & primitive)
+{
+	auto const positions = primitive.find_f32x3(Key::POSITION);
+	return {positions.begin(), positions.end()};
+}
+}
+
+TEST(AnalyzeVertexCache, CountsFifoMisses)
+{
+	// a single triangle misses every vertex
+	auto const single = analyze_vertex_cache(array<u32, 3>{0, 1, 2}, 3);
+	EXPECT_FLOAT_EQ(single.acmr, 3);
+	EXPECT_FLOAT_EQ(single.atvr, 1);
+
+	// a strip of 2 triangles shares an edge
+	auto const strip = analyze_vertex_cache(array<u32, 6>{0, 1, 2, 2, 1, 3}, 4);
+	EXPECT_FLOAT_EQ(strip.acmr, 2);
+	EXPECT_FLOAT_EQ(strip.atvr, 1);
+
+	// a cache of 3 has evicted vertex 0 when it comes back
+	auto const evicted = analyze_vertex_cache(array<u32, 9>{0, 1, 2, 3, 4, 5, 0, 1, 2}, 6, 3);
+	EXPECT_FLOAT_EQ(evicted.acmr, 3);
+	EXPECT_FLOAT_EQ(evicted.atvr, 1.5f);
+}
+
+TEST(Optimize, ImprovesTheVertexCache)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto const before = analyze_vertex_cache(mesh.indices, mesh.positions.size());
+
+		auto primitive = TestData::make_primitive(mesh);
+		optimize(primitive);
+		auto const after = analyze_vertex_cache(primitive.indices, primitive.get_vertex_count());
+
+		EXPECT_LT(after.acmr, before.acmr);
+		EXPECT_LT(after.atvr, before.atvr);
+		EXPECT_LT(after.acmr, 0.75f);
+	}
+}
+
+TEST(Optimize, WeldsUnindexedPrimitives)
+{
+	auto const mesh = TestData::unindexed(TestData::sphere(16));
+	auto const before = analyze_vertex_cache(mesh.indices, mesh.positions.size());
+	EXPECT_FLOAT_EQ(before.acmr, 3);
+
+	auto primitive = TestData::make_primitive(mesh);
+	weld_vertices(primitive);
+	optimize(primitive);
+	EXPECT_LT(analyze_vertex_cache(primitive.indices, primitive.get_vertex_count()).acmr, 0.75f);
+
+	// the welded vertices are dropped
+	EXPECT_EQ(primitive.get_vertex_count(), TestData::sphere(16).positions.size());
+	EXPECT_EQ(
+		TestData::triangle_set(get_positions(primitive), primitive.indices),
+		TestData::triangle_set(mesh.positions, mesh.indices)
+	);
+}
+
+TEST(Optimize, KeepsTheTrianglesAndTheirWinding)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto primitive = TestData::make_primitive(mesh);
+		generate_lods(primitive, array{0.5f, 0.25f});
+		vector<vector<TestData::Triangle>> lod_triangles;
+		for (auto const & lod: primitive.lods)
+			lod_triangles.push_back(TestData::triangle_set(mesh.positions, lod.indices));
+
+		optimize(primitive);
+		auto const positions = get_positions(primitive);
+
+		EXPECT_EQ(
+			TestData::triangle_set(positions, primitive.indices), TestData::triangle_set(mesh.positions, mesh.indices)
+		);
+		ASSERT_EQ(primitive.lods.size(), lod_triangles.size());
+		for (usize i = 0; i < primitive.lods.size(); ++i)
+			EXPECT_EQ(TestData::triangle_set(positions, primitive.lods[i].indices), lod_triangles[i]) << "lod " << i;
+	}
+}
+
+TEST(Optimize, OrdersTheVerticesByFirstUse)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto primitive = TestData::make_primitive(mesh);
+		optimize(primitive);
+
+		u32 next_vertex = 0;
+		for (auto index: primitive.indices)
+		{
+			EXPECT_LE(index, next_vertex);
+			if (index == next_vertex)
+				next_vertex++;
+		}
+		EXPECT_EQ(next_vertex, primitive.get_vertex_count());
+	}
+}
+
+TEST(Optimize, IsDeterministic)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto a = TestData::make_primitive(mesh), b = TestData::make_primitive(mesh);
+		optimize(a), optimize(b);
+		EXPECT_EQ(a.indices, b.indices);
+		EXPECT_EQ(get_positions(a), get_positions(b));
+	}
+}
+
+TEST(OptimizeOverdraw, KeepsTheTrianglesAndTheCache)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto indices = mesh.indices;
+		optimize_vertex_cache(indices, mesh.positions.size());
+		auto const cache_only = analyze_vertex_cache(indices, mesh.positions.size());
+
+		optimize_overdraw(indices, mesh.positions, 1.05f);
+		EXPECT_EQ(TestData::triangle_set(mesh.positions, indices), TestData::triangle_set(mesh.positions, mesh.indices));
+		// the clusters are split within the threshold, joining them adds a few misses at the cuts
+		EXPECT_LE(analyze_vertex_cache(indices, mesh.positions.size()).acmr, cache_only.acmr * 1.1f);
+	}
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <core/core.hpp>
+#include <core/geometry.hpp>
+
+#include <map>
+
+#include "data/axis_gizmo.hpp"
+
+// meshes for the geometry passes, built in code so the tests and benchmarks read no files
+namespace TestData
+{
+struct Mesh
+{
+	vector<f32x3> positions;
+	vector<u32> indices;
+};
+
+inline Geometry::Layout const POSITION_LAYOUT = []
+{
+	Geometry::Layout layout{};
+	layout[0] = {
+		.key = {Geometry::Key::POSITION, 0},
+		.type = {Geometry::Type::F32, 3},
+		.location = 0,
+		.is_per_patch = false,
+		.group = 0,
+	};
+	return layout;
+}();
+
+inline Geometry::Primitive make_primitive(Mesh const & mesh)
+{
+	Geometry::Primitive primitive;
+	primitive.layout = &POSITION_LAYOUT;
+	auto & buffer = primitive.data[0];
+	buffer = ByteBuffer(mesh.positions.size() * sizeof(f32x3));
+	std::memcpy(buffer.begin(), mesh.positions.data(), buffer.size);
+	primitive.indices = mesh.indices;
+	primitive.calculate_bounds();
+	return primitive;
+}
+
+inline Mesh axis_gizmo()
+{
+	return {
+		.positions = {AxisGizmo::POSITIONS.begin(), AxisGizmo::POSITIONS.end()},
+		.indices = {AxisGizmo::INDICES.begin(), AxisGizmo::INDICES.end()},
+	};
+}
+
+// size x size quads in [0, 1]^2 facing +z, height gives a bumpy surface
+inline Mesh grid(u32 size, f32 height = 0)
+{
+	Mesh mesh;
+	auto const row = size + 1;
+	for (u32 y = 0; y <= size; ++y)
+		for (u32 x = 0; x <= size; ++x)
+			mesh.positions.emplace_back(
+				f32(x) / f32(size), f32(y) / f32(size), height * glm::sin(f32(x) * 0.2f) * glm::cos(f32(y) * 0.3f)
+			);
+
+	for (u32 y = 0; y < size; ++y)
+		for (u32 x = 0; x < size; ++x)
+		{
+			auto const a = y * row + x, b = a + 1, c = a + row, d = c + 1;
+			mesh.indices.insert(mesh.indices.end(), {a, b, d, a, d, c});
+		}
+	return mesh;
+}
+
+// a cube with size x size quads per face pushed onto the sphere, closed and welded, facing outwards
+inline void add_sphere(Mesh & mesh, u32 size, f32x3 center = {0, 0, 0}, f32 radius = 1)
+{
+	auto const less = [](i32x3 a, i32x3 b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+	std::map<i32x3, u32, decltype(less)> indices(less);
+	auto const get_index = [&](i32x3 corner)
+	{
+		auto [it, is_new] = indices.try_emplace(corner, u32(mesh.positions.size()));
+		if (is_new)
+			mesh.positions.push_back(center + glm::normalize(f32x3(corner) / f32(size) * 2.f - 1.f) * radius);
+		return it->second;
+	};
+
+	for (u32 face = 0; face < 6; ++face)
+	{
+		auto const axis = face / 2;
+		auto const is_high = face % 2 == 1;
+		for (i32 u = 0; u < i32(size); ++u)
+			for (i32 v = 0; v < i32(size); ++v)
+			{
+				auto const corner = [&](i32 a, i32 b)
+				{
+					i32x3 c;
+					c[axis] = is_high ? i32(size) : 0;
+					c[(axis + 1) % 3] = a;
+					c[(axis + 2) % 3] = b;
+					return get_index(c);
+				};
+				auto const a = corner(u, v), b = corner(u + 1, v), c = corner(u + 1, v + 1), d = corner(u, v + 1);
+				if (is_high)
+					mesh.indices.insert(mesh.indices.end(), {a, b, c, a, c, d});
+				else
+					mesh.indices.insert(mesh.indices.end(), {a, c, b, a, d, c});
+			}
+	}
+}
+
+inline Mesh sphere(u32 size)
+{
+	Mesh mesh;
+	add_sphere(mesh, size);
+	return mesh;
+}
+
+// every triangle gets its own vertices, like a GLTF primitive without indices
+inline Mesh unindexed(Mesh const & mesh)
+{
+	Mesh result;
+	for (auto index: mesh.indices)
+	{
+		result.indices.push_back(u32(result.positions.size()));
+		result.positions.push_back(mesh.positions[index]);
+	}
+	return result;
+}
+
+inline Mesh shuffle_triangles(Mesh mesh, u32 seed = 12345)
+{
+	auto const triangle_count = mesh.indices.size() / 3;
+	for (usize i = triangle_count - 1; i > 0; --i)
+	{
+		seed = seed * 1664525u + 1013904223u;
+		auto const j = seed % (i + 1);
+		for (usize c = 0; c < 3; ++c)
+			std::swap(mesh.indices[i * 3 + c], mesh.indices[j * 3 + c]);
+	}
+	return mesh;
+}
+
+// triangles by their corner positions, rotated to start at the smallest corner so the winding is kept, sorted
+// compares the same surface across passes that renumber or reorder the vertices
+using Triangle = array<f32x3, 3>;
+inline vector<Triangle> triangle_set(span<f32x3 const> positions, span<u32 const> indices)
+{
+	auto const less = [](f32x3 const & a, f32x3 const & b) { return std::tie(a.x, a.y, a.z) < std::tie(b.x, b.y, b.z); };
+
+	vector<Triangle> triangles;
+	triangles.reserve(indices.size() / 3);
+	for (usize i = 0; i < indices.size(); i += 3)
+	{
+		Triangle triangle{positions[indices[i + 0]], positions[indices[i + 1]], positions[indices[i + 2]]};
+		std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end(), less), triangle.end());
+		triangles.push_back(triangle);
+	}
+	std::ranges::sort(triangles, [&](Triangle const & a, Triangle const & b)
+	{ return std::ranges::lexicographical_compare(a, b, less); });
+	return triangles;
+}
+}
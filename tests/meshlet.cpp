@@ -0,0 +1,250 @@
+#include <gtest/gtest.h>
+
+#include <core/meshlet.hpp>
+#include <core/mesh_optimize.hpp>
+#include <render/meshlet_culling.hpp>
+
+#include "meshes.hpp"
+
+using namespace Geometry;
+
+namespace
+{
+vector<std::pair<char const *, TestData::Mesh>> get_meshes()
+{
+	TestData::Mesh spheres;
+	for (u32 i = 0; i < 8; ++i)
+		TestData::add_sphere(spheres, 12, {f32(i % 4) * 3, f32(i / 4) * 3, 0});
+
+	// the last triangle is degenerate
+	TestData::Mesh tiny{
+		.positions = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {1, 1, 0}},
+		.indices = {0, 1, 2, 1, 3, 2, 0, 0, 1},
+	};
+
+	return {
+		{"axis gizmo", TestData::axis_gizmo()},
+		{"grid", TestData::grid(48, 0.05f)},
+		{"shuffled grid", TestData::shuffle_triangles(TestData::grid(48, 0.05f))},
+		{"sphere", TestData::sphere(16)},
+		{"spheres", move(spheres)},
+		{"tiny", move(tiny)},
+	};
+}
+
+Primitive make_meshlets(TestData::Mesh const & mesh, u32 max_vertices, u32 max_triangles)
+{
+	auto primitive = TestData::make_primitive(mesh);
+	build_meshlets(primitive, max_vertices, max_triangles);
+	return primitive;
+}
+
+struct Limits
+{
+	u32 max_vertices, max_triangles;
+};
+array<Limits, 3> constexpr LIMITS{{
+	{MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES},
+	{16, 8},
+	{255, 255},
+}};
+}
+
+TEST(BuildMeshlets, CoversEveryTriangleOnce)
+{
+	for (auto const & [name, mesh]: get_meshes())
+		for (auto const [max_vertices, max_triangles]: LIMITS)
+		{
+			SCOPED_TRACE(name);
+			auto const primitive = make_meshlets(mesh, max_vertices, max_triangles);
+
+			// the same triangles with the same winding, only reordered
+			EXPECT_EQ(
+				TestData::triangle_set(mesh.positions, primitive.indices), TestData::triangle_set(mesh.positions, mesh.indices)
+			);
+
+			// the meshlets tile the indices in order
+			u32 next_triangle = 0;
+			for (auto const & meshlet: primitive.meshlets)
+			{
+				EXPECT_EQ(meshlet.first_triangle, next_triangle);
+				next_triangle = meshlet.first_triangle + meshlet.triangle_count;
+			}
+			EXPECT_EQ(next_triangle * 3, primitive.indices.size());
+		}
+}
+
+TEST(BuildMeshlets, StaysWithinTheLimits)
+{
+	for (auto const & [name, mesh]: get_meshes())
+		for (auto const [max_vertices, max_triangles]: LIMITS)
+		{
+			SCOPED_TRACE(name);
+			auto const primitive = make_meshlets(mesh, max_vertices, max_triangles);
+
+			for (auto const & meshlet: primitive.meshlets)
+			{
+				EXPECT_GE(meshlet.triangle_count, 1);
+				EXPECT_LE(meshlet.triangle_count, max_triangles);
+				EXPECT_LE(meshlet.vertex_count, max_vertices);
+
+				vector<u32> vertices(
+					primitive.indices.begin() + meshlet.first_triangle * 3,
+					primitive.indices.begin() + (meshlet.first_triangle + meshlet.triangle_count) * 3
+				);
+				std::ranges::sort(vertices);
+				vertices.erase(std::unique(vertices.begin(), vertices.end()), vertices.end());
+				EXPECT_EQ(vertices.size(), meshlet.vertex_count);
+			}
+		}
+}
+
+TEST(BuildMeshlets, SphereContainsTheVertices)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto const primitive = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+
+		for (auto const & meshlet: primitive.meshlets)
+			for (auto t = meshlet.first_triangle; t < meshlet.first_triangle + meshlet.triangle_count; ++t)
+				for (auto c = 0; c < 3; ++c)
+				{
+					auto const & position = mesh.positions[primitive.indices[t * 3 + c]];
+					EXPECT_LE(glm::distance(position, meshlet.sphere.center), meshlet.sphere.radius * (1 + 1e-6f));
+				}
+	}
+}
+
+// the cone test is conservative, a backfacing meshlet has no triangle facing any eye it is culled for
+TEST(BuildMeshlets, BackfacingHasNoFrontFacingTriangle)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto const primitive = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+
+		auto const & box = primitive.bounds.box;
+		auto const extent = glm::compMax(box.half_extent());
+		u32 seed = 777;
+		auto const random = [&seed]
+		{
+			seed = seed * 1664525u + 1013904223u;
+			return f32(seed >> 8) / f32(1 << 24) * 2 - 1;
+		};
+
+		usize culled_count = 0;
+		for (auto e = 0; e < 64; ++e)
+		{
+			// eyes inside and around the mesh, every 4th one orthographic
+			auto const is_orthographic = e % 4 == 3;
+			auto const eye = is_orthographic
+				? f32x4(glm::normalize(f32x3(random(), random(), random())), 0)
+				: f32x4(box.center() + f32x3(random(), random(), random()) * extent * (e < 8 ? 0.5f : 4.f), 1);
+
+			for (auto const & meshlet: primitive.meshlets)
+			{
+				if (not is_backfacing(meshlet, eye))
+					continue;
+				culled_count++;
+
+				for (auto t = meshlet.first_triangle; t < meshlet.first_triangle + meshlet.triangle_count; ++t)
+				{
+					auto const & p0 = mesh.positions[primitive.indices[t * 3 + 0]];
+					auto const & p1 = mesh.positions[primitive.indices[t * 3 + 1]];
+					auto const & p2 = mesh.positions[primitive.indices[t * 3 + 2]];
+					auto const normal = glm::cross(p1 - p0, p2 - p0);
+					for (auto const & corner: {p0, p1, p2})
+					{
+						auto const view = is_orthographic ? -f32x3(eye) : corner - f32x3(eye);
+						EXPECT_GE(glm::dot(normal, view), 0) << "triangle " << t << " faces the eye " << e;
+					}
+				}
+			}
+		}
+		if (mesh.positions.size() > 100)
+		{ EXPECT_GT(culled_count, 0); }
+	}
+}
+
+TEST(BuildMeshlets, IsDeterministic)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		auto const a = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+		auto const b = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+		EXPECT_EQ(a.indices, b.indices);
+		EXPECT_EQ(a.meshlets.size(), b.meshlets.size());
+	}
+}
+
+TEST(BuildMeshlets, KeepsTheVertexCacheOrder)
+{
+	auto mesh = TestData::sphere(32);
+	optimize_vertex_cache(mesh.indices, mesh.positions.size());
+	auto const before = analyze_vertex_cache(mesh.indices, mesh.positions.size());
+
+	auto const primitive = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+	auto const after = analyze_vertex_cache(primitive.indices, mesh.positions.size());
+	EXPECT_LE(after.acmr, before.acmr * 1.1f);
+}
+
+namespace
+{
+struct CullResult
+{
+	u32 culled_count;
+	u32 triangle_count;
+};
+CullResult cull(Primitive const & primitive, f32x3 eye, f32x3 target, f32x4x4 const & matrix)
+{
+	auto const projection = glm::perspective(glm::radians(60.f), 1.f, 0.1f, 1000.f);
+	auto const view = glm::lookAt(eye, target, f32x3(0, 1, 0));
+	auto const culler = Render::MeshletCuller::make(Frustum::from_view_projection(projection * view), view, projection);
+
+	CullResult result{.culled_count = 0, .triangle_count = 0};
+	u32 previous_end = 0;
+	result.culled_count = culler.cull(primitive, matrix, [&](u32 first_index, u32 index_count)
+	{
+		EXPECT_EQ(first_index % 3, 0);
+		EXPECT_EQ(index_count % 3, 0);
+		EXPECT_TRUE(previous_end == 0 or previous_end < first_index) << "adjacent runs are merged";
+		previous_end = first_index + index_count;
+		result.triangle_count += index_count / 3;
+	});
+	return result;
+}
+}
+
+TEST(MeshletCuller, CullsByFrustumAndCone)
+{
+	// a plane facing +z in [0, 64]^2
+	auto mesh = TestData::grid(64);
+	for (auto & position: mesh.positions)
+		position *= 64.f;
+	auto const primitive = make_meshlets(mesh, MESHLET_MAX_VERTICES, MESHLET_MAX_TRIANGLES);
+	auto const meshlet_count = u32(primitive.meshlets.size());
+	auto const triangle_count = u32(primitive.indices.size() / 3);
+
+	auto const in_front = cull(primitive, {32, 32, 80}, {32, 32, 0}, f32x4x4(1));
+	EXPECT_EQ(in_front.culled_count, 0);
+	EXPECT_EQ(in_front.triangle_count, triangle_count);
+
+	auto const behind = cull(primitive, {32, 32, -80}, {32, 32, 0}, f32x4x4(1));
+	EXPECT_EQ(behind.culled_count, meshlet_count);
+	EXPECT_EQ(behind.triangle_count, 0);
+
+	auto const corner = cull(primitive, {5, 5, 6}, {5, 5, 0}, f32x4x4(1));
+	EXPECT_GT(corner.culled_count, 0);
+	EXPECT_LT(corner.culled_count, meshlet_count);
+
+	// turned around to face the eye
+	auto const rotated = glm::translate(f32x3(64, 0, 0)) * glm::rotate(glm::radians(180.f), f32x3(0, 1, 0));
+	auto const rotated_behind = cull(primitive, {32, 32, -80}, {32, 32, 0}, rotated);
+	EXPECT_EQ(rotated_behind.culled_count, 0);
+
+	// a mirrored plane is only frustum culled
+	auto const mirrored_behind = cull(primitive, {32, 32, -80}, {32, 32, 0}, glm::scale(f32x3(1, 1, -1)));
+	EXPECT_EQ(mirrored_behind.culled_count, 0);
+}
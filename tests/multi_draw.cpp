@@ -0,0 +1,171 @@
+#include <gtest/gtest.h>
+
+#include <render/multi_draw.hpp>
+
+#include "meshes.hpp"
+
+using namespace Render;
+
+namespace
+{
+// positions and a per vertex color, a second layout next to TestData::POSITION_LAYOUT
+Geometry::Layout const COLORED_LAYOUT = []
+{
+	auto layout = TestData::POSITION_LAYOUT;
+	layout[1] = {
+		.key = {Geometry::Key::COLOR, 0},
+		.type = {Geometry::Type::U8NORM, 4},
+		.location = 1,
+		.is_per_patch = false,
+		.group = 0,
+	};
+	return layout;
+}();
+
+Geometry::Primitive make_colored(TestData::Mesh const & mesh, u8 seed)
+{
+	auto primitive = TestData::make_primitive(mesh);
+	primitive.layout = &COLORED_LAYOUT;
+	auto & colors = primitive.data[1];
+	colors = ByteBuffer(mesh.positions.size() * sizeof(u8x4));
+	for (u32 i = 0; auto & color: colors.span_as<u8x4>())
+		color = u8x4(seed, i, i >> 8, 255), ++i;
+	return primitive;
+}
+
+// every index of the range, offset by base_vertex, reads the source vertex of every attribute
+void expect_same_vertices(
+	MergedGeometry const & merged, MergedGeometry::Range const & range, Geometry::Primitive const & source
+)
+{
+	ASSERT_EQ(range.index_count, source.indices.size());
+	for (u32 k = 0; k < range.index_count; ++k)
+	{
+		auto const merged_vertex = merged.primitive.indices[range.first_index + k] + range.base_vertex;
+		auto const source_vertex = source.indices[k];
+		for (auto i = 0; i < Geometry::ATTRIBUTE_COUNT; ++i)
+		{
+			auto const & attribute = source.layout->attributes[i];
+			if (not attribute.is_used())
+				continue;
+
+			auto const size = attribute.type.vector_size();
+			ASSERT_EQ(
+				0, std::memcmp(
+					merged.primitive.data.buffers[i].begin() + merged_vertex * size,
+					source.data.buffers[i].begin() + source_vertex * size,
+					size
+				)
+			) << "index " << k << ", attribute " << i;
+		}
+	}
+}
+}
+
+TEST(MergedGeometry, OffsetsTheRanges)
+{
+	auto const a = TestData::make_primitive(TestData::grid(4));
+	auto const b = TestData::make_primitive(TestData::axis_gizmo());
+	auto const c = TestData::make_primitive(TestData::sphere(3));
+	array<Geometry::Primitive const *, 3> const primitives{&a, &b, &c};
+
+	MergedGeometry merged;
+	merged.pack(TestData::POSITION_LAYOUT, primitives);
+
+	ASSERT_EQ(merged.ranges.size(), 3);
+	u32 first_index = 0, base_vertex = 0;
+	for (usize i = 0; i < primitives.size(); ++i)
+	{
+		SCOPED_TRACE(i);
+		auto const & range = merged.ranges[i];
+		EXPECT_EQ(range.first_index, first_index);
+		EXPECT_EQ(range.base_vertex, base_vertex);
+		expect_same_vertices(merged, range, *primitives[i]);
+		first_index += primitives[i]->indices.size();
+		base_vertex += primitives[i]->get_vertex_count();
+	}
+	EXPECT_EQ(merged.primitive.indices.size(), first_index);
+	EXPECT_EQ(merged.primitive.get_vertex_count(), base_vertex);
+
+	// the bounds cover all of them
+	for (auto const * p: primitives)
+	{
+		EXPECT_TRUE(glm::all(glm::lessThanEqual(merged.primitive.bounds.box.min, p->bounds.box.min)));
+		EXPECT_TRUE(glm::all(glm::lessThanEqual(p->bounds.box.max, merged.primitive.bounds.box.max)));
+	}
+}
+
+TEST(MultiDraw, PacksALayoutPerBatchAndDuplicatesOnce)
+{
+	auto const grid = TestData::make_primitive(TestData::grid(4));
+	auto const sphere = TestData::make_primitive(TestData::sphere(3));
+	auto const colored_grid = make_colored(TestData::grid(3), 1);
+	auto const colored_gizmo = make_colored(TestData::axis_gizmo(), 2);
+	array<Geometry::Primitive const *, 6> const primitives{
+		&grid, &colored_grid, &sphere, &grid, &colored_gizmo, &sphere
+	};
+
+	MultiDraw multi_draw;
+	multi_draw.pack(primitives);
+
+	ASSERT_EQ(multi_draw.batches.size(), 2);
+	EXPECT_EQ(multi_draw.locations.size(), 4);
+	EXPECT_EQ(multi_draw.batches[0].geometry.primitive.layout, &TestData::POSITION_LAYOUT) << "in order of first use";
+	EXPECT_EQ(multi_draw.batches[1].geometry.primitive.layout, &COLORED_LAYOUT);
+
+	// duplicates are not packed again
+	auto const & positions = multi_draw.batches[0].geometry;
+	EXPECT_EQ(positions.ranges.size(), 2);
+	EXPECT_EQ(positions.primitive.indices.size(), grid.indices.size() + sphere.indices.size());
+
+	for (auto const * p: {&grid, &sphere, &colored_grid, &colored_gizmo})
+	{
+		auto const & location = multi_draw.locations.at(p);
+		EXPECT_EQ(multi_draw.batches[location.batch_index].geometry.primitive.layout, p->layout);
+		expect_same_vertices(multi_draw.batches[location.batch_index].geometry, location.range, *p);
+	}
+}
+
+TEST(MultiDraw, PushesACommandAndADrawPerCall)
+{
+	auto const grid = TestData::make_primitive(TestData::grid(4));
+	auto const sphere = TestData::make_primitive(TestData::sphere(3));
+	auto const colored = make_colored(TestData::grid(3), 1);
+	array<Geometry::Primitive const *, 3> const primitives{&grid, &sphere, &colored};
+
+	MultiDraw multi_draw;
+	multi_draw.pack(primitives);
+	for (auto frame = 0; frame < 2; ++frame)
+	{
+		multi_draw.clear();
+		multi_draw.push(sphere, 10, 3);
+		multi_draw.push(colored, 11, 4);
+		multi_draw.push(sphere, 12, 5);
+		multi_draw.push(grid, 13, 3);
+	}
+
+	auto const & [commands, draws] = multi_draw.batches[0].commands;
+	ASSERT_EQ(commands.size(), 3) << "cleared between frames";
+	ASSERT_EQ(draws.size(), 3);
+
+	auto const & sphere_range = multi_draw.locations.at(&sphere).range;
+	auto const & grid_range = multi_draw.locations.at(&grid).range;
+	array const expected_ranges{sphere_range, sphere_range, grid_range};
+	array<u32, 3> const expected_transforms{10, 12, 13}, expected_materials{3, 5, 3};
+	for (u32 i = 0; i < 3; ++i)
+	{
+		SCOPED_TRACE(i);
+		EXPECT_EQ(commands[i].count, expected_ranges[i].index_count);
+		EXPECT_EQ(commands[i].first_index, expected_ranges[i].first_index);
+		EXPECT_EQ(commands[i].base_vertex, expected_ranges[i].base_vertex);
+		EXPECT_EQ(commands[i].instance_count, 1);
+		EXPECT_EQ(commands[i].base_instance, i) << "the draw's index into the draw data";
+		EXPECT_EQ(draws[i].transform_index, expected_transforms[i]);
+		EXPECT_EQ(draws[i].material_index, expected_materials[i]);
+	}
+
+	auto const & colored_commands = multi_draw.batches[1].commands;
+	ASSERT_EQ(colored_commands.commands.size(), 1);
+	EXPECT_EQ(colored_commands.commands[0].base_vertex, 0);
+	EXPECT_EQ(colored_commands.draws[0].transform_index, 11);
+}
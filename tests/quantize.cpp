@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <core/quantize.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "meshes.hpp"
+
+using namespace Geometry;
+
+namespace
+{
+Attribute make_attribute(Key::Common key, Type type, u8 location)
+{ return {.key = {key, 0}, .type = type, .location = location, .is_per_patch = false, .group = 0}; }
+
+// compact types of every kind, positions are read in F32 and converted by quantize
+Layout const TARGET_LAYOUT = []
+{
+	Layout layout{};
+	layout[0] = make_attribute(Key::POSITION, {Type::U16NORM, 3}, 0);
+	layout[1] = make_attribute(Key::NORMAL, {Type::I16NORM, 2}, 1);
+	layout[2] = make_attribute(Key::TANGENT, {Type::I16NORM, 3}, 2);
+	layout[3] = make_attribute(Key::TEXCOORD, {Type::F16, 2}, 3);
+	layout[4] = make_attribute(Key::COLOR, {Type::U16NORM, 4}, 4);
+	return layout;
+}();
+Layout const SOURCE_LAYOUT = get_source_layout(TARGET_LAYOUT);
+
+f32 angle_between(f32x3 const & a, f32x3 const & b)
+{ return 2 * glm::asin(glm::min(glm::distance(a, b) / 2, 1.f)); } // acos is imprecise near 0
+
+// a uv sphere off the origin, every attribute of TARGET_LAYOUT
+struct Vertices
+{
+	vector<f32x3> positions, normals;
+	vector<f32x4> tangents;
+	vector<f32x2> texcoords;
+	vector<u16x4> colors;
+};
+Vertices make_vertices()
+{
+	Vertices v;
+	u32 constexpr SEGMENTS = 64;
+	auto constexpr PI = std::numbers::pi_v<f32>;
+	for (u32 y = 0; y <= SEGMENTS; ++y)
+		for (u32 x = 0; x <= 2 * SEGMENTS; ++x)
+		{
+			auto const theta = f32(y) * PI / SEGMENTS, phi = f32(x) * PI / SEGMENTS;
+			f32x3 const normal(glm::sin(theta) * glm::cos(phi), glm::cos(theta), glm::sin(theta) * glm::sin(phi));
+			v.normals.push_back(normal);
+			v.positions.push_back(f32x3(10, 2, -3) + normal * 1.5f);
+			v.tangents.emplace_back(-glm::sin(phi), 0, glm::cos(phi), x % 2 == 0 ? -1 : 1);
+			v.texcoords.emplace_back(f32(x) / (2 * SEGMENTS) * 4.3f + 0.01f, f32(y) / SEGMENTS * 0.97f + 0.013f);
+			v.colors.emplace_back(u16(x * 500), u16(y * 1000), 0, 65535);
+		}
+	return v;
+}
+
+Primitive make_primitive(Vertices const & v)
+{
+	Primitive primitive;
+	primitive.layout = &SOURCE_LAYOUT;
+	auto const copy = [&primitive](usize i, auto const & values)
+	{
+		auto & buffer = primitive.data[i];
+		buffer = ByteBuffer(values.size() * sizeof(values[0]));
+		std::memcpy(buffer.begin(), values.data(), buffer.size);
+	};
+	copy(0, v.positions), copy(1, v.normals), copy(2, v.tangents), copy(3, v.texcoords), copy(4, v.colors);
+	primitive.calculate_bounds();
+	return primitive;
+}
+
+template<typename T>
+f32 from_norm(T value)
+{ return glm::max(f32(value) / f32(std::numeric_limits<T>::max()), -1.f); }
+}
+
+TEST(Octahedral, RoundTripsDirections)
+{
+	array const axes{f32x3(1, 0, 0), f32x3(-1, 0, 0), f32x3(0, 1, 0), f32x3(0, -1, 0), f32x3(0, 0, 1), f32x3(0, 0, -1)};
+	for (auto const & axis: axes)
+		EXPECT_LE(angle_between(decode_octahedral(encode_octahedral(axis)), axis), 1e-6f);
+
+	u32 seed = 1;
+	auto const random = [&seed]
+	{
+		seed = seed * 1664525u + 1013904223u;
+		return f32(seed >> 8) / f32(1 << 24);
+	};
+	for (auto i = 0; i < 10000; ++i)
+	{
+		auto const z = random() * 2 - 1, phi = random() * 2 * std::numbers::pi_v<f32>;
+		auto const r = glm::sqrt(1 - z * z);
+		f32x3 const normal(r * glm::cos(phi), r * glm::sin(phi), z);
+
+		auto const encoded = encode_octahedral(normal);
+		EXPECT_LE(glm::abs(encoded.x), 1);
+		EXPECT_LE(glm::abs(encoded.y), 1);
+		EXPECT_LE(angle_between(decode_octahedral(encoded), normal), 1e-5f);
+	}
+}
+
+TEST(GetSourceLayout, ReadsTheConvertedAttributesInF32)
+{
+	EXPECT_EQ(SOURCE_LAYOUT.attributes[0].type, (Type{Type::F32, 3}));
+	EXPECT_EQ(SOURCE_LAYOUT.attributes[1].type, (Type{Type::F32, 3}));
+	EXPECT_EQ(SOURCE_LAYOUT.attributes[2].type, (Type{Type::F32, 4}));
+	EXPECT_EQ(SOURCE_LAYOUT.attributes[3].type, (Type{Type::F32, 2}));
+	EXPECT_EQ(SOURCE_LAYOUT.attributes[4].type, TARGET_LAYOUT.attributes[4].type) << "gltf colors are read as they are";
+	for (auto i = 0; i < 5; ++i)
+		EXPECT_TRUE(SOURCE_LAYOUT.attributes[i].key == TARGET_LAYOUT.attributes[i].key);
+}
+
+TEST(Quantize, RoundTripsEveryAttribute)
+{
+	auto const v = make_vertices();
+	auto primitive = make_primitive(v);
+	auto const quantization = Quantization::from_box(primitive.bounds.box, TARGET_LAYOUT);
+	auto const errors = quantize(primitive, TARGET_LAYOUT, quantization);
+
+	EXPECT_EQ(primitive.layout, &TARGET_LAYOUT);
+	EXPECT_EQ(primitive.get_vertex_count(), v.positions.size());
+	auto const vertex_size = [&primitive]
+	{
+		usize size = 0;
+		for (auto const & attribute: *primitive.layout)
+			if (attribute.is_used())
+				size += attribute.type.vector_size();
+		return size;
+	};
+	EXPECT_EQ(vertex_size(), 6 + 4 + 6 + 4 + 8);
+
+	f32 position_error = 0, normal_error = 0, tangent_error = 0, texcoord_error = 0;
+	for (usize i = 0; i < v.positions.size(); ++i)
+	{
+		auto const position = primitive.data[0].span_as<u16 const>().subspan(i * 3, 3);
+		f32x4 const normalized(from_norm(position[0]), from_norm(position[1]), from_norm(position[2]), 1);
+		auto const dequantized = f32x3(quantization.dequantization * normalized);
+		position_error = glm::max(position_error, glm::distance(dequantized, v.positions[i]));
+
+		auto const normal = primitive.data[1].span_as<i16 const>().subspan(i * 2, 2);
+		auto const decoded_normal = decode_octahedral({from_norm(normal[0]), from_norm(normal[1])});
+		normal_error = glm::max(normal_error, angle_between(decoded_normal, v.normals[i]));
+
+		auto const tangent = primitive.data[2].span_as<i16 const>().subspan(i * 3, 3);
+		auto const decoded_tangent = decode_octahedral({from_norm(tangent[0]), from_norm(tangent[1])});
+		tangent_error = glm::max(tangent_error, angle_between(decoded_tangent, f32x3(v.tangents[i])));
+		EXPECT_EQ(from_norm(tangent[2]), v.tangents[i].w) << "handedness";
+
+		auto const texcoord = primitive.data[3].span_as<u16 const>().subspan(i * 2, 2);
+		for (auto c = 0; c < 2; ++c)
+			texcoord_error = glm::max(texcoord_error, glm::abs(glm::unpackHalf1x16(texcoord[c]) - v.texcoords[i][c]));
+
+		auto const color = primitive.data[4].span_as<u16x4 const>()[i];
+		EXPECT_TRUE(color == v.colors[i]) << "attributes of the same type are kept";
+	}
+
+	// the reported errors are the ones decoded here, up to the rounding of the decoding
+	EXPECT_NEAR(errors.max_errors[0], position_error, 1e-9f);
+	EXPECT_NEAR(errors.max_errors[1], normal_error, 1e-9f);
+	EXPECT_NEAR(errors.max_errors[2], tangent_error, 1e-9f);
+	EXPECT_NEAR(errors.max_errors[3], texcoord_error, 1e-9f);
+	EXPECT_EQ(errors.max_errors[4], 0);
+
+	// and within what the types can hold, half a step per component
+	EXPECT_LE(position_error, quantization.scale / 65535 * glm::sqrt(3.f) / 2 * 1.01f);
+	EXPECT_LE(normal_error, 1e-4f);
+	EXPECT_LE(tangent_error, 1e-4f);
+	EXPECT_LE(texcoord_error, 4.31f / 2048); // f16 has 11 bits of precision, half a step of the largest value
+}
+
+TEST(Quantize, KeepsF32PositionsInObjectSpace)
+{
+	Layout layout = TARGET_LAYOUT;
+	layout[0].type = {Type::F32, 3};
+	auto const box = make_primitive(make_vertices()).bounds.box;
+	auto const quantization = Quantization::from_box(box, layout);
+	EXPECT_TRUE(quantization.dequantization == f32x4x4(1));
+
+	auto const mesh = TestData::axis_gizmo();
+	auto primitive = TestData::make_primitive(mesh);
+	auto const identity = Quantization::from_box(box, TestData::POSITION_LAYOUT);
+	auto const errors = quantize(primitive, TestData::POSITION_LAYOUT, identity);
+	EXPECT_EQ(errors.max_errors[0], 0);
+	EXPECT_TRUE(std::ranges::equal(primitive.find_f32x3(Key::POSITION), mesh.positions));
+}
+
+TEST(Quantize, PositionsOfTheAxisGizmo)
+{
+	Layout layout{};
+	layout[0] = make_attribute(Key::POSITION, {Type::U16NORM, 3}, 0);
+	auto const mesh = TestData::axis_gizmo();
+	auto primitive = TestData::make_primitive(mesh);
+	auto const quantization = Quantization::from_box(primitive.bounds.box, layout);
+	auto const errors = quantize(primitive, layout, quantization);
+
+	EXPECT_EQ(primitive.data[0].size, mesh.positions.size() * 6);
+	EXPECT_GT(errors.max_errors[0], 0);
+	EXPECT_LE(errors.max_errors[0], quantization.scale / 65535 * glm::sqrt(3.f) / 2 * 1.01f);
+
+	// the box corners are exact
+	auto const positions = primitive.data[0].span_as<u16x3 const>();
+	EXPECT_TRUE(std::ranges::any_of(positions, [](u16x3 p) { return p.x == 0; }));
+	EXPECT_TRUE(std::ranges::any_of(positions, [](u16x3 p) { return p.x == 65535; }));
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <render/render_queue.hpp>
+
+#include <random>
+
+using namespace Render;
+
+namespace
+{
+using Entries = vector<std::pair<u64, u32>>;
+
+Entries get_entries(RenderQueue const & queue)
+{
+	Entries entries;
+	for (auto const & [key, index]: queue.entries)
+		entries.emplace_back(key, index);
+	return entries;
+}
+
+Entries stable_sorted(Entries entries)
+{
+	std::ranges::stable_sort(entries, std::less{}, &Entries::value_type::first);
+	return entries;
+}
+}
+
+TEST(SortKey, OrdersByTheFieldsMostSignificantFirst)
+{
+	using enum SortKey::Pass;
+	auto const key = SortKey::make(Opaque, 2, 3, 4, 5);
+
+	EXPECT_LT(key, SortKey::make(Transparent, 0, 0, 0, 0)) << "pass";
+	EXPECT_LT(key, SortKey::make(Opaque, 3, 0, 0, 0)) << "program";
+	EXPECT_LT(key, SortKey::make(Opaque, 2, 4, 0, 0)) << "material";
+	EXPECT_LT(key, SortKey::make(Opaque, 2, 3, 5, 0)) << "vertex array";
+	EXPECT_LT(key, SortKey::make(Opaque, 2, 3, 4, 6)) << "depth";
+	EXPECT_EQ(key, SortKey::make(Opaque, 2, 3, 4, 5));
+
+	// ids are truncated to their fields instead of overflowing into the next
+	EXPECT_EQ(SortKey::make(Opaque, 2, 3, 4 + 0x10000, 5), key);
+	EXPECT_EQ(SortKey::make(Opaque, 2, 3 + 0x10000, 4, 5), key);
+	EXPECT_EQ(SortKey::make(Opaque, 2 + 0x1000, 3, 4, 5), key);
+}
+
+TEST(SortKey, OrdersTheDepth)
+{
+	using enum SortKey::Pass;
+	f32 previous_depth = 0;
+	for (f32 depth = 0.01f; depth < 1000; depth *= 1.5f)
+	{
+		SCOPED_TRACE(depth);
+		// front to back for opaque, back to front for transparent
+		EXPECT_LT(SortKey::make(Opaque, 0, 0, 0, previous_depth), SortKey::make(Opaque, 0, 0, 0, depth));
+		EXPECT_GT(SortKey::make(Transparent, 0, 0, 0, previous_depth), SortKey::make(Transparent, 0, 0, 0, depth));
+		previous_depth = depth;
+	}
+
+	// behind the camera is the nearest
+	EXPECT_EQ(SortKey::make(Opaque, 0, 0, 0, -5), SortKey::make(Opaque, 0, 0, 0, 0));
+}
+
+TEST(RenderQueue, SortsLikeStableSort)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<f32> depth(0, 500);
+	RenderQueue queue; // reused like the game does
+	for (u32 draw_count: {0, 1, 7, 1000, 100000})
+	{
+		SCOPED_TRACE(draw_count);
+		queue.clear();
+		for (u32 i = 0; i < draw_count; ++i)
+		{
+			auto const pass = random() % 4 == 0 ? SortKey::Pass::Transparent : SortKey::Pass::Opaque;
+			queue.push(SortKey::make(pass, random() % 3, random() % 50, random() % 200, depth(random)), i);
+		}
+
+		auto const expected = stable_sorted(get_entries(queue));
+		queue.sort();
+		EXPECT_EQ(get_entries(queue), expected);
+	}
+}
+
+TEST(RenderQueue, IsStableForEqualKeys)
+{
+	RenderQueue queue;
+	array<u64, 10> const keys{5, 3, 5, 5, 1, 3, 0xFF00000000000000, 5, 1, 0xFF00000000000000};
+	for (u32 i = 0; i < keys.size(); ++i)
+		queue.push(keys[i], i);
+	queue.sort();
+
+	vector<u32> order;
+	for (auto const & entry: queue.entries)
+		order.push_back(entry.index);
+	EXPECT_EQ(order, (vector<u32>{4, 8, 1, 5, 0, 2, 3, 7, 6, 9}));
+}
+
+TEST(RenderQueue, SkipsTheConstantDigits)
+{
+	// every key shares all the bytes but the lowest, a single pass is enough and the order must still hold
+	RenderQueue queue;
+	for (u32 i = 0; i < 256; ++i)
+		queue.push(0xABCD'0000'0000'0000 | u64((i * 37) % 256), i);
+	auto const expected = stable_sorted(get_entries(queue));
+	queue.sort();
+	EXPECT_EQ(get_entries(queue), expected);
+}
@@ -0,0 +1,304 @@
+#include <gtest/gtest.h>
+
+#include <core/jobs.hpp>
+#include <render/scene.hpp>
+
+#include <random>
+
+using Scene::Tree;
+
+namespace
+{
+Tree::Index add(Tree & tree, std::string_view name, u32 depth, u32 parent_index)
+{ return tree.add({.name = Name(name), .depth = depth, .parent_index = parent_index, .transform = {}, .mesh = {}}); }
+
+// two roots, a is the middle node with the deepest subtree
+//   r0 -> a -> d -> g
+//           -> f
+//      -> c -> e
+//   r1 -> b
+Tree make_tree()
+{
+	Tree tree;
+	add(tree, "r0", 0, 0), add(tree, "r1", 0, 0);
+	add(tree, "a", 1, 0), add(tree, "b", 1, 1), add(tree, "c", 1, 0);
+	add(tree, "d", 2, 0), add(tree, "e", 2, 2), add(tree, "f", 2, 0);
+	add(tree, "g", 3, 0);
+	return tree;
+}
+
+vector<std::pair<u32, u32>> as_pairs(vector<Tree::Index> const & traversal)
+{
+	vector<std::pair<u32, u32>> pairs;
+	for (auto const & [depth, index]: traversal)
+		pairs.emplace_back(depth, index);
+	return pairs;
+}
+
+vector<std::pair<u32, u32>> rebuilt(Tree & tree)
+{
+	Tree::DepthFirst depth_first;
+	depth_first.tree = &tree;
+	depth_first.rebuild();
+	return as_pairs(depth_first.traversal);
+}
+
+// depth_first is built before the subtree is added, it must be spliced in and match a full rebuild
+void expect_inserted(Tree & tree, Tree::DepthFirst & depth_first)
+{
+	auto probe = depth_first;
+	EXPECT_TRUE(probe.try_insert_subtree());
+
+	depth_first.update(tree);
+	EXPECT_EQ(as_pairs(depth_first.traversal), rebuilt(tree));
+}
+
+Scene::Transform random_transform(std::mt19937 & random)
+{
+	std::uniform_real_distribution<f32> unit(-1, 1);
+	return {
+		.position = f32x3(unit(random), unit(random), unit(random)) * 10.f,
+		.rotation = glm::normalize(f32quat(unit(random), unit(random), unit(random), unit(random))),
+		.scale = f32x3(unit(random) * 0.1f + 1),
+	};
+}
+
+// 16 roots, every level is 4 times the previous one, the last level (4096 nodes) is updated in parallel
+Tree make_random_tree(std::mt19937 & random)
+{
+	Tree tree;
+	for (u32 depth = 0, size = 16; depth < 5; ++depth, size *= 4)
+		for (u32 i = 0; i < size; ++i)
+			tree.add({
+				.name = Name(fmt::format("node_{}_{}", depth, i)),
+				.depth = depth,
+				.parent_index = depth == 0 ? 0 : u32(random() % (size / 4)),
+				.transform = random_transform(random),
+				.mesh = {},
+			});
+	tree.update_transforms(false);
+	return tree;
+}
+
+Tree::Index random_node(Tree const & tree, std::mt19937 & random)
+{
+	auto const depth = u32(random() % tree.levels.size());
+	return {depth, u32(random() % tree.levels[depth].size())};
+}
+
+// node and all its descendants, in the level order update_transforms returns them
+vector<std::pair<u32, u32>> subtree_of(Tree const & tree, Tree::Index const & node)
+{
+	vector<std::pair<u32, u32>> subtree{{node.depth, node.index}};
+	vector<u8> is_in_parent_level(tree.levels[node.depth].size(), false);
+	is_in_parent_level[node.index] = true;
+	for (auto depth = node.depth + 1; depth < tree.levels.size(); ++depth)
+	{
+		auto const & level = tree.levels[depth];
+		vector<u8> is_in_level(level.size(), false);
+		for (u32 i = 0; i < level.size(); ++i)
+			if (is_in_parent_level[level.parent_indices[i]])
+				subtree.emplace_back(depth, i), is_in_level[i] = true;
+		is_in_parent_level = move(is_in_level);
+	}
+	return subtree;
+}
+
+// every node recalculated from scratch
+Tree fully_updated(Tree tree)
+{
+	for (auto & level: tree.levels)
+		std::ranges::fill(level.is_dirty, true), level.has_dirty = true;
+	tree.has_dirty = true;
+	tree.update_transforms(false);
+	return tree;
+}
+
+// the kernels take a different simd path depending on where a node falls in a batch, off by a few ulps
+void expect_same_matrices(Tree const & actual, Tree const & expected)
+{
+	for (u32 depth = 0; depth < expected.levels.size(); ++depth)
+		for (u32 i = 0; i < expected.levels[depth].size(); ++i)
+			for (auto c = 0; c < 4; ++c)
+				for (auto r = 0; r < 4; ++r)
+				{
+					auto const a = actual.levels[depth].matrices[i][c][r], e = expected.levels[depth].matrices[i][c][r];
+					ASSERT_NEAR(a, e, 1e-4f * glm::max(1.f, glm::abs(e))) << "node " << depth << ", " << i;
+				}
+}
+}
+
+TEST(SceneTreeDepthFirst, RebuildVisitsChildrenAfterTheirParent)
+{
+	auto tree = make_tree();
+	using Pairs = vector<std::pair<u32, u32>>;
+	EXPECT_EQ(rebuilt(tree), (Pairs{{0, 0}, {1, 0}, {2, 0}, {3, 0}, {2, 2}, {1, 2}, {2, 1}, {0, 1}, {1, 1}}));
+}
+
+TEST(SceneTreeDepthFirst, InsertsSubtreeUnderRoot)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	auto const root = add(tree, "s", 1, 0);
+	add(tree, "s_child", 2, root.index);
+	expect_inserted(tree, depth_first);
+}
+
+TEST(SceneTreeDepthFirst, InsertsSubtreeUnderMiddleNode)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	auto const root = add(tree, "s", 2, 0); // under a, before the subtree of c
+	add(tree, "s_child_0", 3, root.index), add(tree, "s_child_1", 3, root.index);
+	expect_inserted(tree, depth_first);
+}
+
+TEST(SceneTreeDepthFirst, InsertsSubtreeUnderDeepestLevelNode)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	add(tree, "s", 3, 1); // under e, at the existing deepest level
+	expect_inserted(tree, depth_first);
+}
+
+TEST(SceneTreeDepthFirst, InsertsSubtreeThatAddsLevels)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	auto const root = add(tree, "s", 4, 0); // under g
+	add(tree, "s_child", 5, root.index);
+	expect_inserted(tree, depth_first);
+	EXPECT_EQ(depth_first.built_level_sizes, (vector<u32>{2, 3, 3, 1, 1, 1}));
+}
+
+TEST(SceneTreeDepthFirst, InsertsNewRootSubtree)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	auto const root = add(tree, "s", 0, 0);
+	add(tree, "s_child", 1, root.index);
+	expect_inserted(tree, depth_first);
+}
+
+TEST(SceneTreeDepthFirst, InsertsSubtreesOneAfterAnother)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	for (u32 i = 0; i < 8; ++i)
+	{
+		SCOPED_TRACE(i);
+		auto const parent_depth = i % 4;
+		auto const parent_index = u32(tree.levels[parent_depth].size() - 1);
+		auto const root = add(tree, fmt::format("s_{}", i), parent_depth + 1, parent_index);
+		add(tree, fmt::format("s_{}_child", i), parent_depth + 2, root.index);
+		expect_inserted(tree, depth_first);
+	}
+}
+
+TEST(SceneTreeDepthFirst, RebuildsWhenUnrelatedSubtreesAreAdded)
+{
+	auto tree = make_tree();
+	Tree::DepthFirst depth_first;
+	depth_first.update(tree);
+
+	add(tree, "s_0", 1, 0); // under r0
+	add(tree, "s_1", 2, 1); // under b
+	auto probe = depth_first;
+	EXPECT_FALSE(probe.try_insert_subtree());
+
+	depth_first.update(tree);
+	EXPECT_EQ(as_pairs(depth_first.traversal), rebuilt(tree));
+}
+
+TEST(SceneTreeTransforms, MarkDirtyRecomputesExactlyItsSubtree)
+{
+	std::mt19937 random{1};
+	auto tree = make_random_tree(random);
+	for (u32 frame = 0; frame < 20; ++frame)
+	{
+		SCOPED_TRACE(frame);
+		auto const previous = tree;
+		auto const node = random_node(tree, random);
+		tree.set_transform(node, random_transform(random));
+
+		auto const & changed_indices = tree.update_transforms(false);
+		auto const subtree = subtree_of(tree, node);
+		ASSERT_EQ(as_pairs(changed_indices), subtree);
+
+		// outside the subtree, the matrices are not even rewritten
+		for (u32 depth = 0; depth < tree.levels.size(); ++depth)
+			for (u32 i = 0; i < tree.levels[depth].size(); ++i)
+			{
+				auto const is_in_subtree = std::ranges::binary_search(subtree, std::pair{depth, i});
+				ASSERT_TRUE(is_in_subtree or tree.levels[depth].matrices[i] == previous.levels[depth].matrices[i])
+					<< "node " << depth << ", " << i;
+			}
+		expect_same_matrices(tree, fully_updated(tree));
+	}
+}
+
+TEST(SceneTreeTransforms, CleanTreeReturnsNoChanges)
+{
+	std::mt19937 random{2};
+	auto tree = make_random_tree(random);
+	tree.set_transform(random_node(tree, random), random_transform(random));
+	EXPECT_FALSE(tree.update_transforms(false).empty());
+
+	auto const previous = tree;
+	EXPECT_TRUE(tree.update_transforms(false).empty());
+	EXPECT_TRUE(tree.update_transforms(true).empty());
+	for (u32 depth = 0; depth < tree.levels.size(); ++depth)
+		EXPECT_EQ(tree.levels[depth].matrices, previous.levels[depth].matrices);
+}
+
+TEST(SceneTreeTransforms, MatchesFullRecompute)
+{
+	std::mt19937 random{3};
+	auto tree = make_random_tree(random);
+	for (u32 frame = 0; frame < 10; ++frame)
+	{
+		SCOPED_TRACE(frame);
+		// roots move whole subtrees, deep nodes only themselves, some nodes are marked twice
+		for (u32 i = 0; i < 50; ++i)
+			tree.set_transform(random_node(tree, random), random_transform(random));
+		tree.update_transforms(false);
+		expect_same_matrices(tree, fully_updated(tree));
+	}
+}
+
+TEST(SceneTreeTransforms, SerialAndParallelMatch)
+{
+	Jobs::init({.worker_count = 3});
+	std::mt19937 random{4};
+	auto serial = make_random_tree(random), parallel = serial;
+	for (u32 frame = 0; frame < 10; ++frame)
+	{
+		SCOPED_TRACE(frame);
+		// even frames move many random nodes, odd frames a single root with a big subtree
+		u32 const node_count = frame % 2 == 0 ? 200 : 1;
+		for (u32 i = 0; i < node_count; ++i)
+		{
+			auto const node = frame % 2 == 0 ? random_node(serial, random) : Tree::Index{0, u32(random() % 16)};
+			auto const transform = random_transform(random);
+			serial.set_transform(node, transform), parallel.set_transform(node, transform);
+		}
+
+		auto const serial_changed = as_pairs(serial.update_transforms(false));
+		auto const parallel_changed = as_pairs(parallel.update_transforms(true));
+		EXPECT_EQ(serial_changed, parallel_changed);
+		expect_same_matrices(parallel, serial);
+	}
+	Jobs::shutdown();
+}
@@ -0,0 +1,227 @@
+#include <gtest/gtest.h>
+
+#include <core/simplify.hpp>
+
+#include "meshes.hpp"
+
+using namespace Geometry;
+
+namespace
+{
+// Ericson, Real-Time Collision Detection 5.1.5
+f32 distance_to_triangle(f32x3 const & p, f32x3 const & a, f32x3 const & b, f32x3 const & c)
+{
+	auto const ab = b - a, ac = c - a, ap = p - a;
+	auto const d1 = glm::dot(ab, ap), d2 = glm::dot(ac, ap);
+	if (d1 <= 0 and d2 <= 0)
+		return glm::distance(p, a);
+
+	auto const bp = p - b;
+	auto const d3 = glm::dot(ab, bp), d4 = glm::dot(ac, bp);
+	if (d3 >= 0 and d4 <= d3)
+		return glm::distance(p, b);
+
+	auto const vc = d1 * d4 - d3 * d2;
+	if (vc <= 0 and d1 >= 0 and d3 <= 0)
+		return glm::distance(p, a + ab * (d1 / (d1 - d3)));
+
+	auto const cp = p - c;
+	auto const d5 = glm::dot(ab, cp), d6 = glm::dot(ac, cp);
+	if (d6 >= 0 and d5 <= d6)
+		return glm::distance(p, c);
+
+	auto const vb = d5 * d2 - d1 * d6;
+	if (vb <= 0 and d2 >= 0 and d6 <= 0)
+		return glm::distance(p, a + ac * (d2 / (d2 - d6)));
+
+	auto const va = d3 * d6 - d5 * d4;
+	if (va <= 0 and d4 - d3 >= 0 and d5 - d6 >= 0)
+		return glm::distance(p, b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6))));
+
+	auto const denominator = 1 / (va + vb + vc);
+	return glm::distance(p, a + ab * (vb * denominator) + ac * (vc * denominator));
+}
+
+// the largest distance from the source vertices and triangle centers to the simplified surface
+f32 max_deviation(span<f32x3 const> positions, span<u32 const> source, span<u32 const> simplified)
+{
+	f32 max_distance = 0;
+	auto const measure = [&](f32x3 const & point)
+	{
+		auto distance = std::numeric_limits<f32>::max();
+		for (usize t = 0; t < simplified.size(); t += 3)
+			distance = glm::min(distance, distance_to_triangle(
+				point, positions[simplified[t + 0]], positions[simplified[t + 1]], positions[simplified[t + 2]]
+			));
+		max_distance = glm::max(max_distance, distance);
+	};
+
+	for (usize t = 0; t < source.size(); t += 3)
+	{
+		auto const & p0 = positions[source[t + 0]], & p1 = positions[source[t + 1]], & p2 = positions[source[t + 2]];
+		measure(p0);
+		measure((p0 + p1 + p2) / 3.f);
+	}
+	return max_distance;
+}
+
+vector<std::pair<char const *, TestData::Mesh>> get_meshes()
+{
+	return {
+		{"axis gizmo", TestData::axis_gizmo()},
+		{"flat grid", TestData::grid(32)},
+		{"bumpy grid", TestData::grid(32, 0.05f)},
+		{"sphere", TestData::sphere(16)},
+	};
+}
+
+array<f32, 3> constexpr RATIOS{0.5, 0.25, 0.125};
+
+usize target_of(TestData::Mesh const & mesh, f32 ratio)
+{ return usize(f64(mesh.indices.size() / 3) * ratio) * 3; }
+}
+
+TEST(Simplifier, ReducesTheTriangleCount)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		Simplifier simplifier;
+		simplifier.init({.positions = mesh.positions}, mesh.indices);
+
+		for (auto ratio: RATIOS)
+		{
+			simplifier.simplify(target_of(mesh, ratio));
+			EXPECT_LE(simplifier.indices.size(), target_of(mesh, ratio) + 3) << "ratio " << ratio;
+			EXPECT_GT(simplifier.indices.size(), 0);
+		}
+	}
+}
+
+TEST(Simplifier, KeepsTheWindingAndDropsDegenerateTriangles)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		Simplifier simplifier;
+		simplifier.init({.positions = mesh.positions}, mesh.indices);
+		simplifier.simplify(target_of(mesh, 0.25f));
+
+		auto const & indices = simplifier.indices;
+		for (usize t = 0; t < indices.size(); t += 3)
+		{
+			EXPECT_NE(indices[t + 0], indices[t + 1]);
+			EXPECT_NE(indices[t + 1], indices[t + 2]);
+			EXPECT_NE(indices[t + 2], indices[t + 0]);
+
+			// the vertices of a sphere are their own normals, no remaining triangle faces inwards
+			if (name == std::string_view("sphere"))
+			{
+				auto const & p0 = mesh.positions[indices[t + 0]];
+				auto const & p1 = mesh.positions[indices[t + 1]];
+				auto const & p2 = mesh.positions[indices[t + 2]];
+				auto const normal = glm::normalize(glm::cross(p1 - p0, p2 - p0));
+				EXPECT_GT(glm::dot(normal, glm::normalize(p0 + p1 + p2)), -1e-3f);
+			}
+		}
+	}
+}
+
+TEST(Simplifier, ErrorBoundsTheDeviation)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		Simplifier simplifier;
+		simplifier.init({.positions = mesh.positions}, mesh.indices);
+
+		f32 previous_error = 0;
+		for (auto ratio: RATIOS)
+		{
+			simplifier.simplify(target_of(mesh, ratio));
+			auto const error = simplifier.get_error();
+			EXPECT_GE(error, previous_error);
+			EXPECT_LE(max_deviation(mesh.positions, mesh.indices, simplifier.indices), error + 1e-4f) << "ratio " << ratio;
+			previous_error = error;
+		}
+	}
+}
+
+TEST(Simplifier, FlatSurfacesHaveNoError)
+{
+	auto const mesh = TestData::grid(32);
+	Simplifier simplifier;
+	simplifier.init({.positions = mesh.positions}, mesh.indices);
+	simplifier.simplify(target_of(mesh, 0.125f));
+	EXPECT_LE(simplifier.get_error(), 1e-5f);
+}
+
+// the normal term only orders the collapses, the error stays an object space distance
+TEST(Simplifier, ErrorExcludesTheNormalTerm)
+{
+	auto const mesh = TestData::grid(32);
+	vector<f32x3> normals;
+	for (usize i = 0; i < mesh.positions.size(); ++i)
+		normals.push_back(glm::normalize(f32x3(f32(i % 3) * 0.3f, f32(i % 5) * 0.2f, 1)));
+
+	Simplifier simplifier;
+	simplifier.init({.positions = mesh.positions, .normals = normals, .normal_weight = 1}, mesh.indices);
+	simplifier.simplify(target_of(mesh, 0.25f));
+	EXPECT_LE(simplifier.indices.size(), target_of(mesh, 0.25f) + 3);
+	EXPECT_LE(simplifier.get_error(), 1e-5f);
+}
+
+TEST(Simplifier, StopsAtTheMaxError)
+{
+	auto const mesh = TestData::sphere(16);
+	for (auto max_error: {0.01f, 0.05f, 0.2f})
+	{
+		Simplifier simplifier;
+		simplifier.init({.positions = mesh.positions}, mesh.indices);
+		simplifier.simplify(0, max_error);
+		EXPECT_LE(simplifier.get_error(), max_error);
+		EXPECT_LT(simplifier.indices.size(), mesh.indices.size());
+	}
+}
+
+TEST(Simplifier, IsDeterministic)
+{
+	for (auto const & [name, mesh]: get_meshes())
+	{
+		SCOPED_TRACE(name);
+		Simplifier a, b;
+		a.init({.positions = mesh.positions, .normals = mesh.positions}, mesh.indices);
+		b.init({.positions = mesh.positions, .normals = mesh.positions}, mesh.indices);
+		a.simplify(target_of(mesh, 0.25f));
+		b.simplify(target_of(mesh, 0.25f));
+		EXPECT_EQ(a.indices, b.indices);
+		EXPECT_EQ(a.get_error(), b.get_error());
+	}
+}
+
+TEST(GenerateLods, AppendsCoarserLods)
+{
+	auto primitive = TestData::make_primitive(TestData::sphere(16));
+	generate_lods(primitive, RATIOS);
+
+	ASSERT_EQ(primitive.lods.size(), RATIOS.size());
+	auto previous_size = primitive.indices.size();
+	f32 previous_error = 0;
+	for (auto const & lod: primitive.lods)
+	{
+		EXPECT_LT(lod.indices.size(), previous_size);
+		EXPECT_GE(lod.error, previous_error);
+		previous_size = lod.indices.size(), previous_error = lod.error;
+	}
+
+	EXPECT_EQ(primitive.select_lod(0), 0);
+	EXPECT_EQ(primitive.select_lod(std::numeric_limits<f32>::max()), primitive.lods.size());
+}
+
+TEST(GenerateLods, StopsWhenStuckOnLockedVertices)
+{
+	// only boundary vertices, nothing can collapse
+	auto primitive = TestData::make_primitive(TestData::grid(1));
+	generate_lods(primitive, RATIOS);
+	EXPECT_TRUE(primitive.lods.empty());
+}
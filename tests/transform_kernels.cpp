@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <core/transform_kernels.hpp>
+
+#include <random>
+
+using namespace TransformKernels;
+
+namespace
+{
+// random TRS inputs with an extra slot past the end, the kernels must not write it
+struct Inputs
+{
+	vector<f32x3> positions, scales;
+	vector<f32quat> rotations;
+	vector<f32x4x4> parents;
+	vector<u32> parent_indices;
+
+	explicit Inputs(usize count)
+	{
+		std::mt19937 random{u32(count)};
+		std::uniform_real_distribution<f32> unit(-1, 1);
+		auto const vector3 = [&] { return f32x3(unit(random), unit(random), unit(random)); };
+		auto const rotation = [&]
+		{ return glm::normalize(f32quat(unit(random), unit(random), unit(random), unit(random))); };
+
+		for (usize i = 0; i < count; ++i)
+		{
+			positions.push_back(vector3() * 50.f);
+			scales.push_back(vector3() * 2.f); // negative and near zero scales too
+			rotations.push_back(rotation());
+			parent_indices.push_back(random() % 16);
+		}
+		for (u32 i = 0; i < 16; ++i)
+		{
+			auto const scale = vector3() + f32x3(1.5f);
+			parents.push_back(glm::translate(vector3() * 50.f) * glm::mat4_cast(rotation()) * glm::scale(scale));
+		}
+	}
+};
+
+f32x4x4 const SENTINEL(-12345);
+
+vector<Isa> get_isas()
+{
+	vector<Isa> isas;
+	for (auto isa: {Isa::Scalar, Isa::SSE, Isa::AVX2})
+		if (isa <= get_supported_isa())
+			isas.push_back(isa);
+	return isas;
+}
+
+// fma in AVX2 rounds once instead of twice, off by a few ulps of the largest term (about 200)
+void expect_near(f32x4x4 const & actual, f32x4x4 const & expected, bool is_exact)
+{
+	for (auto c = 0; c < 4; ++c)
+		for (auto r = 0; r < 4; ++r)
+			if (is_exact)
+				ASSERT_EQ(actual[c][r], expected[c][r]) << "column " << c << ", row " << r;
+			else
+				ASSERT_NEAR(actual[c][r], expected[c][r], 1e-4f) << "column " << c << ", row " << r;
+}
+
+// the kernels handle lanes of 4 and 8 nodes then the rest, every remainder is covered
+array<usize, 11> constexpr COUNTS{0, 1, 3, 4, 5, 7, 8, 9, 15, 17, 1003};
+
+struct RestoreIsa
+{
+	~RestoreIsa()
+	{ set_isa(get_supported_isa()); }
+};
+}
+
+TEST(TransformKernels, SetIsaIsClampedToTheSupportedOne)
+{
+	RestoreIsa restore;
+	set_isa(Isa::AVX2);
+	EXPECT_LE(get_isa(), get_supported_isa());
+	set_isa(Isa::Scalar);
+	EXPECT_EQ(get_isa(), Isa::Scalar);
+}
+
+TEST(TransformKernels, CalculateTransformsMatchesGlm)
+{
+	RestoreIsa restore;
+	for (auto isa: get_isas())
+		for (auto count: COUNTS)
+		{
+			SCOPED_TRACE(fmt::format("{} x {}", to_string(isa), count));
+			Inputs const inputs(count);
+			vector<f32x4x4> matrices(count + 1, SENTINEL);
+
+			set_isa(isa);
+			calculate_transforms(
+				count, inputs.positions.data(), inputs.rotations.data(), inputs.scales.data(), matrices.data()
+			);
+
+			for (usize i = 0; i < count; ++i)
+			{
+				auto const expected = glm::translate(inputs.positions[i]) * glm::mat4_cast(inputs.rotations[i])
+									  * glm::scale(inputs.scales[i]);
+				expect_near(matrices[i], expected, isa != Isa::AVX2);
+			}
+			EXPECT_TRUE(matrices[count] == SENTINEL);
+		}
+}
+
+TEST(TransformKernels, ApplyParentsMatchesGlm)
+{
+	RestoreIsa restore;
+	for (auto isa: get_isas())
+		for (auto count: COUNTS)
+		{
+			SCOPED_TRACE(fmt::format("{} x {}", to_string(isa), count));
+			Inputs const inputs(count);
+			vector<f32x4x4> matrices(count + 1, SENTINEL);
+			for (usize i = 0; i < count; ++i)
+				matrices[i] = glm::translate(inputs.positions[i]) * glm::mat4_cast(inputs.rotations[i]);
+			auto const locals = matrices;
+
+			set_isa(isa);
+			apply_parents(count, inputs.parents.data(), inputs.parent_indices.data(), matrices.data());
+
+			for (usize i = 0; i < count; ++i)
+				expect_near(matrices[i], inputs.parents[inputs.parent_indices[i]] * locals[i], isa != Isa::AVX2);
+			EXPECT_TRUE(matrices[count] == SENTINEL);
+		}
+}